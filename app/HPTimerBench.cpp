@@ -0,0 +1,559 @@
+/* @file   HPTimerBench.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  benchmark suite of the read cost of all time sources, the conversions, the sleeps, the interrupts and the contention
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <iomanip>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <time.h>
+#include <sys/utsname.h>
+#include "HighPerTimer.h"
+#include "HPTimestamp.h"
+using namespace HPTimer;
+
+// C++ macro for one billion ( 10^9 )
+constexpr int64_t ONE_BILLION = 1000000000LL;
+
+// number of reads timed together, so the cost of the reference clock is spread over them
+constexpr uint32_t ReadBatch = 32;
+
+// size of the arrays of the conversion benchmarks
+constexpr size_t ConvertCount = 4096;
+
+// sleep durations in nanoseconds
+const int64_t SleepDurations[] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+// sleep of the interrupted thread in nanoseconds, a sample of this length means a lost interrupt
+constexpr int64_t InterruptSleepNSec = 100000000;
+
+// lead time in nanoseconds between the announced sleep and the interrupt, so the sleep has begun
+constexpr int64_t InterruptLeadNSec = 200000;
+
+// amount of the work of one run of the benchmark, scaled down by --quick
+struct BenchConfig
+{
+    uint32_t ReadSamples = 4000;
+    uint32_t ConvertRuns = 200;
+    int64_t SleepBudgetNSec = 200000000;
+    uint32_t InterruptSamples = 200;
+    int64_t ContentionNSec = 200000000;
+};
+
+// one line of the output
+struct BenchResult
+{
+    std::string Section;
+    std::string Name;
+    std::string Param;
+    uint64_t Count;
+    double P50;
+    double P99;
+    double P999;
+    double Max;
+    double Mean;
+    std::string Unit;
+};
+
+// nanoseconds of the reference clock, which is independent of the time source under test
+static int64_t RawNSec()
+{
+    timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC_RAW, &ts );
+    return static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( ts.tv_nsec );
+}
+
+// summarize the samples to the percentiles, the samples are sorted
+static BenchResult Summarize ( const std::string & Section, const std::string & Name, const std::string & Param,
+                               std::vector<double> & Samples, const std::string & Unit )
+{
+    BenchResult Result = { Section, Name, Param, Samples.size(), 0, 0, 0, 0, 0, Unit };
+    if ( Samples.empty() )
+    {
+        return Result;
+    }
+    std::sort ( Samples.begin(), Samples.end() );
+    auto Percentile = [&Samples] ( const double Q )
+    {
+        size_t Index ( static_cast<size_t> ( Q * Samples.size() ) );
+        return Samples[std::min ( Index, Samples.size() - 1 )];
+    };
+    Result.P50 = Percentile ( 0.5 );
+    Result.P99 = Percentile ( 0.99 );
+    Result.P999 = Percentile ( 0.999 );
+    Result.Max = Samples.back();
+    Result.Mean = std::accumulate ( Samples.begin(), Samples.end(), 0.0 ) / Samples.size();
+    return Result;
+}
+
+// cost of one read in nanoseconds. Each sample is a batch of reads timed with the reference clock,
+// the cost of the reference reads is subtracted
+template <typename ReadFunc>
+static BenchResult ReadCost ( const std::string & Name, const std::string & Param, const uint32_t SampleCount, ReadFunc Read )
+{
+    std::vector<double> Empty, Samples;
+    Empty.reserve ( SampleCount );
+    Samples.reserve ( SampleCount );
+    for ( uint32_t i ( 0 ); i < SampleCount; ++i )
+    {
+        int64_t Before ( RawNSec() );
+        Empty.push_back ( RawNSec() - Before );
+    }
+    std::nth_element ( Empty.begin(), Empty.begin() + Empty.size() / 2, Empty.end() );
+    double Reference ( Empty[Empty.size() / 2] );
+    for ( uint32_t i ( 0 ); i < SampleCount; ++i )
+    {
+        int64_t Before ( RawNSec() );
+        for ( uint32_t j ( 0 ); j < ReadBatch; ++j )
+        {
+            Read();
+        }
+        double Cost ( ( RawNSec() - Before - Reference ) / ReadBatch );
+        Samples.push_back ( std::max ( Cost, 0.0 ) );
+    }
+    return Summarize ( "read", Name, Param, Samples, "ns" );
+}
+
+static const char * OSClockName ( const OSClock Clock )
+{
+    switch ( Clock )
+    {
+    case OSClock::Monotonic:
+        return "MONOTONIC";
+    case OSClock::MonotonicRaw:
+        return "MONOTONIC_RAW";
+    case OSClock::MonotonicCoarse:
+        return "MONOTONIC_COARSE";
+    case OSClock::Boottime:
+        return "BOOTTIME";
+    case OSClock::TAI:
+        return "TAI";
+    }
+    return "unknown";
+}
+
+// read cost of every available time source and of every reader of it
+static void BenchReads ( const BenchConfig & Config, std::vector<BenchResult> & Results )
+{
+    const TimeSource Initial ( HighPerTimer::GetHPSource() );
+    const OSClock InitialClock ( HighPerTimer::GetOSClock() );
+    const TimeSource Sources[] = { TimeSource::TSC, TimeSource::HPET, TimeSource::OS, TimeSource::ARM };
+    for ( const TimeSource Source : Sources )
+    {
+        if ( HighPerTimer::SetTimerSource ( Source ) != Source )
+        {
+            continue;
+        }
+        const std::string SourceName ( HighPerTimer::GetSourceString() );
+        if ( TimeSource::TSC == Source )
+        {
+            Results.push_back ( ReadCost ( "Now<RDTSC>", SourceName, Config.ReadSamples, [] ()
+            {
+                HighPerTimer::Now<TicsReader::RDTSC>();
+            } ) );
+            if ( AccessTimeHardware::IsRDTSCPSupported() )
+            {
+                Results.push_back ( ReadCost ( "Now<RDTSCP>", SourceName, Config.ReadSamples, [] ()
+                {
+                    HighPerTimer::Now<TicsReader::RDTSCP>();
+                } ) );
+            }
+            Results.push_back ( ReadCost ( "CPU_TicsAndCpu", SourceName, Config.ReadSamples, [] ()
+            {
+                int64_t Tics;
+                uint32_t Cpu;
+                HighPerTimer::CPU_TicsAndCpu ( Tics, Cpu );
+            } ) );
+        }
+        if ( TimeSource::OS == Source )
+        {
+            const OSClock Clocks[] = { OSClock::Monotonic, OSClock::MonotonicRaw, OSClock::MonotonicCoarse, OSClock::Boottime, OSClock::TAI };
+            for ( const OSClock Clock : Clocks )
+            {
+                if ( !HighPerTimer::SetOSClock ( Clock ) )
+                {
+                    continue;
+                }
+                Results.push_back ( ReadCost ( "Now", SourceName + "/" + OSClockName ( Clock ), Config.ReadSamples, [] ()
+                {
+                    HighPerTimer::Now();
+                } ) );
+            }
+            HighPerTimer::SetOSClock ( InitialClock );
+        }
+        else
+        {
+            Results.push_back ( ReadCost ( "Now", SourceName, Config.ReadSamples, [] ()
+            {
+                HighPerTimer::Now();
+            } ) );
+        }
+        Results.push_back ( ReadCost ( "HPTimestamp::Now", SourceName, Config.ReadSamples, [] ()
+        {
+            HPTimestamp::Now();
+        } ) );
+        Results.push_back ( ReadCost ( "StartStamp+StopStamp", SourceName, Config.ReadSamples, [] ()
+        {
+            HighPerTimer::StartStamp();
+            HighPerTimer::StopStamp();
+        } ) );
+    }
+    HighPerTimer::SetTimerSource ( Initial );
+}
+
+// throughput of the conversions in nanoseconds per element, each sample is one run over the arrays
+template <typename ConvertFunc>
+static BenchResult ConvertCost ( const std::string & Name, const uint32_t Runs, ConvertFunc Convert )
+{
+    std::vector<double> Samples;
+    Samples.reserve ( Runs );
+    for ( uint32_t i ( 0 ); i < Runs; ++i )
+    {
+        int64_t Before ( RawNSec() );
+        Convert();
+        Samples.push_back ( static_cast<double> ( RawNSec() - Before ) / ConvertCount );
+    }
+    return Summarize ( "convert", Name, std::to_string ( ConvertCount ), Samples, "ns/element" );
+}
+
+static void BenchConversions ( const BenchConfig & Config, std::vector<BenchResult> & Results )
+{
+    std::vector<int64_t> Tics ( ConvertCount ), NSeconds ( ConvertCount ), Back ( ConvertCount );
+    std::vector<timespec> TS ( ConvertCount );
+    int64_t Start ( HPTimestamp::Now().HPTics() );
+    for ( size_t i ( 0 ); i < ConvertCount; ++i )
+    {
+        Tics[i] = Start + static_cast<int64_t> ( i * 7919 );
+    }
+    Results.push_back ( ConvertCost ( "TictoNSec scalar", Config.ConvertRuns, [&] ()
+    {
+        for ( size_t i ( 0 ); i < ConvertCount; ++i )
+        {
+            NSeconds[i] = HighPerTimer::TictoNSec ( Tics[i] );
+        }
+    } ) );
+    Results.push_back ( ConvertCost ( "TictoNSec batch", Config.ConvertRuns, [&] ()
+    {
+        HighPerTimer::TictoNSec ( Tics.data(), NSeconds.data(), ConvertCount );
+    } ) );
+    Results.push_back ( ConvertCost ( "NSectoTic batch", Config.ConvertRuns, [&] ()
+    {
+        HighPerTimer::NSectoTic ( NSeconds.data(), Back.data(), ConvertCount );
+    } ) );
+    Results.push_back ( ConvertCost ( "TictoTS batch", Config.ConvertRuns, [&] ()
+    {
+        HighPerTimer::TictoTS ( Tics.data(), TS.data(), ConvertCount );
+    } ) );
+    Results.push_back ( ConvertCost ( "TStoTic batch", Config.ConvertRuns, [&] ()
+    {
+        HighPerTimer::TStoTic ( TS.data(), Back.data(), ConvertCount );
+    } ) );
+}
+
+// overshoot of a sleep API in nanoseconds over all durations; the number of samples of each duration is limited by the budget
+template <typename SleepFunc>
+static void SleepOvershoot ( const std::string & Name, const BenchConfig & Config, std::vector<BenchResult> & Results, SleepFunc DoSleep )
+{
+    for ( const int64_t Duration : SleepDurations )
+    {
+        uint32_t Count ( static_cast<uint32_t> ( std::max<int64_t> ( 20, std::min<int64_t> ( 1000, Config.SleepBudgetNSec / Duration ) ) ) );
+        std::vector<double> Samples;
+        Samples.reserve ( Count );
+        for ( uint32_t i ( 0 ); i < Count; ++i )
+        {
+            Samples.push_back ( static_cast<double> ( DoSleep ( Duration ) ) );
+        }
+        Results.push_back ( Summarize ( "sleep", Name, std::to_string ( Duration ) + "ns", Samples, "ns" ) );
+    }
+}
+
+static void BenchSleeps ( const BenchConfig & Config, std::vector<BenchResult> & Results )
+{
+    HighPerTimer Timer;
+    HPSleeper Sleeper;
+    SleepOvershoot ( "HighPerTimer::NSecSleep", Config, Results, [&Timer] ( const int64_t Duration )
+    {
+        HPTimestamp Before ( HPTimestamp::Now() );
+        Timer.NSecSleep ( Duration );
+        return ( HPTimestamp::Now() - Before ).ToNSec() - Duration;
+    } );
+    SleepOvershoot ( "HPSleeper::Sleep", Config, Results, [&Sleeper] ( const int64_t Duration )
+    {
+        HPTimestamp Before ( HPTimestamp::Now() );
+        Sleeper.Sleep ( HPDuration::FromNSec ( Duration ) );
+        return ( HPTimestamp::Now() - Before ).ToNSec() - Duration;
+    } );
+    SleepOvershoot ( "HPSleeper::SleepTo", Config, Results, [&Sleeper] ( const int64_t Duration )
+    {
+        HPTimestamp Wake ( HPTimestamp::Now() + HPDuration::FromNSec ( Duration ) );
+        Sleeper.SleepTo ( Wake );
+        return ( HPTimestamp::Now() - Wake ).ToNSec();
+    } );
+    SleepOvershoot ( "nanosleep", Config, Results, [] ( const int64_t Duration )
+    {
+        timespec Request = { 0, static_cast<long> ( Duration ) };
+        HPTimestamp Before ( HPTimestamp::Now() );
+        nanosleep ( &Request, NULL );
+        return ( HPTimestamp::Now() - Before ).ToNSec() - Duration;
+    } );
+}
+
+// latency from the interrupt to the return of the sleep in the other thread.
+// The sleeper announces each sleep, the interrupt follows after a lead time, so the sleep has begun
+static void BenchInterrupts ( const BenchConfig & Config, std::vector<BenchResult> & Results )
+{
+    HPSleeper Sleeper;
+    std::atomic<uint32_t> Announced ( 0 ), Woken ( 0 );
+    std::atomic<int64_t> WakeNSec ( 0 );
+    std::thread SleepThread ( [&] ()
+    {
+        for ( uint32_t i ( 1 ); i <= Config.InterruptSamples; ++i )
+        {
+            Announced.store ( i, std::memory_order_release );
+            Sleeper.Sleep ( HPDuration::FromNSec ( InterruptSleepNSec ) );
+            WakeNSec.store ( HPTimestamp::Now().ToNSec(), std::memory_order_relaxed );
+            Woken.store ( i, std::memory_order_release );
+        }
+    } );
+    std::vector<double> Samples;
+    uint64_t Lost ( 0 );
+    for ( uint32_t i ( 1 ); i <= Config.InterruptSamples; ++i )
+    {
+        while ( Announced.load ( std::memory_order_acquire ) != i )
+        {
+            std::this_thread::yield();
+        }
+        HPSleeper Lead;
+        Lead.Sleep ( HPDuration::FromNSec ( InterruptLeadNSec ) );
+        int64_t InterruptNSec ( HPTimestamp::Now().ToNSec() );
+        Sleeper.Interrupt();
+        while ( Woken.load ( std::memory_order_acquire ) != i )
+        {
+            std::this_thread::yield();
+        }
+        int64_t Latency ( WakeNSec.load ( std::memory_order_relaxed ) - InterruptNSec );
+        if ( Latency < InterruptSleepNSec / 2 )
+        {
+            Samples.push_back ( static_cast<double> ( Latency ) );
+        }
+        else
+        {
+            ++Lost;
+        }
+    }
+    SleepThread.join();
+    Results.push_back ( Summarize ( "interrupt", "HPSleeper::Interrupt", "lost=" + std::to_string ( Lost ), Samples, "ns" ) );
+}
+
+// reads of HPTimestamp::Now() in parallel threads; the cost per read is the elapsed time of all threads divided by all reads
+static void BenchContention ( const BenchConfig & Config, std::vector<BenchResult> & Results )
+{
+    uint32_t Hardware ( std::max<uint32_t> ( 1, std::thread::hardware_concurrency() ) );
+    uint32_t Limit ( std::min<uint32_t> ( 64, std::max<uint32_t> ( 4, 2 * Hardware ) ) );
+    for ( uint32_t Threads ( 1 ); Threads <= Limit; Threads *= 2 )
+    {
+        std::atomic<bool> Go ( false ), Stop ( false );
+        std::vector<uint64_t> Reads ( Threads, 0 );
+        std::vector<std::thread> Pool;
+        for ( uint32_t t ( 0 ); t < Threads; ++t )
+        {
+            Pool.push_back ( std::thread ( [&Go, &Stop, &Reads, t] ()
+            {
+                while ( !Go.load ( std::memory_order_acquire ) )
+                {
+                    std::this_thread::yield();
+                }
+                uint64_t Count ( 0 );
+                while ( !Stop.load ( std::memory_order_relaxed ) )
+                {
+                    for ( uint32_t j ( 0 ); j < ReadBatch; ++j )
+                    {
+                        HPTimestamp::Now();
+                    }
+                    Count += ReadBatch;
+                }
+                Reads[t] = Count;
+            } ) );
+        }
+        int64_t Begin ( RawNSec() );
+        Go.store ( true, std::memory_order_release );
+        HPSleeper Sleeper;
+        Sleeper.Sleep ( HPDuration::FromNSec ( Config.ContentionNSec ) );
+        Stop.store ( true, std::memory_order_relaxed );
+        for ( std::thread & Worker : Pool )
+        {
+            Worker.join();
+        }
+        int64_t Elapsed ( RawNSec() - Begin );
+        std::vector<double> PerThread;
+        uint64_t Total ( 0 );
+        for ( uint32_t t ( 0 ); t < Threads; ++t )
+        {
+            Total += Reads[t];
+            PerThread.push_back ( Reads[t] ? static_cast<double> ( Elapsed ) / Reads[t] : 0.0 );
+        }
+        BenchResult Result ( Summarize ( "contention", "HPTimestamp::Now", std::to_string ( Threads ) + "threads", PerThread, "ns/read" ) );
+        Result.Count = Total;
+        Results.push_back ( Result );
+    }
+}
+
+static std::string JsonString ( const std::string & Text )
+{
+    std::string Escaped ( "\"" );
+    for ( const char c : Text )
+    {
+        if ( ( '"' == c ) || ( '\\' == c ) )
+        {
+            Escaped += '\\';
+        }
+        if ( static_cast<unsigned char> ( c ) >= 0x20 )
+        {
+            Escaped += c;
+        }
+    }
+    return Escaped + "\"";
+}
+
+static void WriteJson ( std::ostream & Out, const std::vector<BenchResult> & Results )
+{
+    utsname Uname;
+    uname ( &Uname );
+    Out << std::fixed << std::setprecision ( 3 );
+    Out << "{\n  \"source\": " << JsonString ( HighPerTimer::GetSourceString() ) << ",\n";
+    Out << "  \"cpu\": " << JsonString ( AccessTimeHardware::GetBrandString() ) << ",\n";
+    Out << "  \"kernel\": " << JsonString ( Uname.release ) << ",\n";
+    Out << "  \"threads\": " << std::thread::hardware_concurrency() << ",\n";
+    Out << "  \"nsec_per_tic\": " << std::setprecision ( 9 ) << HighPerTimer::GetNsecPerTic() << std::setprecision ( 3 ) << ",\n";
+    Out << "  \"results\": [\n";
+    for ( size_t i ( 0 ); i < Results.size(); ++i )
+    {
+        const BenchResult & R ( Results[i] );
+        Out << "    { \"section\": " << JsonString ( R.Section ) << ", \"name\": " << JsonString ( R.Name )
+            << ", \"param\": " << JsonString ( R.Param ) << ", \"count\": " << R.Count
+            << ", \"p50\": " << R.P50 << ", \"p99\": " << R.P99 << ", \"p999\": " << R.P999
+            << ", \"max\": " << R.Max << ", \"mean\": " << R.Mean << ", \"unit\": " << JsonString ( R.Unit ) << " }"
+            << ( i + 1 < Results.size() ? "," : "" ) << "\n";
+    }
+    Out << "  ]\n}\n";
+}
+
+static void WriteCsv ( std::ostream & Out, const std::vector<BenchResult> & Results )
+{
+    Out << std::fixed << std::setprecision ( 3 );
+    Out << "section,name,param,count,p50,p99,p999,max,mean,unit\n";
+    for ( const BenchResult & R : Results )
+    {
+        Out << R.Section << "," << R.Name << "," << R.Param << "," << R.Count << "," << R.P50 << "," << R.P99
+            << "," << R.P999 << "," << R.Max << "," << R.Mean << "," << R.Unit << "\n";
+    }
+}
+
+static void Usage ( const char * Program )
+{
+    std::cerr << "usage: " << Program << " [--csv] [--quick] [--out FILE] [--only read|convert|sleep|interrupt|contention]\n"
+              << "  writes the results as JSON, or as CSV with --csv, to stdout or to FILE" << std::endl;
+}
+
+int main ( int argc, char * argv[] )
+{
+    bool Csv ( false );
+    std::string OutFile, Only;
+    BenchConfig Config;
+    for ( int i ( 1 ); i < argc; ++i )
+    {
+        if ( 0 == strcmp ( argv[i], "--csv" ) )
+        {
+            Csv = true;
+        }
+        else if ( 0 == strcmp ( argv[i], "--quick" ) )
+        {
+            Config.ReadSamples = 500;
+            Config.ConvertRuns = 20;
+            Config.SleepBudgetNSec = 20000000;
+            Config.InterruptSamples = 20;
+            Config.ContentionNSec = 20000000;
+        }
+        else if ( ( 0 == strcmp ( argv[i], "--out" ) ) && ( i + 1 < argc ) )
+        {
+            OutFile = argv[++i];
+        }
+        else if ( ( 0 == strcmp ( argv[i], "--only" ) ) && ( i + 1 < argc ) )
+        {
+            Only = argv[++i];
+        }
+        else
+        {
+            Usage ( argv[0] );
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> Results;
+    if ( Only.empty() || ( "read" == Only ) )
+    {
+        BenchReads ( Config, Results );
+    }
+    if ( Only.empty() || ( "convert" == Only ) )
+    {
+        BenchConversions ( Config, Results );
+    }
+    if ( Only.empty() || ( "sleep" == Only ) )
+    {
+        BenchSleeps ( Config, Results );
+    }
+    if ( Only.empty() || ( "interrupt" == Only ) )
+    {
+        BenchInterrupts ( Config, Results );
+    }
+    if ( Only.empty() || ( "contention" == Only ) )
+    {
+        BenchContention ( Config, Results );
+    }
+
+    std::ofstream File;
+    if ( !OutFile.empty() )
+    {
+        File.open ( OutFile.c_str() );
+        if ( !File )
+        {
+            std::cerr << "can not open " << OutFile << std::endl;
+            return 1;
+        }
+    }
+    std::ostream & Out ( OutFile.empty() ? std::cout : File );
+    if ( Csv )
+    {
+        WriteCsv ( Out, Results );
+    }
+    else
+    {
+        WriteJson ( Out, Results );
+    }
+    return 0;
+}
@@ -0,0 +1,397 @@
+/* @file   HPTimerStress.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  multi-threaded stress of the reads, the monotonicity across threads and the sleeps and interrupts
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
+#include "HighPerTimer.h"
+#include "HPTimestamp.h"
+using namespace HPTimer;
+
+// number of reads between the checks of the stop flag
+constexpr uint32_t ReadBatch = 32;
+
+// shortest and longest sleep of the storm in nanoseconds
+constexpr int64_t StormMinNSec = 10000;
+constexpr int64_t StormMaxNSec = 1000000;
+
+// pause of the interrupting thread between two interrupts in nanoseconds
+constexpr int64_t StormInterruptNSec = 20000;
+
+// most samples of each sleeping thread, so the storm does not grow without limit
+constexpr size_t StormSamples = 100000;
+
+// the state of one thread. The slots live in a vector, which does not align its storage beyond the one of the allocator,
+// so the padding keeps the values of neighbouring slots a cache line apart, wherever the slots start
+struct ThreadSlot
+{
+    /// last stamp, which the thread has published for the handoff, in tics shifted to unix zero
+    std::atomic<int64_t> Published;
+
+    /// the sleeper of the thread in the storm
+    HPSleeper Sleeper;
+
+    /// tics of the begin of the current sleep, 0 if the thread does not sleep
+    std::atomic<int64_t> SleepingSince;
+
+    /// tics of the last interrupt of the sleep, 0 if there was none
+    std::atomic<int64_t> InterruptedAt;
+
+    /// keeps the values of this slot and of the next one in different cache lines
+    char mPad[64];
+};
+
+// amount of the work of one run, scaled down by --quick
+struct StressConfig
+{
+    uint32_t MaxThreads = 0;
+    int64_t PhaseNSec = 500000000;
+};
+
+// percentile of sorted samples
+static double Percentile ( const std::vector<double> & Samples, const double Q )
+{
+    if ( Samples.empty() )
+    {
+        return 0;
+    }
+    size_t Index ( static_cast<size_t> ( Q * Samples.size() ) );
+    return Samples[std::min ( Index, Samples.size() - 1 )];
+}
+
+// the CPUs, on which the process may run
+static std::vector<int> AllowedCpus()
+{
+    std::vector<int> Cpus;
+    cpu_set_t Set;
+    if ( 0 == sched_getaffinity ( 0, sizeof ( Set ), &Set ) )
+    {
+        for ( int Cpu ( 0 ); Cpu < CPU_SETSIZE; ++Cpu )
+        {
+            if ( CPU_ISSET ( Cpu, &Set ) )
+            {
+                Cpus.push_back ( Cpu );
+            }
+        }
+    }
+    if ( Cpus.empty() )
+    {
+        Cpus.push_back ( 0 );
+    }
+    return Cpus;
+}
+
+// pin the calling thread to one CPU, more threads than CPUs share them round robin
+static void PinThread ( const std::vector<int> & Cpus, const uint32_t Index )
+{
+    cpu_set_t Set;
+    CPU_ZERO ( &Set );
+    CPU_SET ( Cpus[Index % Cpus.size()], &Set );
+    pthread_setaffinity_np ( pthread_self(), sizeof ( Set ), &Set );
+}
+
+// run the body in the given number of pinned threads. They start together and stop after the phase time
+template <typename BodyFunc>
+static void RunThreads ( const std::vector<int> & Cpus, const uint32_t Threads, const int64_t PhaseNSec, BodyFunc Body )
+{
+    std::atomic<uint32_t> Ready ( 0 );
+    std::atomic<bool> Go ( false ), Stop ( false );
+    std::vector<std::thread> Pool;
+    for ( uint32_t t ( 0 ); t < Threads; ++t )
+    {
+        Pool.push_back ( std::thread ( [&, t] ()
+        {
+            PinThread ( Cpus, t );
+            Ready.fetch_add ( 1, std::memory_order_acq_rel );
+            while ( !Go.load ( std::memory_order_acquire ) )
+            {
+                std::this_thread::yield();
+            }
+            Body ( t, Stop );
+        } ) );
+    }
+    while ( Ready.load ( std::memory_order_acquire ) != Threads )
+    {
+        std::this_thread::yield();
+    }
+    Go.store ( true, std::memory_order_release );
+    HPSleeper Sleeper;
+    Sleeper.Sleep ( HPDuration::FromNSec ( PhaseNSec ) );
+    Stop.store ( true, std::memory_order_relaxed );
+    for ( std::thread & Worker : Pool )
+    {
+        Worker.join();
+    }
+}
+
+// concurrent reads of HPTimestamp::Now(): the throughput of each thread and the reads, which were smaller than the
+// read before in the same thread
+static uint64_t StressNow ( const std::vector<int> & Cpus, const uint32_t Threads, const StressConfig & Config )
+{
+    std::vector<uint64_t> Reads ( Threads, 0 ), Negative ( Threads, 0 );
+    RunThreads ( Cpus, Threads, Config.PhaseNSec, [&] ( const uint32_t t, std::atomic<bool> & Stop )
+    {
+        uint64_t Count ( 0 ), Back ( 0 );
+        int64_t Last ( HPTimestamp::Now().HPTics() );
+        while ( !Stop.load ( std::memory_order_relaxed ) )
+        {
+            for ( uint32_t j ( 0 ); j < ReadBatch; ++j )
+            {
+                int64_t Tics ( HPTimestamp::Now().HPTics() );
+                Back += ( Tics < Last ) ? 1 : 0;
+                Last = Tics;
+            }
+            Count += ReadBatch;
+        }
+        Reads[t] = Count;
+        Negative[t] = Back;
+    } );
+    std::vector<double> PerThread;
+    uint64_t Total ( 0 ), Back ( 0 );
+    for ( uint32_t t ( 0 ); t < Threads; ++t )
+    {
+        Total += Reads[t];
+        Back += Negative[t];
+        PerThread.push_back ( Reads[t] * 1e9 / Config.PhaseNSec / 1e6 );
+    }
+    std::sort ( PerThread.begin(), PerThread.end() );
+    std::cout << "now       threads=" << std::setw ( 3 ) << Threads
+              << " Mreads/s per thread min=" << PerThread.front() << " p50=" << Percentile ( PerThread, 0.5 )
+              << " max=" << PerThread.back() << " total=" << Total * 1e9 / Config.PhaseNSec / 1e6
+              << " negative=" << Back << std::endl;
+    return Back;
+}
+
+// handoff of stamps between the threads: each thread reads the stamp, which its neighbour has published,
+// and takes its own stamp afterwards. The own stamp happens after the published one, so it shall not be smaller
+static uint64_t StressHandoff ( const std::vector<int> & Cpus, const uint32_t Threads, const StressConfig & Config,
+                                std::vector<ThreadSlot> & Slots )
+{
+    for ( uint32_t t ( 0 ); t < Threads; ++t )
+    {
+        Slots[t].Published.store ( HPTimestamp::Now().HPTics(), std::memory_order_relaxed );
+    }
+    std::vector<uint64_t> Checks ( Threads, 0 ), Negative ( Threads, 0 );
+    std::vector<int64_t> Worst ( Threads, 0 );
+    RunThreads ( Cpus, Threads, Config.PhaseNSec, [&] ( const uint32_t t, std::atomic<bool> & Stop )
+    {
+        ThreadSlot & Peer ( Slots[( t + 1 ) % Threads] );
+        ThreadSlot & Own ( Slots[t] );
+        uint64_t Count ( 0 ), Back ( 0 );
+        int64_t Largest ( 0 );
+        while ( !Stop.load ( std::memory_order_relaxed ) )
+        {
+            for ( uint32_t j ( 0 ); j < ReadBatch; ++j )
+            {
+                int64_t Seen ( Peer.Published.load ( std::memory_order_acquire ) );
+                int64_t Tics ( HPTimestamp::Now().HPTics() );
+                if ( Tics < Seen )
+                {
+                    ++Back;
+                    Largest = std::max ( Largest, Seen - Tics );
+                }
+                Own.Published.store ( HPTimestamp::Now().HPTics(), std::memory_order_release );
+            }
+            Count += ReadBatch;
+        }
+        Checks[t] = Count;
+        Negative[t] = Back;
+        Worst[t] = Largest;
+    } );
+    uint64_t Total ( 0 ), Back ( 0 );
+    int64_t Largest ( 0 );
+    for ( uint32_t t ( 0 ); t < Threads; ++t )
+    {
+        Total += Checks[t];
+        Back += Negative[t];
+        Largest = std::max ( Largest, Worst[t] );
+    }
+    std::cout << "handoff   threads=" << std::setw ( 3 ) << Threads << " checks=" << Total << " negative=" << Back
+              << " worst=" << HighPerTimer::TictoNSec ( Largest ) << " ns" << std::endl;
+    return Back;
+}
+
+// storm of sleeps and interrupts: all threads sleep to random deadlines, one more thread interrupts the sleeping ones
+// round robin. The overshoot of the sleeps, which were not interrupted, and the latency from the interrupt to the
+// return of the sleep are reported
+static void StressStorm ( const std::vector<int> & Cpus, const uint32_t Threads, const StressConfig & Config,
+                          std::vector<ThreadSlot> & Slots )
+{
+    for ( uint32_t t ( 0 ); t < Threads; ++t )
+    {
+        Slots[t].SleepingSince.store ( 0, std::memory_order_relaxed );
+        Slots[t].InterruptedAt.store ( 0, std::memory_order_relaxed );
+    }
+    std::vector<std::vector<double>> Overshoot ( Threads ), Latency ( Threads );
+    std::atomic<bool> Sleeping ( true );
+    std::thread Interrupter ( [&] ()
+    {
+        PinThread ( Cpus, Threads );
+        HPSleeper Pause;
+        uint32_t Next ( 0 );
+        while ( Sleeping.load ( std::memory_order_relaxed ) )
+        {
+            ThreadSlot & Slot ( Slots[Next++ % Threads] );
+            if ( 0 != Slot.SleepingSince.load ( std::memory_order_acquire ) )
+            {
+                Slot.InterruptedAt.store ( HPTimestamp::Now().HPTics(), std::memory_order_release );
+                Slot.Sleeper.Interrupt();
+            }
+            Pause.Sleep ( HPDuration::FromNSec ( StormInterruptNSec ) );
+        }
+    } );
+    RunThreads ( Cpus, Threads, Config.PhaseNSec, [&] ( const uint32_t t, std::atomic<bool> & Stop )
+    {
+        ThreadSlot & Slot ( Slots[t] );
+        uint32_t Seed ( 0x9E3779B9u * ( t + 1 ) );
+        Overshoot[t].reserve ( StormSamples );
+        Latency[t].reserve ( StormSamples );
+        while ( !Stop.load ( std::memory_order_relaxed ) && ( Overshoot[t].size() + Latency[t].size() < StormSamples ) )
+        {
+            Seed = Seed * 1664525u + 1013904223u;
+            int64_t Duration ( StormMinNSec + static_cast<int64_t> ( Seed >> 8 ) % ( StormMaxNSec - StormMinNSec ) );
+            HPTimestamp Begin ( HPTimestamp::Now() );
+            HPTimestamp Wake ( Begin + HPDuration::FromNSec ( Duration ) );
+            Slot.InterruptedAt.store ( 0, std::memory_order_relaxed );
+            Slot.SleepingSince.store ( Begin.HPTics(), std::memory_order_release );
+            Slot.Sleeper.SleepTo ( Wake );
+            int64_t End ( HPTimestamp::Now().HPTics() );
+            Slot.SleepingSince.store ( 0, std::memory_order_release );
+            int64_t Interrupted ( Slot.InterruptedAt.load ( std::memory_order_acquire ) );
+            // an interrupt before the sleep has begun is discarded by it, so only the ones during the sleep are counted
+            if ( ( End < Wake.HPTics() ) && ( Interrupted >= Begin.HPTics() ) && ( Interrupted <= End ) )
+            {
+                Latency[t].push_back ( static_cast<double> ( HighPerTimer::TictoNSec ( End - Interrupted ) ) );
+            }
+            else if ( End >= Wake.HPTics() )
+            {
+                Overshoot[t].push_back ( static_cast<double> ( HighPerTimer::TictoNSec ( End - Wake.HPTics() ) ) );
+            }
+        }
+    } );
+    Sleeping.store ( false, std::memory_order_relaxed );
+    Interrupter.join();
+
+    std::vector<double> AllOvershoot, AllLatency;
+    for ( uint32_t t ( 0 ); t < Threads; ++t )
+    {
+        AllOvershoot.insert ( AllOvershoot.end(), Overshoot[t].begin(), Overshoot[t].end() );
+        AllLatency.insert ( AllLatency.end(), Latency[t].begin(), Latency[t].end() );
+    }
+    std::sort ( AllOvershoot.begin(), AllOvershoot.end() );
+    std::sort ( AllLatency.begin(), AllLatency.end() );
+    std::cout << "sleep     threads=" << std::setw ( 3 ) << Threads << " wakes=" << AllOvershoot.size()
+              << " overshoot ns p50=" << Percentile ( AllOvershoot, 0.5 ) << " p99=" << Percentile ( AllOvershoot, 0.99 )
+              << " p99.9=" << Percentile ( AllOvershoot, 0.999 ) << " max=" << ( AllOvershoot.empty() ? 0 : AllOvershoot.back() ) << std::endl;
+    std::cout << "interrupt threads=" << std::setw ( 3 ) << Threads << " wakes=" << AllLatency.size()
+              << " latency ns p50=" << Percentile ( AllLatency, 0.5 ) << " p99=" << Percentile ( AllLatency, 0.99 )
+              << " p99.9=" << Percentile ( AllLatency, 0.999 ) << " max=" << ( AllLatency.empty() ? 0 : AllLatency.back() ) << std::endl;
+}
+
+static void Usage ( const char * Program )
+{
+    std::cerr << "usage: " << Program << " [--threads N] [--phase MS] [--quick] [--only now|handoff|storm]\n"
+              << "  runs each phase with 1, 2, 4 ... N pinned threads, N defaults to the CPUs of the process.\n"
+              << "  exits with 2, if a negative delta was found" << std::endl;
+}
+
+int main ( int argc, char * argv[] )
+{
+    StressConfig Config;
+    std::string Only;
+    for ( int i ( 1 ); i < argc; ++i )
+    {
+        if ( ( 0 == strcmp ( argv[i], "--threads" ) ) && ( i + 1 < argc ) )
+        {
+            Config.MaxThreads = static_cast<uint32_t> ( std::max ( 1, atoi ( argv[++i] ) ) );
+        }
+        else if ( ( 0 == strcmp ( argv[i], "--phase" ) ) && ( i + 1 < argc ) )
+        {
+            Config.PhaseNSec = std::max ( 1, atoi ( argv[++i] ) ) * 1000000LL;
+        }
+        else if ( 0 == strcmp ( argv[i], "--quick" ) )
+        {
+            Config.PhaseNSec = 50000000;
+        }
+        else if ( ( 0 == strcmp ( argv[i], "--only" ) ) && ( i + 1 < argc ) )
+        {
+            Only = argv[++i];
+        }
+        else
+        {
+            Usage ( argv[0] );
+            return 1;
+        }
+    }
+
+    const std::vector<int> Cpus ( AllowedCpus() );
+    if ( 0 == Config.MaxThreads )
+    {
+        Config.MaxThreads = static_cast<uint32_t> ( Cpus.size() );
+    }
+    std::cout << std::fixed << std::setprecision ( 1 );
+    std::cout << "source " << HighPerTimer::GetSourceString() << ", " << Cpus.size() << " CPUs"
+              << ", TSC skew corrected " << HighPerTimer::IsTSCSkewCorrected()
+              << ", monitor wait " << HighPerTimer::IsMonitorWaitUsed() << std::endl;
+    std::cout << "selection: " << AccessTimeHardware::GetSourceSelection().Reason << std::endl;
+
+    // one slot per thread, the interrupting thread of the storm has none, it is only pinned to the CPU after the sleepers
+    std::vector<ThreadSlot> Slots ( Config.MaxThreads );
+    std::vector<uint32_t> Counts;
+    for ( uint32_t Threads ( 1 ); Threads < Config.MaxThreads; Threads *= 2 )
+    {
+        Counts.push_back ( Threads );
+    }
+    Counts.push_back ( Config.MaxThreads );
+
+    uint64_t Negative ( 0 );
+    for ( const uint32_t Threads : Counts )
+    {
+        if ( Only.empty() || ( "now" == Only ) )
+        {
+            Negative += StressNow ( Cpus, Threads, Config );
+        }
+        if ( ( Only.empty() || ( "handoff" == Only ) ) && ( Threads > 1 ) )
+        {
+            Negative += StressHandoff ( Cpus, Threads, Config, Slots );
+        }
+        if ( Only.empty() || ( "storm" == Only ) )
+        {
+            StressStorm ( Cpus, Threads, Config, Slots );
+        }
+    }
+    if ( 0 != Negative )
+    {
+        std::cout << "FAILED: " << Negative << " negative deltas" << std::endl;
+        return 2;
+    }
+    std::cout << "passed" << std::endl;
+    return 0;
+}
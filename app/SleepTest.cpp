@@ -25,6 +25,8 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <cmath>
 #include "HighPerTimer.h"
 using namespace HPTimer;
 
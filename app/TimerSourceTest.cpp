@@ -25,6 +25,8 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <cmath>
 #include "HighPerTimer.h"
 using namespace HPTimer;
 
@@ -33,10 +35,13 @@ int main(int argc, char *argv[])
     ///////////////////////////////////////////////////////////////
     // getting basic info
     std::cout << "Final timer source: " <<  HighPerTimer::GetSourceString() << std::endl;
+    std::cout << "Source selection: " << AccessTimeHardware::GetSourceSelection().Reason << std::endl;
     std::cout << "Frequency: " << HighPerTimer::GetHPFrequency() << std::endl;
     std::cout << "Nsec Per Tic: " << HighPerTimer::GetNsecPerTic() << std::endl;
     std::cout << "MAX HPTimer value  " << HighPerTimer::HPTimer_MAX << std::endl;
     std::cout << "MIN HPTimer value  " << HighPerTimer::HPTimer_MIN << std::endl;
+    std::cout << "Read overhead: " << HighPerTimer::GetReadOverhead() << " tics, Stamp overhead: "
+              << HighPerTimer::GetStampOverhead() << " tics" << std::endl;
    
 
     ///////////////////////////////////////////////////////////////
@@ -0,0 +1,313 @@
+/*
+ * @file   CalibrationCache.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Persisted results of the timer calibration, so a process does not measure them again at every launch
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "HighPerTimer.h"
+
+// first line of the cache file, the number is increased whenever the content changes
+static const char CacheHeader[] = "libHPTimer calibration 3";
+
+// environment variable with the path of the cache file. An empty value disables the cache
+static const char CacheEnv[] = "HPTIMER_CALIBRATION_CACHE";
+
+// the cache holds a few short lines, a larger file is not ours
+static const size_t CacheMaxSize = 4096;
+
+// identifier of the current boot, the TSC frequency and the jiffies are measured again after each reboot
+static const char BootIdPath[] = "/proc/sys/kernel/random/boot_id";
+
+namespace HPTimer
+{
+
+bool HighPerTimer::CalibrationCached ( false );
+
+// path of the cache file, empty if the cache is disabled. Without the environment variable the file is kept in
+// $XDG_RUNTIME_DIR or in /tmp/libHPTimer-<euid>/, so nobody else can place a file or a link under its name.
+// The directory in /tmp is created on save and used only when it is owned by the current user and closed to others
+static std::string CachePath ( const bool Create )
+{
+    const char * Env ( getenv ( CacheEnv ) );
+    if ( NULL != Env )
+    {
+        return std::string ( Env );
+    }
+    const char * Runtime ( getenv ( "XDG_RUNTIME_DIR" ) );
+    if ( ( NULL != Runtime ) && ( '/' == Runtime[0] ) )
+    {
+        return std::string ( Runtime ) + "/libHPTimer.cache";
+    }
+    std::ostringstream Dir;
+    Dir << "/tmp/libHPTimer-" << geteuid();
+    if ( Create )
+    {
+        mkdir ( Dir.str().c_str(), 0700 );
+    }
+    struct stat Stat;
+    if ( ( 0 != lstat ( Dir.str().c_str(), &Stat ) ) || !S_ISDIR ( Stat.st_mode ) || ( Stat.st_uid != geteuid() )
+            || ( 0 != ( Stat.st_mode & ( S_IRWXG | S_IRWXO ) ) ) )
+    {
+        return std::string();
+    }
+    return Dir.str() + "/calibration.cache";
+}
+
+// read the whole cache file. A link is not followed and the checks are made on the opened descriptor,
+// so the file cannot be swapped between the check and the read. It must be a regular file of the current user
+static bool ReadCache ( const std::string & Path, std::string & Content )
+{
+    int Fd ( open ( Path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC ) );
+    if ( Fd < 0 )
+    {
+        return false;
+    }
+    struct stat Stat;
+    bool Valid ( ( 0 == fstat ( Fd, &Stat ) ) && S_ISREG ( Stat.st_mode ) && ( Stat.st_uid == geteuid() )
+                 && ( Stat.st_size > 0 ) && ( static_cast<size_t> ( Stat.st_size ) <= CacheMaxSize ) );
+    char Buffer[CacheMaxSize];
+    ssize_t Size ( 0 );
+    while ( Valid && ( Size < Stat.st_size ) )
+    {
+        ssize_t Read ( read ( Fd, Buffer + Size, CacheMaxSize - Size ) );
+        Valid = Read > 0;
+        Size += Valid ? Read : 0;
+    }
+    close ( Fd );
+    Content.assign ( Buffer, Valid ? Size : 0 );
+    return Valid;
+}
+
+// key of the calibration: everything, which has to be equal for the cached or shared values to be valid
+std::string HighPerTimer::CalibrationKey ( bool * TSCAvailable )
+{
+    if ( NULL != TSCAvailable )
+    {
+        *TSCAvailable = TSCTimer::InitTSCTimer();
+    }
+    std::ifstream BootId ( BootIdPath );
+    std::string Boot;
+    if ( !std::getline ( BootId, Boot ) || Boot.empty() )
+    {
+        return std::string();
+    }
+    std::string Brand ( AccessTimeHardware::GetBrandString() );
+    std::ostringstream Key;
+    Key << "brand=" << Brand.substr ( 0, Brand.find ( '\n' ) ) << "\n"
+        << "boot_id=" << Boot << "\n"
+        << "tsc_flags=" << AccessTimeHardware::IsRDTSCPSupported() << AccessTimeHardware::IsInvariantTSC()
+        << AccessTimeHardware::IsConstantTSC() << "\n";
+    return Key.str();
+}
+
+// take the time source of a stored calibration, if it is still usable on this host.
+// A trusted TSC is chosen by the measurement, unless its reads trap or step back, so a cached HPET or OS source is only valid,
+// if the TSC is distrusted now or was rejected by the measurement of the cache. A shared one may have been preferred by its publisher
+bool HighPerTimer::RestoreSource ( const int Source, const int FreqOrigin, const bool TSCAvailable, const bool AnySource,
+                                   const bool TSCRejected )
+{
+    bool Distrusted ( !HighPerTimer::DistrustTSC ( TSCAvailable ).empty() );
+    bool TSCTrusted ( !Distrusted && !TSCRejected );
+    if ( static_cast<int> ( TimeSource::TSC ) == Source )
+    {
+        if ( Distrusted )
+        {
+            return false;
+        }
+        HighPerTimer::HPTimerSource = TimeSource::TSC;
+        if ( ( FreqOrigin > static_cast<int> ( TSCFreqOrigin::Unknown ) ) && ( FreqOrigin <= static_cast<int> ( TSCFreqOrigin::Measured ) ) )
+        {
+            TSCTimer::FreqOrigin = static_cast<TSCFreqOrigin> ( FreqOrigin );
+        }
+    }
+    else if ( static_cast<int> ( TimeSource::HPET ) == Source )
+    {
+        if ( ( TSCTrusted && !AnySource ) || !HPETTimer::InitHPETTimer() )
+        {
+            return false;
+        }
+        HighPerTimer::HPTimerSource = TimeSource::HPET;
+    }
+    else if ( static_cast<int> ( TimeSource::ARM ) == Source )
+    {
+        if ( !ARMTimer::InitARMTimer() )
+        {
+            return false;
+        }
+        HighPerTimer::HPTimerSource = TimeSource::ARM;
+    }
+    else if ( static_cast<int> ( TimeSource::OS ) == Source )
+    {
+        if ( !AnySource && ( TSCTrusted || ARMTimer::InitARMTimer() ) )
+        {
+            return false;
+        }
+        HighPerTimer::HPTimerSource = TimeSource::OS;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// load the calibration from the cache file, if it was written on this boot on the same CPU
+bool HighPerTimer::LoadCalibration()
+{
+    std::string Path ( CachePath ( false ) ), Content;
+    if ( Path.empty() || !ReadCache ( Path, Content ) )
+    {
+        return false;
+    }
+
+    bool TSCAvailable;
+    std::string Key ( HighPerTimer::CalibrationKey ( &TSCAvailable ) );
+    if ( Key.empty() )
+    {
+        return false;
+    }
+
+    std::istringstream Cache ( Content );
+    std::string Line, CachedKey;
+    if ( !std::getline ( Cache, Line ) || ( Line != CacheHeader ) )
+    {
+        return false;
+    }
+    for ( uint32_t i = 0; i < 3 && std::getline ( Cache, Line ); ++i )
+    {
+        CachedKey += Line + "\n";
+    }
+    if ( CachedKey != Key )
+    {
+        return false;
+    }
+
+    int Source ( -1 );
+    double NsecPerTic ( 0 ), Jiffies ( 0 );
+    int64_t TicsPerUsec ( 0 ), BusyWait ( -1 );
+    int FreqOrigin ( static_cast<int> ( TSCFreqOrigin::Unknown ) );
+    int TSCRejected ( 0 );
+    while ( std::getline ( Cache, Line ) )
+    {
+        std::istringstream Value ( Line.substr ( Line.find ( '=' ) + 1 ) );
+        if ( 0 == Line.compare ( 0, 7, "source=" ) )
+        {
+            Value >> Source;
+        }
+        else if ( 0 == Line.compare ( 0, 13, "nsec_per_tic=" ) )
+        {
+            Value >> NsecPerTic;
+        }
+        else if ( 0 == Line.compare ( 0, 14, "tics_per_usec=" ) )
+        {
+            Value >> TicsPerUsec;
+        }
+        else if ( 0 == Line.compare ( 0, 8, "jiffies=" ) )
+        {
+            Value >> Jiffies;
+        }
+        else if ( 0 == Line.compare ( 0, 15, "busy_wait_nsec=" ) )
+        {
+            Value >> BusyWait;
+        }
+        else if ( 0 == Line.compare ( 0, 16, "tsc_freq_origin=" ) )
+        {
+            Value >> FreqOrigin;
+        }
+        else if ( 0 == Line.compare ( 0, 13, "tsc_rejected=" ) )
+        {
+            Value >> TSCRejected;
+        }
+    }
+    if ( !std::isfinite ( NsecPerTic ) || !( NsecPerTic > 0 ) || ( TicsPerUsec <= 0 ) || !( Jiffies > 0 ) || ( BusyWait < 0 ) )
+    {
+        return false;
+    }
+
+    // the cached source has still to be usable
+    if ( !HighPerTimer::RestoreSource ( Source, FreqOrigin, TSCAvailable, false, 0 != TSCRejected ) )
+    {
+        return false;
+    }
+
+    HighPerTimer::InitTicsReader();
+    HighPerTimer::NsecPerTic.store ( NsecPerTic, std::memory_order_relaxed );
+    HighPerTimer::TicsPerUsec.store ( TicsPerUsec, std::memory_order_relaxed );
+    HighPerTimer::InitFixedPoint();
+    HighPerTimer::InitUnixZeroShift();
+    HighPerTimer::InitMaxMinHPTimer();
+    HighPerTimer::HPJiffies.store ( Jiffies, std::memory_order_relaxed );
+    HighPerTimer::HPSleepMode = SleepMode::Adaptive;
+    HighPerTimer::BusyWaitNSec.store ( BusyWait, std::memory_order_relaxed );
+    HighPerTimer::CalibrationCached = true;
+    return true;
+}
+
+// save the calibration to the cache file. The file is written under a fresh temporary name and renamed,
+// so concurrently starting processes never read a partial file. Failures are silently ignored
+void HighPerTimer::SaveCalibration()
+{
+    std::string Path ( CachePath ( true ) );
+    std::string Key ( HighPerTimer::CalibrationKey() );
+    if ( Path.empty() || Key.empty() )
+    {
+        return;
+    }
+    // a TSC, which the kernel and the hypervisor trust, but which the measurement did not choose
+    const SourceSelection & Selection ( HighPerTimer::Selection() );
+    bool TSCRejected ( Selection.Candidates[static_cast<int> ( TimeSource::TSC )].Available && ( TimeSource::TSC != Selection.Chosen )
+                       && HighPerTimer::DistrustTSC ( true ).empty() );
+    std::ostringstream Cache;
+    Cache.precision ( 17 );
+    Cache << CacheHeader << "\n" << Key
+          << "source=" << static_cast<int> ( HighPerTimer::HPTimerSource ) << "\n"
+          << "nsec_per_tic=" << HighPerTimer::NsecPerTic.load ( std::memory_order_relaxed ) << "\n"
+          << "tics_per_usec=" << HighPerTimer::TicsPerUsec.load ( std::memory_order_relaxed ) << "\n"
+          << "jiffies=" << HighPerTimer::HPJiffies.load ( std::memory_order_relaxed ) << "\n"
+          << "busy_wait_nsec=" << HighPerTimer::BusyWaitNSec.load ( std::memory_order_relaxed ) << "\n"
+          << "tsc_freq_origin=" << static_cast<int> ( TSCTimer::FreqOrigin ) << "\n"
+          << "tsc_rejected=" << TSCRejected << "\n";
+    std::string Content ( Cache.str() );
+
+    // mkstemp() creates the file exclusively with mode 0600, an existing file or link of that name is never opened
+    std::string TmpPath ( Path + ".XXXXXX" );
+    int Fd ( mkstemp ( &TmpPath[0] ) );
+    if ( Fd < 0 )
+    {
+        return;
+    }
+    bool Written ( static_cast<ssize_t> ( Content.size() ) == write ( Fd, Content.data(), Content.size() ) );
+    Written = ( 0 == close ( Fd ) ) && Written;
+    if ( !Written || ( 0 != rename ( TmpPath.c_str(), Path.c_str() ) ) )
+    {
+        unlink ( TmpPath.c_str() );
+    }
+}
+
+} // namespace HPTimer
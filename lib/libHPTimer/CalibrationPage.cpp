@@ -0,0 +1,348 @@
+/*
+ * @file   CalibrationPage.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Calibration shared by the processes of a host in a page of shared memory, protected by a sequence lock
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "HighPerTimer.h"
+
+// environment variable with the path of the page. An empty value disables the page
+static const char PageEnv[] = "HPTIMER_CALIBRATION_PAGE";
+
+// page of all users of the host, a daemon publishes it for all of them
+static const char DefaultPagePath[] = "/dev/shm/libHPTimer-calibration";
+
+static const char PageMagic[8] = { 'H', 'P', 'T', 'C', 'A', 'L', 'I', 'B' };
+
+// the number is increased whenever the layout changes
+constexpr uint32_t PageVersion = 1;
+
+// reads of the page, after which a reader gives up on a publisher which does not finish its update
+constexpr uint32_t SeqRetries = 1000;
+
+// the values of the page, each one stored in a 64-bit word
+enum PageValue
+{
+    KeyHash, Source, Clock, FreqOrigin, NsecPerTic, TicsPerUsec, NSecMult, NSecShift,
+    TicsMult, TicsShift, UnixZeroShift, Jiffies, BusyWait, ValueCount
+};
+
+// the layout of the shared page. The sequence number is odd while the publisher writes the values,
+// each value is an atomic word, so a reader, which races with the publisher, gets a torn copy at most and retries
+struct CalibrationPageLayout
+{
+    char mMagic[8];
+    uint32_t mVersion;
+    std::atomic<uint32_t> mSeq;
+    std::atomic<uint64_t> mValues[ValueCount];
+};
+
+constexpr size_t PageBytes = 4096;
+static_assert ( sizeof ( CalibrationPageLayout ) <= PageBytes, "the calibration page exceeds one page" );
+
+namespace HPTimer
+{
+
+bool HighPerTimer::CalibrationShared ( false );
+
+// the page of the publisher, mapped writable, and the one of a reader, mapped read only
+static CalibrationPageLayout * Published ( NULL );
+static const CalibrationPageLayout * Attached ( NULL );
+
+// sequence number of the calibration, which was taken from the attached page
+static uint32_t AttachedSeq ( 0 );
+
+// serializes the publishers of this process
+static std::mutex PublishMutex;
+
+// path of the page, empty if the page is disabled
+static std::string PagePath()
+{
+    const char * Env ( getenv ( PageEnv ) );
+    return std::string ( NULL != Env ? Env : DefaultPagePath );
+}
+
+// FNV-1a hash of the key, the page is only valid on the boot and the CPU of its publisher
+static uint64_t HashKey ( const std::string & Key )
+{
+    uint64_t Hash ( 14695981039346656037ULL );
+    for ( const char c : Key )
+    {
+        Hash = ( Hash ^ static_cast<unsigned char> ( c ) ) * 1099511628211ULL;
+    }
+    return Hash;
+}
+
+static uint64_t DoubleBits ( const double Value )
+{
+    uint64_t Bits;
+    memcpy ( &Bits, &Value, sizeof ( Bits ) );
+    return Bits;
+}
+
+static double BitsDouble ( const uint64_t Bits )
+{
+    double Value;
+    memcpy ( &Value, &Bits, sizeof ( Value ) );
+    return Value;
+}
+
+// map the page read only. It must be a regular file of root or of the current user, which nobody else can write,
+// so nobody else can feed the calibration
+static const CalibrationPageLayout * MapPage()
+{
+    std::string Path ( PagePath() );
+    if ( Path.empty() )
+    {
+        return NULL;
+    }
+    int Fd ( open ( Path.c_str(), O_RDONLY | O_NOFOLLOW ) );
+    if ( Fd < 0 )
+    {
+        return NULL;
+    }
+    struct stat Stat;
+    void * Map ( MAP_FAILED );
+    if ( ( 0 == fstat ( Fd, &Stat ) ) && S_ISREG ( Stat.st_mode ) && ( ( 0 == Stat.st_uid ) || ( geteuid() == Stat.st_uid ) ) &&
+         ( 0 == ( Stat.st_mode & ( S_IWGRP | S_IWOTH ) ) ) && ( Stat.st_size >= static_cast<off_t> ( PageBytes ) ) )
+    {
+        Map = mmap ( NULL, PageBytes, PROT_READ, MAP_SHARED, Fd, 0 );
+    }
+    close ( Fd );
+    if ( MAP_FAILED == Map )
+    {
+        return NULL;
+    }
+    const CalibrationPageLayout * Page ( static_cast<const CalibrationPageLayout *> ( Map ) );
+    if ( ( 0 != memcmp ( Page->mMagic, PageMagic, sizeof ( PageMagic ) ) ) || ( PageVersion != Page->mVersion ) )
+    {
+        munmap ( Map, PageBytes );
+        return NULL;
+    }
+    return Page;
+}
+
+// copy the values under the sequence lock
+// @return false if the page was never published or the publisher did not finish its update
+static bool ReadPage ( const CalibrationPageLayout * Page, uint64_t * Values, uint32_t & Seq )
+{
+    for ( uint32_t i = 0; i < SeqRetries; ++i )
+    {
+        uint32_t Begin ( Page->mSeq.load ( std::memory_order_acquire ) );
+        if ( Begin & 1 )
+        {
+            sched_yield();
+            continue;
+        }
+        for ( uint32_t v = 0; v < ValueCount; ++v )
+        {
+            Values[v] = Page->mValues[v].load ( std::memory_order_relaxed );
+        }
+        std::atomic_thread_fence ( std::memory_order_acquire );
+        if ( Page->mSeq.load ( std::memory_order_relaxed ) == Begin )
+        {
+            Seq = Begin;
+            return 0 != Begin;
+        }
+    }
+    return false;
+}
+
+// at the initialization the source of the publisher is taken, later only a changed frequency and shift of it
+bool HighPerTimer::AttachCalibration ( const bool Initial )
+{
+    if ( Initial )
+    {
+        Attached = MapPage();
+    }
+    if ( NULL == Attached )
+    {
+        return false;
+    }
+    uint64_t Values[ValueCount];
+    uint32_t Seq;
+    if ( !ReadPage ( Attached, Values, Seq ) || ( !Initial && ( Seq == AttachedSeq ) ) )
+    {
+        return false;
+    }
+    // a refresh keeps the source, which was probed at the initialization
+    bool TSCAvailable ( false );
+    std::string Key ( HighPerTimer::CalibrationKey ( Initial ? &TSCAvailable : NULL ) );
+    double NsecPerTic ( BitsDouble ( Values[PageValue::NsecPerTic] ) );
+    int Source ( static_cast<int> ( Values[PageValue::Source] ) );
+    if ( Key.empty() || ( HashKey ( Key ) != Values[KeyHash] ) || !std::isfinite ( NsecPerTic ) || !( NsecPerTic > 0 ) ||
+         ( static_cast<int64_t> ( Values[PageValue::TicsPerUsec] ) <= 0 ) || ( 0 == Values[PageValue::NSecMult] ) )
+    {
+        return false;
+    }
+    // the OS source has to read the clock of the publisher
+    OSClock OldClock ( OSTimer::Clock );
+    OSClock PageClock ( static_cast<OSClock> ( Values[PageValue::Clock] ) );
+    if ( ( static_cast<int> ( TimeSource::OS ) == Source ) && ( PageClock != OldClock ) && ( !Initial || !OSTimer::InitOSTimer ( PageClock ) ) )
+    {
+        return false;
+    }
+    if ( Initial )
+    {
+        if ( !HighPerTimer::RestoreSource ( Source, static_cast<int> ( Values[PageValue::FreqOrigin] ), TSCAvailable, true, false ) )
+        {
+            if ( OSTimer::Clock != OldClock )
+            {
+                OSTimer::InitOSTimer ( OldClock );
+            }
+            return false;
+        }
+        HighPerTimer::InitTicsReader();
+    }
+    else if ( static_cast<int> ( HighPerTimer::HPTimerSource ) != Source )
+    {
+        return false;
+    }
+
+    // the fixed-point pairs are taken as they are, so the conversions are identical to the ones of the publisher
+    HighPerTimer::NsecPerTic.store ( NsecPerTic, std::memory_order_relaxed );
+    HighPerTimer::TicsPerUsec.store ( static_cast<int64_t> ( Values[PageValue::TicsPerUsec] ), std::memory_order_relaxed );
+    HighPerTimer::StoreFixedPoint ( Values[PageValue::NSecMult], static_cast<uint32_t> ( Values[PageValue::NSecShift] ),
+                                    Values[PageValue::TicsMult], static_cast<uint32_t> ( Values[PageValue::TicsShift] ) );
+    HighPerTimer::UnixZeroShift.store ( static_cast<int64_t> ( Values[PageValue::UnixZeroShift] ), std::memory_order_relaxed );
+    if ( Initial )
+    {
+        HighPerTimer::InitMaxMinHPTimer();
+    }
+    else
+    {
+        HighPerTimer::StoreRangeLimits();
+    }
+    HighPerTimer::HPJiffies.store ( BitsDouble ( Values[PageValue::Jiffies] ), std::memory_order_relaxed );
+    if ( Initial )
+    {
+        HighPerTimer::HPSleepMode = SleepMode::Adaptive;
+    }
+    HighPerTimer::BusyWaitNSec.store ( static_cast<int64_t> ( Values[PageValue::BusyWait] ), std::memory_order_relaxed );
+    HighPerTimer::CalibrationShared = true;
+    AttachedSeq = Seq;
+    return true;
+}
+
+// the page is created by the first publisher and kept mapped for the later updates. A page, which is not yet
+// valid, gets its magic after the first values, so a reader never takes a page, which is only half created
+bool HighPerTimer::PublishCalibration()
+{
+    HighPerTimer::EnsureInitialized();
+    // the corrected reads of this process can not be reproduced by another one
+    if ( HighPerTimer::TSCSkewCorrected )
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> Lock ( PublishMutex );
+    if ( NULL == Published )
+    {
+        std::string Path ( PagePath() );
+        if ( Path.empty() )
+        {
+            return false;
+        }
+        int Fd ( open ( Path.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW, 0644 ) );
+        if ( Fd < 0 )
+        {
+            return false;
+        }
+        struct stat Stat;
+        void * Map ( MAP_FAILED );
+        if ( ( 0 == fstat ( Fd, &Stat ) ) && S_ISREG ( Stat.st_mode ) && ( geteuid() == Stat.st_uid ) &&
+             ( ( Stat.st_size >= static_cast<off_t> ( PageBytes ) ) || ( 0 == ftruncate ( Fd, PageBytes ) ) ) )
+        {
+            fchmod ( Fd, 0644 );
+            Map = mmap ( NULL, PageBytes, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0 );
+        }
+        close ( Fd );
+        if ( MAP_FAILED == Map )
+        {
+            return false;
+        }
+        Published = static_cast<CalibrationPageLayout *> ( Map );
+    }
+    uint64_t Values[ValueCount];
+    Values[KeyHash] = HashKey ( HighPerTimer::CalibrationKey() );
+    Values[PageValue::Source] = static_cast<uint64_t> ( HighPerTimer::HPTimerSource );
+    Values[PageValue::Clock] = static_cast<uint64_t> ( OSTimer::Clock );
+    Values[PageValue::FreqOrigin] = static_cast<uint64_t> ( TSCTimer::FreqOrigin );
+    Values[PageValue::NsecPerTic] = DoubleBits ( HighPerTimer::NsecPerTic.load ( std::memory_order_relaxed ) );
+    Values[PageValue::TicsPerUsec] = static_cast<uint64_t> ( HighPerTimer::TicsPerUsec.load ( std::memory_order_relaxed ) );
+    uint64_t NMult, TMult;
+    uint32_t NShift, TShift;
+    HighPerTimer::LoadPair ( HighPerTimer::NSecMult, HighPerTimer::NSecShift, NMult, NShift );
+    HighPerTimer::LoadPair ( HighPerTimer::TicsMult, HighPerTimer::TicsShift, TMult, TShift );
+    Values[PageValue::NSecMult] = NMult;
+    Values[PageValue::NSecShift] = NShift;
+    Values[PageValue::TicsMult] = TMult;
+    Values[PageValue::TicsShift] = TShift;
+    Values[PageValue::UnixZeroShift] = static_cast<uint64_t> ( HighPerTimer::GetUnixZeroShift() );
+    Values[PageValue::Jiffies] = DoubleBits ( HighPerTimer::HPJiffies.load ( std::memory_order_relaxed ) );
+    Values[PageValue::BusyWait] = static_cast<uint64_t> ( HighPerTimer::BusyWaitNSec.load ( std::memory_order_relaxed ) );
+
+    // an odd number left by a publisher, which died during its update, is completed
+    uint32_t Seq ( Published->mSeq.load ( std::memory_order_relaxed ) | 1 );
+    Published->mSeq.store ( Seq, std::memory_order_relaxed );
+    std::atomic_thread_fence ( std::memory_order_release );
+    for ( uint32_t v = 0; v < ValueCount; ++v )
+    {
+        Published->mValues[v].store ( Values[v], std::memory_order_relaxed );
+    }
+    Published->mSeq.store ( Seq + 1, std::memory_order_release );
+    if ( 0 != memcmp ( Published->mMagic, PageMagic, sizeof ( PageMagic ) ) || ( PageVersion != Published->mVersion ) )
+    {
+        Published->mVersion = PageVersion;
+        memcpy ( Published->mMagic, PageMagic, sizeof ( PageMagic ) );
+    }
+    return true;
+}
+
+// @exception std::out_of_range if NsecPerTic is not positive
+bool HighPerTimer::PublishCalibration ( const double NsecPerTic, const int64_t UnixZeroShift )
+{
+    if ( !std::isfinite ( NsecPerTic ) || !( NsecPerTic > 0 ) )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HighPerTimer" ) );
+    }
+    HighPerTimer::EnsureInitialized();
+    HighPerTimer::NsecPerTic.store ( NsecPerTic, std::memory_order_relaxed );
+    HighPerTimer::InitFixedPoint();
+    HighPerTimer::UnixZeroShift.store ( UnixZeroShift, std::memory_order_relaxed );
+    HighPerTimer::StoreRangeLimits();
+    return HighPerTimer::PublishCalibration();
+}
+
+bool HighPerTimer::RefreshCalibration()
+{
+    HighPerTimer::EnsureInitialized();
+    return HighPerTimer::AttachCalibration ( false );
+}
+
+} // namespace HPTimer
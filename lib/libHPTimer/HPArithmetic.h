@@ -0,0 +1,379 @@
+/*
+ * @file   HPArithmetic.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Arithmetic of the tics without exceptions: wrapping, saturating and checked with an error code
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPARITHMETIC_H
+#define _HPARITHMETIC_H
+#include "HPTimestamp.h"
+
+namespace HPTimer
+{
+
+/// arithmetic modulo 2^64, as of unsigned integers. A sum or difference is one instruction, an overflow is not detected
+struct HPWrapArith
+{
+    inline static constexpr int64_t Add ( const int64_t Tics1, const int64_t Tics2 ) noexcept
+    {
+        return static_cast<int64_t> ( static_cast<uint64_t> ( Tics1 ) + static_cast<uint64_t> ( Tics2 ) );
+    };
+
+    inline static constexpr int64_t Sub ( const int64_t Tics1, const int64_t Tics2 ) noexcept
+    {
+        return static_cast<int64_t> ( static_cast<uint64_t> ( Tics1 ) - static_cast<uint64_t> ( Tics2 ) );
+    };
+};
+
+/// arithmetic saturating to the limits of int64, which are constant. The conversions to nanoseconds saturate
+/// to the same limits, so a saturated value converts as the HPTimer_MAX or HPTimer_MIN. An overflow costs one predicted branch
+struct HPSaturateArith
+{
+    inline static int64_t Add ( const int64_t Tics1, const int64_t Tics2 ) noexcept
+    {
+        int64_t Sum;
+        // an overflow needs equal signs, so the sign of the first operand gives the limit
+        return __builtin_add_overflow ( Tics1, Tics2, &Sum ) ? ( Tics1 >> 63 ) ^ INT64_MAX : Sum;
+    };
+
+    inline static int64_t Sub ( const int64_t Tics1, const int64_t Tics2 ) noexcept
+    {
+        int64_t Difference;
+        // an overflow needs different signs, so the sign of the first operand gives the limit
+        return __builtin_sub_overflow ( Tics1, Tics2, &Difference ) ? ( Tics1 >> 63 ) ^ INT64_MAX : Difference;
+    };
+};
+
+/// arithmetic checked against HPTimer_MAX and HPTimer_MIN as by HPTicsAdd() and HPTicsSub(), but with an error code
+struct HPCheckedArith
+{
+    /** add two tic values
+     * @param Tics1 is the first summand
+     * @param Tics2 is the second summand
+     * @param Sum is set to the sum, or to the exceeded limit of the HPTimer range
+     * @return false if the sum is out of the HPTimer range
+     */
+    inline static bool Add ( const int64_t Tics1, const int64_t Tics2, int64_t & Sum ) noexcept
+    {
+        bool Overflow ( __builtin_add_overflow ( Tics1, Tics2, &Sum ) );
+        Sum = Overflow ? ( Tics1 >> 63 ) ^ INT64_MAX : Sum;
+        return HPCheckedArith::Limit ( Sum ) && !Overflow;
+    };
+
+    /** subtract two tic values
+     * @param Tics1 is the minuend
+     * @param Tics2 is the subtrahend
+     * @param Difference is set to the difference, or to the exceeded limit of the HPTimer range
+     * @return false if the difference is out of the HPTimer range
+     */
+    inline static bool Sub ( const int64_t Tics1, const int64_t Tics2, int64_t & Difference ) noexcept
+    {
+        bool Overflow ( __builtin_sub_overflow ( Tics1, Tics2, &Difference ) );
+        Difference = Overflow ? ( Tics1 >> 63 ) ^ INT64_MAX : Difference;
+        return HPCheckedArith::Limit ( Difference ) && !Overflow;
+    };
+
+private:
+    /// clamp the value to the HPTimer range, false if it was out of it.
+    /// The range may be the one of int64, if the counter runs faster than 1 GHz, so the caller checks the overflow too
+    inline static bool Limit ( int64_t & Tics ) noexcept
+    {
+        int64_t Max ( HighPerTimer::MaxHPTics() );
+        int64_t Min ( HighPerTimer::MinHPTics() );
+        bool InRange ( ( Tics <= Max ) && ( Tics >= Min ) );
+        Tics = Tics > Max ? Max : ( Tics < Min ? Min : Tics );
+        return InRange;
+    };
+};
+
+template <class Arith> class HPBasicTimestamp;
+
+//! Time interval in tics as HPDuration, whose arithmetic is given by the policy Arith, HPWrapArith or HPSaturateArith
+/*!
+ * No operation throws, so the type can be used in units built without exceptions and its arithmetic is inlined
+ * to integer instructions without a branch.
+ */
+template <class Arith>
+class HPBasicDuration
+{
+public:
+    /// standard ctor, zero interval
+    HPBasicDuration() = default;
+
+    /// convert the interval
+    inline explicit HPBasicDuration ( const HPDuration & Duration ) noexcept :
+            mHPTics ( Duration.HPTics() )
+    {
+    };
+
+    /// create the interval from the tics of the timer counter
+    inline static constexpr HPBasicDuration FromTics ( const int64_t HPTics ) noexcept
+    {
+        return HPBasicDuration ( HPTics, 0 );
+    };
+
+    /// create the interval from nseconds, saturated to the limits of int64 tics
+    inline static HPBasicDuration FromNSec ( const int64_t NSeconds ) noexcept
+    {
+        return HPBasicDuration ( HighPerTimer::NSectoTic ( NSeconds ), 0 );
+    };
+
+    /// get the tics of the interval
+    inline constexpr int64_t HPTics() const noexcept
+    {
+        return mHPTics;
+    };
+
+    /// convert the interval to signed nseconds, saturated to the limits of int64
+    inline int64_t ToNSec() const noexcept
+    {
+        return HighPerTimer::TictoNSec ( mHPTics );
+    };
+
+    /// convert the interval to HPDuration
+    inline HPDuration ToHPDuration() const noexcept
+    {
+        return HPDuration::FromTics ( mHPTics );
+    };
+
+    inline HPBasicDuration & operator+= ( const HPBasicDuration & Duration ) noexcept
+    {
+        mHPTics = Arith::Add ( mHPTics, Duration.mHPTics );
+        return *this;
+    };
+
+    inline HPBasicDuration & operator-= ( const HPBasicDuration & Duration ) noexcept
+    {
+        mHPTics = Arith::Sub ( mHPTics, Duration.mHPTics );
+        return *this;
+    };
+
+    inline HPBasicDuration operator- () const noexcept
+    {
+        return HPBasicDuration ( Arith::Sub ( 0, mHPTics ), 0 );
+    };
+
+private:
+    friend class HPBasicTimestamp<Arith>;
+
+    inline constexpr HPBasicDuration ( const int64_t HPTics, int ) noexcept :
+            mHPTics ( HPTics )
+    {
+    };
+
+    /// tics of the timer counter
+    int64_t mHPTics = 0;
+};
+
+//! Point in time in tics as HPTimestamp, whose arithmetic is given by the policy Arith, HPWrapArith or HPSaturateArith
+template <class Arith>
+class HPBasicTimestamp
+{
+public:
+    typedef HPBasicDuration<Arith> Duration;
+
+    /// standard ctor, begin of Unix era
+    HPBasicTimestamp() = default;
+
+    /// convert the timestamp
+    inline explicit HPBasicTimestamp ( const HPTimestamp & Timestamp ) noexcept :
+            mHPTics ( Timestamp.HPTics() )
+    {
+    };
+
+    /// create the timestamp from the tics of the timer counter, shifted to unix zero
+    inline static constexpr HPBasicTimestamp FromTics ( const int64_t HPTics ) noexcept
+    {
+        return HPBasicTimestamp ( HPTics, 0 );
+    };
+
+    /// create the timestamp from nseconds since begin of Unix era, saturated to the limits of int64 tics
+    inline static HPBasicTimestamp FromNSec ( const int64_t NSeconds ) noexcept
+    {
+        return HPBasicTimestamp ( HighPerTimer::NSectoTic ( NSeconds ), 0 );
+    };
+
+    /// get the correct time
+    inline static HPBasicTimestamp Now() noexcept
+    {
+        return HPBasicTimestamp ( HPTimestamp::Now().HPTics(), 0 );
+    };
+
+    /// get the correct time, reading the timer counter with the reader given at compile time
+    /// NOTE: Reader must be equal to HighPerTimer::GetTicsReader()
+    template <TicsReader Reader>
+    inline static HPBasicTimestamp Now() noexcept
+    {
+        return HPBasicTimestamp ( HPTimestamp::Now<Reader>().HPTics(), 0 );
+    };
+
+    /// get the tics of the timestamp, shifted to unix zero
+    inline constexpr int64_t HPTics() const noexcept
+    {
+        return mHPTics;
+    };
+
+    /// convert the timestamp to signed nseconds since begin of Unix era, saturated to the limits of int64
+    inline int64_t ToNSec() const noexcept
+    {
+        return HighPerTimer::TictoNSec ( mHPTics );
+    };
+
+    /// convert the timestamp to HPTimestamp
+    inline HPTimestamp ToHPTimestamp() const noexcept
+    {
+        return HPTimestamp::FromTics ( mHPTics );
+    };
+
+    inline HPBasicTimestamp & operator+= ( const Duration & Interval ) noexcept
+    {
+        mHPTics = Arith::Add ( mHPTics, Interval.HPTics() );
+        return *this;
+    };
+
+    inline HPBasicTimestamp & operator-= ( const Duration & Interval ) noexcept
+    {
+        mHPTics = Arith::Sub ( mHPTics, Interval.HPTics() );
+        return *this;
+    };
+
+private:
+    inline constexpr HPBasicTimestamp ( const int64_t HPTics, int ) noexcept :
+            mHPTics ( HPTics )
+    {
+    };
+
+    /// tics of the timer counter, shifted to unix zero
+    int64_t mHPTics = 0;
+};
+
+/// timestamps and intervals with the arithmetic modulo 2^64
+typedef HPBasicTimestamp<HPWrapArith> HPWrapTimestamp;
+typedef HPBasicDuration<HPWrapArith> HPWrapDuration;
+
+/// timestamps and intervals with the arithmetic saturating to the limits of int64
+typedef HPBasicTimestamp<HPSaturateArith> HPSaturateTimestamp;
+typedef HPBasicDuration<HPSaturateArith> HPSaturateDuration;
+
+template <class Arith>
+inline HPBasicDuration<Arith> operator+ ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return HPBasicDuration<Arith>::FromTics ( Arith::Add ( Duration1.HPTics(), Duration2.HPTics() ) );
+}
+
+template <class Arith>
+inline HPBasicDuration<Arith> operator- ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return HPBasicDuration<Arith>::FromTics ( Arith::Sub ( Duration1.HPTics(), Duration2.HPTics() ) );
+}
+
+template <class Arith>
+inline HPBasicTimestamp<Arith> operator+ ( const HPBasicTimestamp<Arith> & Timestamp, const HPBasicDuration<Arith> & Duration ) noexcept
+{
+    return HPBasicTimestamp<Arith>::FromTics ( Arith::Add ( Timestamp.HPTics(), Duration.HPTics() ) );
+}
+
+template <class Arith>
+inline HPBasicTimestamp<Arith> operator- ( const HPBasicTimestamp<Arith> & Timestamp, const HPBasicDuration<Arith> & Duration ) noexcept
+{
+    return HPBasicTimestamp<Arith>::FromTics ( Arith::Sub ( Timestamp.HPTics(), Duration.HPTics() ) );
+}
+
+/// the interval between two timestamps
+template <class Arith>
+inline HPBasicDuration<Arith> operator- ( const HPBasicTimestamp<Arith> & Timestamp1, const HPBasicTimestamp<Arith> & Timestamp2 ) noexcept
+{
+    return HPBasicDuration<Arith>::FromTics ( Arith::Sub ( Timestamp1.HPTics(), Timestamp2.HPTics() ) );
+}
+
+template <class Arith>
+inline constexpr bool operator< ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return Duration1.HPTics() < Duration2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator> ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return Duration1.HPTics() > Duration2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator<= ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return Duration1.HPTics() <= Duration2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator>= ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return Duration1.HPTics() >= Duration2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator== ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return Duration1.HPTics() == Duration2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator!= ( const HPBasicDuration<Arith> & Duration1, const HPBasicDuration<Arith> & Duration2 ) noexcept
+{
+    return Duration1.HPTics() != Duration2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator< ( const HPBasicTimestamp<Arith> & Timestamp1, const HPBasicTimestamp<Arith> & Timestamp2 ) noexcept
+{
+    return Timestamp1.HPTics() < Timestamp2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator> ( const HPBasicTimestamp<Arith> & Timestamp1, const HPBasicTimestamp<Arith> & Timestamp2 ) noexcept
+{
+    return Timestamp1.HPTics() > Timestamp2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator<= ( const HPBasicTimestamp<Arith> & Timestamp1, const HPBasicTimestamp<Arith> & Timestamp2 ) noexcept
+{
+    return Timestamp1.HPTics() <= Timestamp2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator>= ( const HPBasicTimestamp<Arith> & Timestamp1, const HPBasicTimestamp<Arith> & Timestamp2 ) noexcept
+{
+    return Timestamp1.HPTics() >= Timestamp2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator== ( const HPBasicTimestamp<Arith> & Timestamp1, const HPBasicTimestamp<Arith> & Timestamp2 ) noexcept
+{
+    return Timestamp1.HPTics() == Timestamp2.HPTics();
+}
+
+template <class Arith>
+inline constexpr bool operator!= ( const HPBasicTimestamp<Arith> & Timestamp1, const HPBasicTimestamp<Arith> & Timestamp2 ) noexcept
+{
+    return Timestamp1.HPTics() != Timestamp2.HPTics();
+}
+
+} // namespace HPTimer
+#endif // _HPARITHMETIC_H
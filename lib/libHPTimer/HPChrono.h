@@ -0,0 +1,153 @@
+/*
+ * @file   HPChrono.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  std::chrono clock on the timer counter of HighPerTimer and the conversions of its time values
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPCHRONO_H
+#define _HPCHRONO_H
+#include <chrono>
+#include <ratio>
+#include "HPTimestamp.h"
+
+namespace HPTimer
+{
+
+//! Clock of the TrivialClock requirements of std::chrono, read from the timer counter of HighPerTimer
+/*!
+ * The period of a std::chrono clock is a ratio at compile time, but the tic rate is only known after the calibration,
+ * so the time points and durations count nanoseconds. now() reads the counter as HPTimestamp::Now() and converts the
+ * tics by the fixed-point multiplication of TictoNSec(), without any double. Code, which stores many time points,
+ * keeps the native tics by NowTics() and converts them later by FromTics().
+ * The epoch is the begin of unix era, as of the system clock, but the clock does not follow its steps.
+ * NOTE: The clock is steady, unless the OS time source is set to the realtime clock or a new calibration is taken
+ * by RefreshCalibration() or PublishCalibration()
+ */
+class HPClock
+{
+public:
+    typedef int64_t rep;
+    typedef std::nano period;
+    typedef std::chrono::nanoseconds duration;
+    typedef std::chrono::time_point<HPClock> time_point;
+    static constexpr bool is_steady = true;
+
+    /// get the current time
+    inline static time_point now() noexcept
+    {
+        return HPClock::FromTics ( HPTimestamp::Now().HPTics() );
+    };
+
+    /// get the current time in tics, shifted to unix zero as HPTimestamp::HPTics()
+    inline static int64_t NowTics()
+    {
+        return HPTimestamp::Now().HPTics();
+    };
+
+    /// convert tics, shifted to unix zero, to a time point
+    inline static time_point FromTics ( const int64_t HPTics ) noexcept
+    {
+        return time_point ( duration ( HighPerTimer::TictoNSec ( HPTics ) ) );
+    };
+
+    /// convert a time point to tics, shifted to unix zero
+    inline static int64_t ToTics ( const time_point & Time )
+    {
+        return HighPerTimer::NSectoTic ( Time.time_since_epoch().count() );
+    };
+
+    /// convert a timestamp to a time point
+    inline static time_point FromTimestamp ( const HPTimestamp & Timestamp ) noexcept
+    {
+        return HPClock::FromTics ( Timestamp.HPTics() );
+    };
+
+    /// convert a time point to a timestamp
+    inline static HPTimestamp ToTimestamp ( const time_point & Time )
+    {
+        return HPTimestamp::FromTics ( HPClock::ToTics ( Time ) );
+    };
+
+    /// convert a time point to the one of the system clock with the same time since the begin of unix era
+    inline static std::chrono::system_clock::time_point ToSystem ( const time_point & Time )
+    {
+        return std::chrono::system_clock::time_point (
+                   std::chrono::duration_cast<std::chrono::system_clock::duration> ( Time.time_since_epoch() ) );
+    };
+
+    /// convert a time point of the system clock to the one with the same time since the begin of unix era
+    inline static time_point FromSystem ( const std::chrono::system_clock::time_point & Time )
+    {
+        return time_point ( std::chrono::duration_cast<duration> ( Time.time_since_epoch() ) );
+    };
+
+    /// wait untill the time point with the sleep of HighPerTimer, which spins the last part of the wait
+    inline static void SleepUntil ( const time_point & Time )
+    {
+        HPClock::ToTimestamp ( Time ).SleepTo();
+    };
+};
+
+//! Clock as HPClock, reading the timer counter with the reader given at compile time
+/*!
+ * The read is inlined as by HPTimestamp::Now<Reader>(), its time points are the ones of HPClock.
+ * NOTE: Reader must be equal to HighPerTimer::GetTicsReader(), so select the instantiation once after initialization
+ */
+template <TicsReader Reader>
+class HPReaderClock
+{
+public:
+    typedef HPClock::rep rep;
+    typedef HPClock::period period;
+    typedef HPClock::duration duration;
+    typedef HPClock::time_point time_point;
+    static constexpr bool is_steady = HPClock::is_steady;
+
+    /// get the current time
+    inline static time_point now() noexcept
+    {
+        return HPClock::FromTics ( HPTimestamp::Now<Reader>().HPTics() );
+    };
+
+    /// get the current time in tics, shifted to unix zero as HPTimestamp::HPTics()
+    inline static int64_t NowTics()
+    {
+        return HPTimestamp::Now<Reader>().HPTics();
+    };
+};
+
+template <TicsReader Reader>
+constexpr bool HPReaderClock<Reader>::is_steady;
+
+/// convert an interval to std::chrono nanoseconds by the fixed-point multiplication
+inline std::chrono::nanoseconds ToChrono ( const HPDuration & Duration )
+{
+    return std::chrono::nanoseconds ( Duration.ToNSec() );
+}
+
+/// convert a std::chrono duration to an interval, a duration finer than nanoseconds is truncated toward zero
+template <class Rep, class Period>
+inline HPDuration FromChrono ( const std::chrono::duration<Rep, Period> & Duration )
+{
+    return HPDuration::FromNSec ( std::chrono::duration_cast<std::chrono::nanoseconds> ( Duration ).count() );
+}
+
+} // namespace HPTimer
+#endif // _HPCHRONO_H
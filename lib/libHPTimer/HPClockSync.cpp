@@ -0,0 +1,227 @@
+/*
+ * @file   HPClockSync.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Continuous resynchronization of the timer counter to the system wall clock
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <cstdlib>
+#include <time.h>
+#include "HPClockSync.h"
+
+// C++ macro for one billion ( 10^9 )
+constexpr int64_t ONE_BILLION = 1000000000LL;
+
+// number of reads of the wall clock, from which the one with the narrowest bracket of counter reads is taken
+constexpr uint32_t SampleAttempts = 16;
+
+// maximal rate correction, by which the remaining offset is slewed in, in ppm as the slew limit of NTP
+constexpr double MaxSlewPPM = 500.0;
+
+namespace HPTimer
+{
+
+// ctor
+// @exception std::out_of_range if a parameter is not positive or the window is too small
+HPClockSync::HPClockSync ( const HPDuration & Interval, const uint32_t Window, const HPDuration & StepLimit ) :
+        mInterval ( Interval.HPTics() ),
+        mWindow ( Window ),
+        mStepLimit ( StepLimit.ToNSec() ),
+        mSeq ( 0 ),
+        mBaseTics ( 0 ),
+        mBaseNSec ( 0 ),
+        mSlope ( HighPerTimer::GetNsecPerTic() ),
+        mErrorNSec ( 0 ),
+        mDriftPPM ( 0 ),
+        mSamples ( 1 ),
+        mSteps ( 0 ),
+        mStop ( false )
+{
+    if ( ( mInterval <= 0 ) || ( mWindow < 2 ) || ( mStepLimit <= 0 ) )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HPClockSync" ) );
+    }
+    Sample First ( TakeSample() );
+    mHistory.reserve ( mWindow + 1 );
+    mHistory.push_back ( First );
+    Publish ( First.mTics, First.mNSec, HighPerTimer::GetNsecPerTic() );
+    mErrorNSec.store ( static_cast<int64_t> ( First.mWidth * HighPerTimer::GetNsecPerTic() / 2 ), std::memory_order_relaxed );
+}
+
+HPClockSync::~HPClockSync()
+{
+    Stop();
+}
+
+void HPClockSync::Start()
+{
+    std::lock_guard<std::mutex> Lock ( mMutex );
+    if ( mDriver.joinable() )
+    {
+        return;
+    }
+    mStop = false;
+    mDriver = std::thread ( &HPClockSync::Run, this );
+}
+
+void HPClockSync::Stop()
+{
+    {
+        std::lock_guard<std::mutex> Lock ( mMutex );
+        if ( !mDriver.joinable() )
+        {
+            return;
+        }
+        mStop = true;
+        mSleeper.Interrupt();
+    }
+    mDriver.join();
+}
+
+// fit the rate and the offset over the last samples by least squares and publish a mapping, which is continuous
+// at the new sample. Its rate is the fitted one plus the correction, which removes the remaining offset within one interval.
+// An offset above the step limit means, the wall clock was stepped: the samples before are dropped and the mapping is stepped
+void HPClockSync::Sync()
+{
+    Sample New ( TakeSample() );
+    std::lock_guard<std::mutex> Lock ( mMutex );
+    mSamples.fetch_add ( 1, std::memory_order_relaxed );
+    double NsecPerTic ( HighPerTimer::GetNsecPerTic() );
+    double HalfWidth ( New.mWidth * NsecPerTic / 2 );
+
+    int64_t Current ( Mapped ( New.mTics ) );
+    if ( std::llabs ( New.mNSec - Current ) > mStepLimit )
+    {
+        mHistory.clear();
+        mHistory.push_back ( New );
+        Publish ( New.mTics, New.mNSec, mSlope.load ( std::memory_order_relaxed ) );
+        mSteps.fetch_add ( 1, std::memory_order_relaxed );
+        mErrorNSec.store ( static_cast<int64_t> ( HalfWidth ), std::memory_order_relaxed );
+        return;
+    }
+    mHistory.push_back ( New );
+    if ( mHistory.size() > mWindow )
+    {
+        mHistory.erase ( mHistory.begin() );
+    }
+
+    // the values are taken relative to the new sample, so the doubles keep the full precision
+    double Slope ( mSlope.load ( std::memory_order_relaxed ) );
+    double Fit ( 0 ), Residual ( 0 );
+    if ( mHistory.size() >= 2 )
+    {
+        double MeanX ( 0 ), MeanY ( 0 );
+        for ( size_t i = 0; i < mHistory.size(); ++i )
+        {
+            MeanX += static_cast<double> ( mHistory[i].mTics - New.mTics );
+            MeanY += static_cast<double> ( mHistory[i].mNSec - New.mNSec );
+        }
+        MeanX /= mHistory.size();
+        MeanY /= mHistory.size();
+        double Sxx ( 0 ), Sxy ( 0 );
+        for ( size_t i = 0; i < mHistory.size(); ++i )
+        {
+            double X ( mHistory[i].mTics - New.mTics - MeanX );
+            double Y ( mHistory[i].mNSec - New.mNSec - MeanY );
+            Sxx += X * X;
+            Sxy += X * Y;
+        }
+        if ( Sxx > 0 )
+        {
+            Slope = Sxy / Sxx;
+            Fit = MeanY - Slope * MeanX;
+            for ( size_t i = 0; i < mHistory.size(); ++i )
+            {
+                double Deviation ( mHistory[i].mNSec - New.mNSec - Fit - Slope * ( mHistory[i].mTics - New.mTics ) );
+                Residual += Deviation * Deviation;
+            }
+            Residual = std::sqrt ( Residual / mHistory.size() );
+        }
+    }
+
+    double Remaining ( static_cast<double> ( New.mNSec - Current ) + Fit );
+    double Correction ( Remaining / mInterval );
+    double MaxCorrection ( Slope * MaxSlewPPM * 1e-6 );
+    if ( Correction > MaxCorrection )
+    {
+        Correction = MaxCorrection;
+    }
+    else if ( Correction < -MaxCorrection )
+    {
+        Correction = -MaxCorrection;
+    }
+    Publish ( New.mTics, Current, Slope + Correction );
+    mDriftPPM.store ( ( Slope / NsecPerTic - 1.0 ) * 1e6, std::memory_order_relaxed );
+    mErrorNSec.store ( static_cast<int64_t> ( std::abs ( Remaining ) + Residual + HalfWidth ), std::memory_order_relaxed );
+}
+
+// main loop of the sync thread: sample and sleep one interval, Stop() interrupts the sleep
+void HPClockSync::Run()
+{
+    for ( ;; )
+    {
+        Sync();
+        int64_t WakeTics ( HPTimestamp::Now().HPTics() + mInterval - HighPerTimer::GetUnixZeroShift() );
+        std::unique_lock<std::mutex> Lock ( mMutex );
+        if ( mStop )
+        {
+            return;
+        }
+        mSleeper.WaitTo ( Lock, WakeTics );
+    }
+}
+
+// read the wall clock bracketed by two reads of the counter, the tics are taken in the middle of the bracket
+HPClockSync::Sample HPClockSync::TakeSample()
+{
+    Sample Best = { 0, 0, INT64_MAX };
+    for ( uint32_t i = 0; i < SampleAttempts; ++i )
+    {
+        timespec ts;
+        int64_t Before ( HPTimestamp::Now().HPTics() );
+        clock_gettime ( CLOCK_REALTIME, &ts );
+        int64_t After ( HPTimestamp::Now().HPTics() );
+        if ( After - Before < Best.mWidth )
+        {
+            Best.mWidth = After - Before;
+            Best.mTics = Before + Best.mWidth / 2;
+            Best.mNSec = static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( ts.tv_nsec );
+        }
+    }
+    return Best;
+}
+
+int64_t HPClockSync::Mapped ( const int64_t Tics ) const
+{
+    return mBaseNSec.load ( std::memory_order_relaxed )
+           + static_cast<int64_t> ( std::llround ( ( Tics - mBaseTics.load ( std::memory_order_relaxed ) ) * mSlope.load ( std::memory_order_relaxed ) ) );
+}
+
+// the sequence number is odd while the mapping is written, the readers retry then
+void HPClockSync::Publish ( const int64_t BaseTics, const int64_t BaseNSec, const double Slope )
+{
+    uint32_t Seq ( mSeq.load ( std::memory_order_relaxed ) );
+    mSeq.store ( Seq + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence ( std::memory_order_release );
+    mBaseTics.store ( BaseTics, std::memory_order_relaxed );
+    mBaseNSec.store ( BaseNSec, std::memory_order_relaxed );
+    mSlope.store ( Slope, std::memory_order_relaxed );
+    mSeq.store ( Seq + 2, std::memory_order_release );
+}
+
+} // namespace HPTimer
@@ -0,0 +1,209 @@
+/*
+ * @file   HPClockSync.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Continuous resynchronization of the timer counter to the system wall clock
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPCLOCKSYNC_H
+#define _HPCLOCKSYNC_H
+#include "HPTimestamp.h"
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HPTimer
+{
+
+//! Mapping of the timer counter to the NTP or PTP disciplined CLOCK_REALTIME
+/*!
+ * UnixZeroShift and NsecPerTic of HighPerTimer are measured once, so HighPerTimer and HPTimestamp drift against
+ * the wall clock by the calibration error of a few ppm. HPClockSync samples pairs of counter tics and CLOCK_REALTIME
+ * periodically, fits the rate and the offset over the last samples and publishes a linear mapping from the tics
+ * of HPTimestamp to the wall clock. The offset to the fit is slewed in over one interval, so the mapped time is continuous;
+ * only a step of CLOCK_REALTIME larger than the step limit is followed by a step of the mapping.
+ * The mapping is published through a sequence lock, so the readers never block and never wait for the sync thread.
+ * HighPerTimer itself keeps its fixed calibration, so durations measured with it are not influenced by the corrections.
+ */
+class HPClockSync
+{
+public:
+    /** ctor, takes the first sample, so the mapping is valid at once
+     * @param Interval is the time between two samples of the sync thread
+     * @param Window is the number of the last samples, over which the rate is fitted, at least 2
+     * @param StepLimit is the offset to the wall clock, above which the mapping is stepped and not slewed
+     * @exception std::out_of_range if a parameter is not positive or the window is too small
+     */
+    explicit HPClockSync ( const HPDuration & Interval = HPDuration::FromSec ( 1 ), const uint32_t Window = 16,
+                           const HPDuration & StepLimit = HPDuration::FromUSec ( 1000 ) );
+
+    /// dtor, stops the sync thread
+    ~HPClockSync();
+
+    HPClockSync ( const HPClockSync & ) = delete;
+    HPClockSync & operator= ( const HPClockSync & ) = delete;
+
+    /// start the sync thread. Nothing happens if it runs already
+    void Start();
+
+    /// stop the sync thread and wait for it. The last mapping stays valid
+    void Stop();
+
+    /// take a sample and update the mapping now, e.g. if the application drives the sync itself
+    void Sync();
+
+    /// get the current wall clock time in nanoseconds since begin of Unix era
+    inline int64_t NowNSec() const
+    {
+        return ToWallNSec ( HPTimestamp::Now() );
+    };
+
+    /// get the current wall clock time
+    inline HPTimestamp Now() const
+    {
+        return ToWallClock ( HPTimestamp::Now() );
+    };
+
+    /** map a timestamp of the timer to the wall clock
+     * @param Time is the timestamp taken with HighPerTimer or HPTimestamp
+     * @return nanoseconds since begin of Unix era of the wall clock at that time
+     */
+    inline int64_t ToWallNSec ( const HPTimestamp & Time ) const
+    {
+        for ( ;; )
+        {
+            uint32_t Seq ( mSeq.load ( std::memory_order_acquire ) );
+            int64_t BaseTics ( mBaseTics.load ( std::memory_order_relaxed ) );
+            int64_t BaseNSec ( mBaseNSec.load ( std::memory_order_relaxed ) );
+            double Slope ( mSlope.load ( std::memory_order_relaxed ) );
+            std::atomic_thread_fence ( std::memory_order_acquire );
+            if ( ( 0 == ( Seq & 1 ) ) && ( mSeq.load ( std::memory_order_relaxed ) == Seq ) )
+            {
+                return BaseNSec + static_cast<int64_t> ( std::llround ( ( Time.HPTics() - BaseTics ) * Slope ) );
+            }
+        }
+    };
+
+    /** map a timestamp of the timer to the wall clock
+     * @param Time is the timestamp taken with HighPerTimer or HPTimestamp
+     * @return timestamp, whose nanoseconds since begin of Unix era are the ones of the wall clock
+     */
+    inline HPTimestamp ToWallClock ( const HPTimestamp & Time ) const
+    {
+        return HPTimestamp::FromNSec ( ToWallNSec ( Time ) );
+    };
+
+    /// get the estimated error of the mapping: the remaining offset, the residual of the fit and the sampling uncertainty
+    inline HPDuration EstimatedError() const
+    {
+        return HPDuration::FromNSec ( mErrorNSec.load ( std::memory_order_relaxed ) );
+    };
+
+    /// get the fitted rate deviation of the counter from the calibration of HighPerTimer, in ppm
+    inline double DriftPPM() const
+    {
+        return mDriftPPM.load ( std::memory_order_relaxed );
+    };
+
+    /// get the number of samples taken since the construction
+    inline uint64_t Samples() const
+    {
+        return mSamples.load ( std::memory_order_relaxed );
+    };
+
+    /// get the number of steps of the mapping since the construction, the first sample is not counted
+    inline uint64_t Steps() const
+    {
+        return mSteps.load ( std::memory_order_relaxed );
+    };
+
+private:
+    /// pair of the tics of HPTimestamp and the wall clock nanoseconds at the same time
+    struct Sample
+    {
+        int64_t mTics;
+        int64_t mNSec;
+        int64_t mWidth;
+    };
+
+    /// main routine of the sync thread
+    void Run();
+
+    /// read the counter and the wall clock with the narrowest bracket of several attempts
+    static Sample TakeSample();
+
+    /// wall clock nanoseconds of the published mapping at the given tics, only called by the writer
+    int64_t Mapped ( const int64_t Tics ) const;
+
+    /// publish the new mapping under the sequence lock
+    void Publish ( const int64_t BaseTics, const int64_t BaseNSec, const double Slope );
+
+    /// time between two samples in tics
+    int64_t mInterval;
+
+    /// maximal number of samples of the fit
+    uint32_t mWindow;
+
+    /// offset in nanoseconds, above which the mapping is stepped
+    int64_t mStepLimit;
+
+    /// the last samples, oldest first
+    std::vector<Sample> mHistory;
+
+    /// sequence number of the mapping, odd while it is being written
+    std::atomic<uint32_t> mSeq;
+
+    /// tics of HPTimestamp, at which the mapping is anchored
+    std::atomic<int64_t> mBaseTics;
+
+    /// wall clock nanoseconds at mBaseTics
+    std::atomic<int64_t> mBaseNSec;
+
+    /// wall clock nanoseconds per tic
+    std::atomic<double> mSlope;
+
+    /// estimated error in nanoseconds
+    std::atomic<int64_t> mErrorNSec;
+
+    /// rate deviation from NsecPerTic in ppm
+    std::atomic<double> mDriftPPM;
+
+    /// number of samples
+    std::atomic<uint64_t> mSamples;
+
+    /// number of steps
+    std::atomic<uint64_t> mSteps;
+
+    /// the sync thread shall leave
+    bool mStop;
+
+    /// serializes the writers of the mapping and protects the state of the sync thread
+    std::mutex mMutex;
+
+    /// sleeper of the sync thread
+    HPSleeper mSleeper;
+
+    /// sync thread
+    std::thread mDriver;
+};
+
+} // namespace HPTimer
+#endif // _HPCLOCKSYNC_H
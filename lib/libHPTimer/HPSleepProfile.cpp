@@ -0,0 +1,307 @@
+/*
+ * @file   HPSleepProfile.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Opt-in statistics of the sleeps: wakeup lateness, time blocked in the OS and time spent busy-waiting
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "HPSleepProfile.h"
+
+namespace HPTimer
+{
+
+std::atomic<bool> HPSleepProfile::Enabled ( false );
+
+// generation of the statistics, increased by Reset(). A profile counts only in the generation it is tagged with
+static std::atomic<uint64_t> Generation ( 0 );
+
+HPSleepHistogram::HPSleepHistogram() :
+        mCount ( 0 ),
+        mSum ( 0 ),
+        mMax ( 0 )
+{
+    memset ( mCounts, 0, sizeof ( mCounts ) );
+}
+
+// the highest value of a bucket is one below the lowest value of the next one
+int64_t HPSleepHistogram::BucketEdge ( const uint32_t Bucket )
+{
+    if ( Bucket < SubBuckets )
+    {
+        return Bucket;
+    }
+    uint32_t Msb ( Bucket / SubBuckets + 2 );
+    uint64_t Next ( static_cast<uint64_t> ( SubBuckets + 1 + Bucket % SubBuckets ) << ( Msb - 3 ) );
+    return Next > static_cast<uint64_t> ( INT64_MAX ) ? INT64_MAX : static_cast<int64_t> ( Next - 1 );
+}
+
+double HPSleepHistogram::Mean() const
+{
+    return mCount ? static_cast<double> ( mSum ) / mCount : 0.0;
+}
+
+int64_t HPSleepHistogram::Percentile ( const double Quantile ) const
+{
+    if ( 0 == mCount )
+    {
+        return 0;
+    }
+    uint64_t Rank ( static_cast<uint64_t> ( Quantile * mCount ) );
+    Rank = std::max<uint64_t> ( 1, std::min ( Rank, mCount ) );
+    uint64_t Sum ( 0 );
+    for ( uint32_t i = 0; i < Buckets; ++i )
+    {
+        Sum += mCounts[i];
+        if ( Sum >= Rank )
+        {
+            return std::min ( BucketEdge ( i ), mMax );
+        }
+    }
+    return mMax;
+}
+
+HPSleepHistogram & HPSleepHistogram::operator+= ( const HPSleepHistogram & Histogram )
+{
+    for ( uint32_t i = 0; i < Buckets; ++i )
+    {
+        mCounts[i] += Histogram.mCounts[i];
+    }
+    mCount += Histogram.mCount;
+    mSum += Histogram.mSum;
+    mMax = std::max ( mMax, Histogram.mMax );
+    return *this;
+}
+
+// histogram, which is written by its thread only. So the counters are incremented by a plain load and store
+// without a locked instruction, the atomics just make the concurrent snapshot well-defined
+struct ThreadHistogram
+{
+    std::atomic<uint64_t> mCounts[HPSleepHistogram::Buckets];
+    std::atomic<uint64_t> mCount;
+    std::atomic<int64_t> mSum;
+    std::atomic<int64_t> mMax;
+
+    ThreadHistogram()
+    {
+        Clear();
+    }
+
+    void Add ( const int64_t Value )
+    {
+        std::atomic<uint64_t> & Counter ( mCounts[HPSleepHistogram::Bucket ( Value )] );
+        Counter.store ( Counter.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        mCount.store ( mCount.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        mSum.store ( mSum.load ( std::memory_order_relaxed ) + Value, std::memory_order_relaxed );
+        if ( Value > mMax.load ( std::memory_order_relaxed ) )
+        {
+            mMax.store ( Value, std::memory_order_relaxed );
+        }
+    }
+
+    void AddTo ( HPSleepHistogram & Histogram ) const
+    {
+        for ( uint32_t i = 0; i < HPSleepHistogram::Buckets; ++i )
+        {
+            Histogram.mCounts[i] += mCounts[i].load ( std::memory_order_relaxed );
+        }
+        Histogram.mCount += mCount.load ( std::memory_order_relaxed );
+        Histogram.mSum += mSum.load ( std::memory_order_relaxed );
+        Histogram.mMax = std::max ( Histogram.mMax, mMax.load ( std::memory_order_relaxed ) );
+    }
+
+    void Clear()
+    {
+        for ( uint32_t i = 0; i < HPSleepHistogram::Buckets; ++i )
+        {
+            mCounts[i].store ( 0, std::memory_order_relaxed );
+        }
+        mCount.store ( 0, std::memory_order_relaxed );
+        mSum.store ( 0, std::memory_order_relaxed );
+        mMax.store ( 0, std::memory_order_relaxed );
+    }
+};
+
+// statistics of one thread. A profile is taken over by a new thread after its thread has exited.
+// Its writer clears it, when it finds a new generation, and publishes the generation after the cleared counts
+struct ThreadProfile
+{
+    std::atomic<uint64_t> mGeneration;
+    std::atomic<uint64_t> mCalls;
+    std::atomic<uint64_t> mInterrupted;
+    ThreadHistogram mLateness;
+    ThreadHistogram mBlocked;
+    ThreadHistogram mSpinning;
+    bool mInUse;
+
+    ThreadProfile() :
+            mGeneration ( Generation.load ( std::memory_order_relaxed ) ),
+            mCalls ( 0 ),
+            mInterrupted ( 0 ),
+            mInUse ( true )
+    {
+    }
+
+    // a profile of a former generation counts as empty
+    void AddTo ( HPSleepStats & Stats ) const
+    {
+        if ( mGeneration.load ( std::memory_order_acquire ) != Generation.load ( std::memory_order_relaxed ) )
+        {
+            return;
+        }
+        Stats.Calls += mCalls.load ( std::memory_order_relaxed );
+        Stats.Interrupted += mInterrupted.load ( std::memory_order_relaxed );
+        mLateness.AddTo ( Stats.Lateness );
+        mBlocked.AddTo ( Stats.Blocked );
+        mSpinning.AddTo ( Stats.Spinning );
+    }
+
+    void Clear()
+    {
+        mCalls.store ( 0, std::memory_order_relaxed );
+        mInterrupted.store ( 0, std::memory_order_relaxed );
+        mLateness.Clear();
+        mBlocked.Clear();
+        mSpinning.Clear();
+    }
+};
+
+// all profiles ever created and the sums of the exited threads, protected by one mutex.
+// The lock is taken on the first recorded sleep of a thread, on its exit, by the snapshots and by the reset
+struct ProfileRegistry
+{
+    std::mutex mMutex;
+    std::vector<ThreadProfile *> mProfiles;
+    HPSleepStats mRetired;
+};
+
+static ProfileRegistry & Registry()
+{
+    // leaked on purpose: the ProfileOwner of a thread, which exits after main() has returned, still takes its mutex
+    static ProfileRegistry * Instance ( new ProfileRegistry );
+    return *Instance;
+}
+
+// releases the profile of the thread on its exit. The counts move to the sums of the exited threads
+struct ProfileOwner
+{
+    ThreadProfile * mProfile = nullptr;
+
+    ~ProfileOwner()
+    {
+        if ( !mProfile )
+        {
+            return;
+        }
+        ProfileRegistry & Reg ( Registry() );
+        std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+        mProfile->AddTo ( Reg.mRetired );
+        mProfile->Clear();
+        mProfile->mInUse = false;
+    }
+};
+
+static thread_local ProfileOwner Owner;
+
+static ThreadProfile & LocalProfile()
+{
+    if ( !Owner.mProfile )
+    {
+        ProfileRegistry & Reg ( Registry() );
+        std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+        for ( ThreadProfile * Profile : Reg.mProfiles )
+        {
+            if ( !Profile->mInUse )
+            {
+                Profile->mInUse = true;
+                Owner.mProfile = Profile;
+                break;
+            }
+        }
+        if ( !Owner.mProfile )
+        {
+            Owner.mProfile = new ThreadProfile;
+            Reg.mProfiles.push_back ( Owner.mProfile );
+        }
+    }
+    return *Owner.mProfile;
+}
+
+void HPSleepProfile::Enable ( const bool On )
+{
+    HPSleepProfile::Enabled.store ( On, std::memory_order_relaxed );
+}
+
+HPSleepStats HPSleepProfile::Snapshot()
+{
+    ProfileRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    HPSleepStats Stats ( Reg.mRetired );
+    for ( const ThreadProfile * Profile : Reg.mProfiles )
+    {
+        Profile->AddTo ( Stats );
+    }
+    return Stats;
+}
+
+HPSleepStats HPSleepProfile::ThreadSnapshot()
+{
+    HPSleepStats Stats;
+    if ( Owner.mProfile )
+    {
+        Owner.mProfile->AddTo ( Stats );
+    }
+    return Stats;
+}
+
+// the profiles are not touched here, their writers clear them
+void HPSleepProfile::Reset()
+{
+    ProfileRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    Reg.mRetired = HPSleepStats();
+    Generation.fetch_add ( 1, std::memory_order_release );
+}
+
+// the lateness of an interrupted sleep is meaningless, it is only counted
+void HPSleepProfile::Record ( const int64_t LateNSec, const int64_t BlockedNSec, const int64_t SpinNSec, const bool Interrupted )
+{
+    ThreadProfile & Profile ( LocalProfile() );
+    uint64_t Current ( Generation.load ( std::memory_order_acquire ) );
+    if ( Profile.mGeneration.load ( std::memory_order_relaxed ) != Current )
+    {
+        Profile.Clear();
+        Profile.mGeneration.store ( Current, std::memory_order_release );
+    }
+    Profile.mCalls.store ( Profile.mCalls.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    if ( Interrupted )
+    {
+        Profile.mInterrupted.store ( Profile.mInterrupted.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    }
+    else
+    {
+        Profile.mLateness.Add ( LateNSec );
+    }
+    Profile.mBlocked.Add ( BlockedNSec );
+    Profile.mSpinning.Add ( SpinNSec );
+}
+
+} // namespace HPTimer
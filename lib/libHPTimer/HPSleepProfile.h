@@ -0,0 +1,156 @@
+/*
+ * @file   HPSleepProfile.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Opt-in statistics of the sleeps: wakeup lateness, time blocked in the OS and time spent busy-waiting
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPSLEEPPROFILE_H
+#define _HPSLEEPPROFILE_H
+#include <stdint.h>
+#include <atomic>
+
+namespace HPTimer
+{
+
+//! Histogram of nanosecond values with logarithmic buckets
+/*!
+ * The values below 8 have a bucket each, every power of two above is split into 8 buckets,
+ * so a percentile is reported with an error of less than 12.5%, as by an HDR histogram with one significant digit.
+ */
+class HPSleepHistogram
+{
+public:
+    /// number of buckets within a power of two
+    static const uint32_t SubBuckets = 8;
+
+    /// number of buckets, covering all positive int64 values
+    static const uint32_t Buckets = 488;
+
+    /// standard ctor, empty histogram
+    HPSleepHistogram();
+
+    /// get the bucket of the value, negative values are counted in the first one
+    inline static uint32_t Bucket ( const int64_t Value )
+    {
+        if ( Value < static_cast<int64_t> ( SubBuckets ) )
+        {
+            return Value > 0 ? static_cast<uint32_t> ( Value ) : 0;
+        }
+        uint32_t Msb ( 63 - __builtin_clzll ( static_cast<uint64_t> ( Value ) ) );
+        return SubBuckets * ( Msb - 2 ) + static_cast<uint32_t> ( ( Value >> ( Msb - 3 ) ) & ( SubBuckets - 1 ) );
+    };
+
+    /// get the highest value, which is counted in the bucket
+    static int64_t BucketEdge ( const uint32_t Bucket );
+
+    /// number of values in the bucket
+    uint64_t mCounts[Buckets];
+
+    /// number of all values
+    uint64_t mCount;
+
+    /// sum of all values in nanoseconds
+    int64_t mSum;
+
+    /// largest value in nanoseconds
+    int64_t mMax;
+
+    /// get the mean value in nanoseconds, 0 for an empty histogram
+    double Mean() const;
+
+    /** get the percentile
+     * @param Quantile is the fraction of the values, which are not larger than the result, e.g. 0.99
+     * @return highest value of the bucket of the percentile in nanoseconds, but not larger than the maximum. 0 for an empty histogram
+     */
+    int64_t Percentile ( const double Quantile ) const;
+
+    /// add the counts of the other histogram
+    HPSleepHistogram & operator+= ( const HPSleepHistogram & Histogram );
+};
+
+/// statistics of the sleeps since the profiling was enabled or reset
+struct HPSleepStats
+{
+    /// number of sleeps
+    uint64_t Calls = 0;
+
+    /// number of sleeps, which were ended by an interrupt
+    uint64_t Interrupted = 0;
+
+    /// time after the requested wake time, at which the sleeps returned, only of the sleeps without interrupt
+    HPSleepHistogram Lateness;
+
+    /// time of each sleep, blocked in the futex wait of the OS
+    HPSleepHistogram Blocked;
+
+    /// time of each sleep, spent busy-waiting or in the system calls around the waits
+    HPSleepHistogram Spinning;
+};
+
+//! Opt-in profiler of the sleeps of HPSleeper, HighPerTimer and all users of them
+/*!
+ * When enabled, each sleep records its lateness, the time blocked in the OS and the time spinning.
+ * Each thread writes its own histograms without lock and without a shared cache line, the snapshot sums up
+ * the histograms of all threads, also of the ones which have exited. When disabled, a sleep only loads the flag.
+ * The snapshot is not atomic against running sleeps, the counts of a concurrent sleep may be missed.
+ * The reset only starts a new generation, each thread clears its own histograms at its next sleep, so a reset
+ * never races with the writer of a histogram and no count of the former generation survives it.
+ */
+class HPSleepProfile
+{
+    friend class HPSleeper;
+public:
+    /// exclude creating any instance of HPSleepProfile class
+    HPSleepProfile() = delete;
+
+    /// enable or disable the recording of the sleeps
+    static void Enable ( const bool On = true );
+
+    /// return true if the sleeps are recorded
+    inline static bool IsEnabled()
+    {
+        return HPSleepProfile::Enabled.load ( std::memory_order_relaxed );
+    };
+
+    /// get the statistics of all threads
+    static HPSleepStats Snapshot();
+
+    /// get the statistics of the calling thread
+    static HPSleepStats ThreadSnapshot();
+
+    /// clear the statistics of all threads. It may be called while other threads sleep, a sleep, which is running
+    /// during the reset, is counted in the former generation and so discarded
+    static void Reset();
+
+private:
+    /** record one sleep in the histograms of the calling thread
+     * @param LateNSec is the time after the requested wake time in nanoseconds
+     * @param BlockedNSec is the time in the OS wait in nanoseconds
+     * @param SpinNSec is the remaining time of the sleep in nanoseconds
+     * @param Interrupted is true if the sleep was ended by an interrupt
+     */
+    static void Record ( const int64_t LateNSec, const int64_t BlockedNSec, const int64_t SpinNSec, const bool Interrupted );
+
+    /// the sleeps are recorded
+    static std::atomic<bool> Enabled;
+};
+
+} // namespace HPTimer
+#endif // _HPSLEEPPROFILE_H
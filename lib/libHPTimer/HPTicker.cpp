@@ -0,0 +1,141 @@
+/*
+ * @file   HPTicker.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Periodic wakeups at a fixed rate without accumulating drift
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <cmath>
+#include "HPTicker.h"
+
+namespace HPTimer
+{
+
+// ctor
+// @exception std::out_of_range if the period is not positive
+HPTicker::HPTicker ( const HPDuration & Period, const bool CatchUp ) :
+        mNext ( 0 ),
+        mPeriod ( Period.HPTics() ),
+        mPeriodFrac ( 0 ),
+        mFrac ( 0 ),
+        mCatchUp ( CatchUp ),
+        mTicks ( 0 ),
+        mMissed ( 0 )
+{
+    if ( mPeriod <= 0 )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HPTicker" ) );
+    }
+    Reset();
+}
+
+// the period in tics is split into the whole tics and a 32 bit fraction
+// @exception std::out_of_range if the rate is not positive or too low for the HPTimer range
+HPTicker HPTicker::FromRate ( const double PerSecond, const bool CatchUp )
+{
+    if ( !( PerSecond > 0.0 ) )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HPTicker" ) );
+    }
+    long double PeriodTics ( 1e9L / ( static_cast<long double> ( PerSecond ) * HighPerTimer::GetNsecPerTic() ) );
+    if ( PeriodTics >= static_cast<long double> ( HighPerTimer::MaxHPTics() ) )
+    {
+        throw  std::out_of_range ( "HPTimer overflow" );
+    }
+    long double Whole ( floorl ( PeriodTics ) );
+    // a period below one tic is kept as one tic, the timer counter can not wake more often
+    if ( Whole < 1.0L )
+    {
+        return HPTicker ( HPDuration::FromTics ( 1 ), CatchUp );
+    }
+    HPTicker Ticker ( HPDuration::FromTics ( static_cast<int64_t> ( Whole ) ), CatchUp );
+    Ticker.mPeriodFrac = static_cast<uint32_t> ( std::min ( ldexpl ( PeriodTics - Whole, 32 ), 4294967295.0L ) );
+    return Ticker;
+}
+
+void HPTicker::Reset()
+{
+    Reset ( HPTimestamp::Now() + HPDuration::FromTics ( mPeriod ) );
+}
+
+void HPTicker::Reset ( const HPTimestamp & FirstDeadline )
+{
+    mNext = FirstDeadline.HPTics();
+    mFrac = 0;
+    mTicks = 0;
+    mMissed = 0;
+}
+
+// advance the deadline, the fractions of the tic are carried into the whole tics
+void HPTicker::Advance ( const uint64_t Periods )
+{
+    uint64_t Frac ( static_cast<uint64_t> ( mFrac ) + Periods * mPeriodFrac );
+    mNext += static_cast<int64_t> ( Periods ) * mPeriod + static_cast<int64_t> ( Frac >> 32 );
+    mFrac = static_cast<uint32_t> ( Frac );
+}
+
+// sleep to the absolute deadline. When the wake up came later than one period after the deadline,
+// the late periods are either skipped and counted as missed, or delivered by the following waits without sleeping
+int64_t HPTicker::Wait()
+{
+    int64_t Now ( HPTimestamp::Now().HPTics() );
+    if ( Now < mNext )
+    {
+        // short periods are spinning here directly, so the rate is not limited by the overhead of the sleep
+        if ( HighPerTimer::TictoNSec ( mNext - Now ) > HighPerTimer::GetBusyWaitNSec() )
+        {
+            mSleeper.SleepTo ( HPTimestamp::FromTics ( mNext ) );
+            Now = HPTimestamp::Now().HPTics();
+            if ( Now < mNext )
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            do
+            {
+                Now = HPTimestamp::Now().HPTics();
+            }
+            while ( Now < mNext );
+        }
+    }
+
+    uint64_t Missed ( static_cast<uint64_t> ( Now - mNext ) / static_cast<uint64_t> ( mPeriod ) );
+    // the fraction of the period may make it to count one period too many
+    if ( ( Missed > 0 ) && ( 0 != mPeriodFrac ) )
+    {
+        long double FullPeriod ( mPeriod + ldexpl ( mPeriodFrac, -32 ) );
+        Missed = static_cast<uint64_t> ( ( Now - mNext ) / FullPeriod );
+    }
+    if ( !mCatchUp )
+    {
+        mMissed += Missed;
+    }
+    ++mTicks;
+    Advance ( mCatchUp ? 1 : Missed + 1 );
+    return static_cast<int64_t> ( Missed );
+}
+
+void HPTicker::Interrupt()
+{
+    mSleeper.Interrupt();
+}
+
+} // namespace HPTimer
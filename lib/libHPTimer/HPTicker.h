@@ -0,0 +1,126 @@
+/*
+ * @file   HPTicker.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Periodic wakeups at a fixed rate without accumulating drift
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPTICKER_H
+#define _HPTICKER_H
+#include "HPTimestamp.h"
+
+namespace HPTimer
+{
+
+//! Ticker for fixed-rate loops
+/*!
+ * The ticker keeps the absolute deadline of the next tick and advances it by the period after every wait,
+ * so the overshoot of a wait is not added to the following periods. The period is kept with a 32 bit fraction
+ * of a tic, so also the rates, which are no integer number of tics, are hit exactly in the long run.
+ * Periods shorter than the busy-wait tail of the sleeps are only spinning, longer ones use the hybrid wait of HPSleeper.
+ */
+class HPTicker
+{
+public:
+    /** ctor
+     * @param Period is time between two ticks, must be positive
+     * @param CatchUp tells, if the missed ticks should be delivered immediately one by one. Otherwise they are skipped
+     * and the next deadline is the first one in the future
+     * @exception std::out_of_range if the period is not positive
+     */
+    explicit HPTicker ( const HPDuration & Period, const bool CatchUp = false );
+
+    /** create the ticker for a rate
+     * @param PerSecond is the number of ticks per second, must be positive
+     * @param CatchUp tells, if the missed ticks should be delivered immediately one by one
+     * @exception std::out_of_range if the rate is not positive or too low for the HPTimer range
+     */
+    static HPTicker FromRate ( const double PerSecond, const bool CatchUp = false );
+
+    /** wait for the next tick and advance the deadline
+     * @return number of whole periods this tick is late, or -1 if the wait was interrupted.
+     * Without CatchUp these periods are skipped, with CatchUp they are delivered by the following waits without sleeping.
+     * The deadline is not advanced by an interrupted wait
+     */
+    int64_t Wait();
+
+    /// restart the ticker: the next deadline is one period after now, the counters are reset
+    void Reset();
+
+    /// restart the ticker with the first deadline at the given time, the counters are reset
+    void Reset ( const HPTimestamp & FirstDeadline );
+
+    /// interrupt the wait. Can only be called from a different thread, accessing the same object.
+    void Interrupt();
+
+    /// get the time of the next tick
+    inline HPTimestamp NextDeadline() const
+    {
+        return HPTimestamp::FromTics ( mNext );
+    };
+
+    /// get the period in whole tics
+    inline HPDuration Period() const
+    {
+        return HPDuration::FromTics ( mPeriod );
+    };
+
+    /// get the number of ticks, which were delivered after a wait
+    inline uint64_t Ticks() const
+    {
+        return mTicks;
+    };
+
+    /// get the number of periods, which were skipped since the start. Always zero with CatchUp
+    inline uint64_t Missed() const
+    {
+        return mMissed;
+    };
+
+private:
+    /// advance the deadline by the given number of periods
+    void Advance ( const uint64_t Periods );
+
+    /// deadline of the next tick, shifted to unix zero
+    int64_t mNext;
+
+    /// whole tics of the period
+    int64_t mPeriod;
+
+    /// fraction of the tic of the period, in units of 2^-32 tic
+    uint32_t mPeriodFrac;
+
+    /// accumulated fraction of the tic of the deadline
+    uint32_t mFrac;
+
+    /// deliver missed ticks one by one
+    bool mCatchUp;
+
+    /// number of delivered ticks
+    uint64_t mTicks;
+
+    /// number of missed periods
+    uint64_t mMissed;
+
+    /// sleeper for the hybrid wait
+    HPSleeper mSleeper;
+};
+
+} // namespace HPTimer
+#endif // _HPTICKER_H
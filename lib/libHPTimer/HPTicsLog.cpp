@@ -0,0 +1,405 @@
+/*
+ * @file   HPTicsLog.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Memory-mapped binary log of tics with the calibration in its header, writer and reader
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "HPTicsLog.h"
+
+// C++ macro for one billion ( 10^9 )
+constexpr int64_t ONE_BILLION = 1000000000LL;
+
+static const char LogMagic[8] = { 'H', 'P', 'T', 'I', 'C', 'L', 'O', 'G' };
+
+// "HPTS" in the byte order of the file
+constexpr uint32_t SegmentMagic = 0x53545048;
+
+// the number is increased whenever the layout changes
+constexpr uint32_t LogVersion = 1;
+
+// the mBytes of a segment header limits the segment size
+constexpr uint64_t MaxSegmentBytes = 1ULL << 32;
+
+namespace HPTimer
+{
+
+// the page size at least, so the offsets of the segments are valid for mmap
+static uint64_t HeaderBytes()
+{
+    long Page ( sysconf ( _SC_PAGESIZE ) );
+    uint64_t Bytes ( Page > 0 ? static_cast<uint64_t> ( Page ) : 4096 );
+    while ( Bytes < sizeof ( HPTicsLogHeader ) )
+    {
+        Bytes *= 2;
+    }
+    return Bytes;
+}
+
+// the sizes of the header are checked as the writer chooses them: the header is a power of two like the page size of the
+// writer and the segments are multiples of it. All segments but the last one, which is cut behind its last record,
+// have to be within the file
+static bool ValidLayout ( const HPTicsLogHeader & Header, const uint64_t FileBytes )
+{
+    uint64_t HeaderSize ( Header.mHeaderBytes );
+    uint64_t SegmentSize ( Header.mSegmentBytes );
+    if ( ( HeaderSize < sizeof ( HPTicsLogHeader ) ) || ( 0 != ( HeaderSize & ( HeaderSize - 1 ) ) ) || ( HeaderSize > FileBytes ) ||
+         ( SegmentSize <= sizeof ( HPTicsLogSegment ) ) || ( 0 != SegmentSize % HeaderSize ) || ( SegmentSize > MaxSegmentBytes + HeaderSize ) )
+    {
+        return false;
+    }
+    return ( 0 == Header.mSegments ) || ( Header.mSegments - 1 <= ( FileBytes - HeaderSize ) / SegmentSize );
+}
+
+HPTicsLogWriter::HPTicsLogWriter() :
+        mFd ( -1 ),
+        mHeader ( NULL ),
+        mSegment ( NULL ),
+        mData ( NULL ),
+        mPos ( NULL ),
+        mEnd ( NULL ),
+        mLast ( 0 ),
+        mCount ( 0 )
+{
+}
+
+HPTicsLogWriter::~HPTicsLogWriter()
+{
+    Close();
+}
+
+// @exception std::out_of_range if SegmentBytes is zero or too large
+bool HPTicsLogWriter::Open ( const std::string & Path, const size_t SegmentBytes, const bool Shifted )
+{
+    if ( ( 0 == SegmentBytes ) || ( SegmentBytes > MaxSegmentBytes ) )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HPTicsLogWriter" ) );
+    }
+    Close();
+    uint64_t Header ( HeaderBytes() );
+    uint64_t Segment ( ( SegmentBytes + Header - 1 ) / Header * Header );
+
+    // the calibration is written after the initialization of the timer
+    HighPerTimer::Now();
+    mFd = open ( Path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if ( mFd < 0 )
+    {
+        return false;
+    }
+    void * Map ( MAP_FAILED );
+    if ( 0 == ftruncate ( mFd, Header ) )
+    {
+        Map = mmap ( NULL, Header, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0 );
+    }
+    if ( MAP_FAILED == Map )
+    {
+        close ( mFd );
+        mFd = -1;
+        return false;
+    }
+    mHeader = static_cast<HPTicsLogHeader *> ( Map );
+    memset ( mHeader, 0, sizeof ( HPTicsLogHeader ) );
+    memcpy ( mHeader->mMagic, LogMagic, sizeof ( LogMagic ) );
+    mHeader->mVersion = LogVersion;
+    mHeader->mShifted = Shifted ? 1 : 0;
+    mHeader->mHeaderBytes = Header;
+    mHeader->mSegmentBytes = Segment;
+    mHeader->mTicsPerUsec = HighPerTimer::GetHPFrequency();
+    mHeader->mNsecPerTic = HighPerTimer::GetNsecPerTic();
+    HighPerTimer::LoadPair ( HighPerTimer::NSecMult, HighPerTimer::NSecShift, mHeader->mNSecMult, mHeader->mNSecShift );
+    mHeader->mSource = static_cast<uint32_t> ( HighPerTimer::GetHPSource() );
+    mHeader->mUnixZeroShift = HighPerTimer::GetUnixZeroShift();
+    timespec ts;
+    clock_gettime ( CLOCK_REALTIME, &ts );
+    mHeader->mCreatedNSec = static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + ts.tv_nsec;
+    strncpy ( mHeader->mBrand, AccessTimeHardware::GetBrandString().c_str(), sizeof ( mHeader->mBrand ) - 1 );
+    mCount = 0;
+    return true;
+}
+
+// the file ends behind the last record. A segment, which could not be mapped, is cut off
+void HPTicsLogWriter::Close()
+{
+    if ( !IsOpen() )
+    {
+        return;
+    }
+    uint64_t End ( mHeader->mHeaderBytes + mHeader->mSegments * mHeader->mSegmentBytes );
+    if ( NULL != mSegment )
+    {
+        End = mHeader->mHeaderBytes + ( mHeader->mSegments - 1 ) * mHeader->mSegmentBytes + sizeof ( HPTicsLogSegment ) + mSegment->mBytes;
+        munmap ( mSegment, mHeader->mSegmentBytes );
+    }
+    mHeader->mCount = mCount;
+    uint64_t Header ( mHeader->mHeaderBytes );
+    munmap ( mHeader, Header );
+    // on a failure the file keeps the zeros behind the last record, which the reader skips by the counts of the segments
+    int Result ( ftruncate ( mFd, End ) );
+    ( void ) Result;
+    close ( mFd );
+    mFd = -1;
+    mHeader = NULL;
+    mSegment = NULL;
+    mData = mPos = mEnd = NULL;
+}
+
+void HPTicsLogWriter::Flush()
+{
+    if ( !IsOpen() )
+    {
+        return;
+    }
+    msync ( mHeader, mHeader->mHeaderBytes, MS_SYNC );
+    if ( NULL != mSegment )
+    {
+        msync ( mSegment, mHeader->mSegmentBytes, MS_SYNC );
+    }
+}
+
+// the file is extended before the segment is mapped, so the pages of the mapping are always backed by the file
+bool HPTicsLogWriter::NextSegment ( const int64_t Tics )
+{
+    if ( !IsOpen() )
+    {
+        return false;
+    }
+    uint64_t Bytes ( mHeader->mSegmentBytes );
+    if ( NULL != mSegment )
+    {
+        munmap ( mSegment, Bytes );
+        mSegment = NULL;
+        mData = mPos = mEnd = NULL;
+    }
+    uint64_t Offset ( mHeader->mHeaderBytes + mHeader->mSegments * Bytes );
+    if ( 0 != ftruncate ( mFd, Offset + Bytes ) )
+    {
+        return false;
+    }
+    void * Map ( mmap ( NULL, Bytes, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, Offset ) );
+    if ( MAP_FAILED == Map )
+    {
+        return false;
+    }
+    mSegment = static_cast<HPTicsLogSegment *> ( Map );
+    mSegment->mMagic = SegmentMagic;
+    mSegment->mBytes = 0;
+    mSegment->mCount = 0;
+    mSegment->mFirst = Tics;
+    mSegment->mLast = Tics;
+    mData = reinterpret_cast<uint8_t *> ( mSegment + 1 );
+    mPos = mData;
+    mEnd = static_cast<uint8_t *> ( Map ) + Bytes;
+    mLast = Tics;
+    mHeader->mSegments += 1;
+    return true;
+}
+
+HPTicsLogReader::HPTicsLogReader() :
+        mFile ( NULL ),
+        mFileBytes ( 0 ),
+        mHeader ( NULL ),
+        mSegment ( 0 ),
+        mPos ( NULL ),
+        mEnd ( NULL ),
+        mLeft ( 0 ),
+        mLast ( 0 )
+{
+}
+
+HPTicsLogReader::~HPTicsLogReader()
+{
+    Close();
+}
+
+bool HPTicsLogReader::Open ( const std::string & Path )
+{
+    Close();
+    int Fd ( open ( Path.c_str(), O_RDONLY ) );
+    if ( Fd < 0 )
+    {
+        return false;
+    }
+    struct stat Stat;
+    void * Map ( MAP_FAILED );
+    if ( ( 0 == fstat ( Fd, &Stat ) ) && ( Stat.st_size >= static_cast<off_t> ( sizeof ( HPTicsLogHeader ) ) ) )
+    {
+        Map = mmap ( NULL, Stat.st_size, PROT_READ, MAP_SHARED, Fd, 0 );
+    }
+    // the mapping stays valid after the descriptor is closed
+    close ( Fd );
+    if ( MAP_FAILED == Map )
+    {
+        return false;
+    }
+    mFile = static_cast<const uint8_t *> ( Map );
+    mFileBytes = Stat.st_size;
+    const HPTicsLogHeader * Header ( reinterpret_cast<const HPTicsLogHeader *> ( mFile ) );
+    if ( ( 0 != memcmp ( Header->mMagic, LogMagic, sizeof ( LogMagic ) ) ) || ( LogVersion != Header->mVersion ) ||
+         !ValidLayout ( *Header, mFileBytes ) )
+    {
+        munmap ( const_cast<uint8_t *> ( mFile ), mFileBytes );
+        mFile = NULL;
+        return false;
+    }
+    mHeader = Header;
+    Rewind();
+    return true;
+}
+
+void HPTicsLogReader::Close()
+{
+    if ( NULL != mFile )
+    {
+        munmap ( const_cast<uint8_t *> ( mFile ), mFileBytes );
+    }
+    mFile = NULL;
+    mFileBytes = 0;
+    mHeader = NULL;
+    mPos = mEnd = NULL;
+    mLeft = 0;
+}
+
+// the counts of the segments are summed, so the log of a writer, which did not close the file, is counted as well
+uint64_t HPTicsLogReader::GetCount() const
+{
+    if ( !IsOpen() )
+    {
+        return 0;
+    }
+    uint64_t Count ( 0 );
+    for ( uint64_t i = 0; i < mHeader->mSegments; ++i )
+    {
+        // a writer, which still adds segments, may count more of them than were mapped by Open()
+        if ( i > ( mFileBytes - mHeader->mHeaderBytes ) / mHeader->mSegmentBytes )
+        {
+            break;
+        }
+        uint64_t Offset ( mHeader->mHeaderBytes + i * mHeader->mSegmentBytes );
+        if ( sizeof ( HPTicsLogSegment ) > mFileBytes - Offset )
+        {
+            break;
+        }
+        Count += reinterpret_cast<const HPTicsLogSegment *> ( mFile + Offset )->mCount;
+    }
+    return Count;
+}
+
+void HPTicsLogReader::Rewind()
+{
+    mSegment = 0;
+    mPos = mEnd = NULL;
+    mLeft = 0;
+}
+
+// a segment, which is cut off or damaged, ends the log
+bool HPTicsLogReader::EnterSegment ( const uint64_t Index )
+{
+    // a writer, which still adds segments, may count more of them than were mapped by Open()
+    if ( ( Index >= mHeader->mSegments ) || ( Index > ( mFileBytes - mHeader->mHeaderBytes ) / mHeader->mSegmentBytes ) )
+    {
+        return false;
+    }
+    uint64_t Offset ( mHeader->mHeaderBytes + Index * mHeader->mSegmentBytes );
+    if ( sizeof ( HPTicsLogSegment ) > mFileBytes - Offset )
+    {
+        return false;
+    }
+    const HPTicsLogSegment * Segment ( reinterpret_cast<const HPTicsLogSegment *> ( mFile + Offset ) );
+    if ( ( SegmentMagic != Segment->mMagic ) || ( Segment->mBytes > mFileBytes - Offset - sizeof ( HPTicsLogSegment ) ) )
+    {
+        return false;
+    }
+    mPos = reinterpret_cast<const uint8_t *> ( Segment + 1 );
+    mEnd = mPos + Segment->mBytes;
+    mLeft = Segment->mCount;
+    mLast = Segment->mFirst;
+    return true;
+}
+
+size_t HPTicsLogReader::Read ( int64_t * Tics, const size_t Count )
+{
+    if ( !IsOpen() )
+    {
+        return 0;
+    }
+    size_t Done ( 0 );
+    while ( Done < Count )
+    {
+        if ( 0 == mLeft )
+        {
+            if ( !EnterSegment ( mSegment ) )
+            {
+                break;
+            }
+            ++mSegment;
+            continue;
+        }
+        uint64_t Zigzag ( 0 );
+        uint32_t Shift ( 0 );
+        bool Complete ( false );
+        while ( ( mPos < mEnd ) && ( Shift < 64 ) )
+        {
+            uint8_t Byte ( *mPos++ );
+            Zigzag |= static_cast<uint64_t> ( Byte & 0x7F ) << Shift;
+            Shift += 7;
+            if ( 0 == ( Byte & 0x80 ) )
+            {
+                Complete = true;
+                break;
+            }
+        }
+        if ( !Complete )
+        {
+            // damaged record: the rest of the segment is skipped
+            mLeft = 0;
+            continue;
+        }
+        uint64_t Delta ( ( Zigzag >> 1 ) ^ ( 0 - ( Zigzag & 1 ) ) );
+        mLast = static_cast<int64_t> ( static_cast<uint64_t> ( mLast ) + Delta );
+        Tics[Done++] = mLast;
+        --mLeft;
+    }
+    return Done;
+}
+
+// raw counter values get the shift of the writer, then all values are converted by its fixed-point pair
+size_t HPTicsLogReader::ReadNSec ( int64_t * NSeconds, const size_t Count )
+{
+    size_t Done ( Read ( NSeconds, Count ) );
+    if ( 0 == Done )
+    {
+        return 0;
+    }
+    if ( !mHeader->mShifted )
+    {
+        for ( size_t i = 0; i < Done; ++i )
+        {
+            NSeconds[i] += mHeader->mUnixZeroShift;
+        }
+    }
+    HighPerTimer::FixedPointMul ( NSeconds, NSeconds, Done, mHeader->mNSecMult, mHeader->mNSecShift );
+    return Done;
+}
+
+} // namespace HPTimer
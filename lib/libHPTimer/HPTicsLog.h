@@ -0,0 +1,293 @@
+/*
+ * @file   HPTicsLog.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Memory-mapped binary log of tics with the calibration in its header, writer and reader
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPTICSLOG_H
+#define _HPTICSLOG_H
+#include <stdint.h>
+#include <string>
+#include "HighPerTimer.h"
+
+namespace HPTimer
+{
+
+/// header at the begin of the log file, one page long, so the segments start page aligned
+struct HPTicsLogHeader
+{
+    /// "HPTICLOG"
+    char mMagic[8];
+
+    /// version of the format
+    uint32_t mVersion;
+
+    /// the values include the UnixZeroShift, otherwise they are raw counter values
+    uint32_t mShifted;
+
+    /// size of the header in bytes, the first segment starts there
+    uint64_t mHeaderBytes;
+
+    /// size of each segment in bytes, only the last one may be shorter
+    uint64_t mSegmentBytes;
+
+    /// number of segments
+    uint64_t mSegments;
+
+    /// number of records of all segments, written on Close()
+    uint64_t mCount;
+
+    /// calibration of the writing process, see HighPerTimer::GetHPFrequency()
+    int64_t mTicsPerUsec;
+
+    /// calibration of the writing process, see HighPerTimer::GetNsecPerTic()
+    double mNsecPerTic;
+
+    /// fixed-point pair of the conversion to nanoseconds: NSeconds = ( Tics * mNSecMult ) >> mNSecShift
+    uint64_t mNSecMult;
+    uint32_t mNSecShift;
+
+    /// the time source of the writing process, a value of TimeSource
+    uint32_t mSource;
+
+    /// shift of the counter values to the begin of unix era in tics
+    int64_t mUnixZeroShift;
+
+    /// wall clock at the creation of the file in nanoseconds since the begin of unix era
+    int64_t mCreatedNSec;
+
+    /// CPU brand string of the writing host
+    char mBrand[48];
+};
+
+/// header at the begin of each segment. The segments are independent: the first record is the delta to mFirst
+struct HPTicsLogSegment
+{
+    /// "HPTS"
+    uint32_t mMagic;
+
+    /// bytes of records after this header
+    uint32_t mBytes;
+
+    /// number of records
+    uint64_t mCount;
+
+    /// value, against which the first record is encoded
+    int64_t mFirst;
+
+    /// value of the last record
+    int64_t mLast;
+};
+
+//! Writer of the log, appending records into the mapped segments without a system call
+/*!
+ * Each record is the difference to the value before, zigzag and varint encoded, so increasing raw tics of a
+ * high rate take two or three bytes. The writer maps one segment at a time, a system call is only made
+ * when the segment is full and the file is extended by the next one. The counts in the headers are updated
+ * with each record, so the file of a crashed writer is readable up to the last record.
+ * One writer shall be used by one thread only.
+ */
+class HPTicsLogWriter
+{
+public:
+    /// most bytes of one record
+    static const size_t MaxRecordBytes = 10;
+
+    /// standard ctor, not opened
+    HPTicsLogWriter();
+
+    /// close the file
+    ~HPTicsLogWriter();
+
+    HPTicsLogWriter ( const HPTicsLogWriter & ) = delete;
+    HPTicsLogWriter & operator= ( const HPTicsLogWriter & ) = delete;
+
+    /** create the file and write the calibration of HighPerTimer into its header
+     * @param Path is the name of the file, an existing file is truncated
+     * @param SegmentBytes is the size of a segment, rounded up to a multiple of the page size
+     * @param Shifted tells, that the values will include the UnixZeroShift, e.g. HPTimestamp::HPTics(),
+     *        otherwise they are raw counter values of the current time source, e.g. from StartStamp()
+     * @return false if the file could not be created or mapped
+     * @exception std::out_of_range if SegmentBytes is zero or too large
+     */
+    bool Open ( const std::string & Path, const size_t SegmentBytes = 1 << 24, const bool Shifted = false );
+
+    /// unmap the segment and truncate the file behind the last record
+    void Close();
+
+    /// return true if the file is open
+    inline bool IsOpen() const
+    {
+        return mFd >= 0;
+    };
+
+    /** append a record
+     * @param Tics is the value to append
+     * @return false if the file is not open or could not be extended
+     */
+    inline bool Append ( const int64_t Tics )
+    {
+        if ( ( static_cast<size_t> ( mEnd - mPos ) < MaxRecordBytes ) && !NextSegment ( Tics ) )
+        {
+            return false;
+        }
+        // the difference is taken modulo 2^64, so any pair of values is encoded
+        uint64_t Delta ( static_cast<uint64_t> ( Tics ) - static_cast<uint64_t> ( mLast ) );
+        uint64_t Zigzag ( ( Delta << 1 ) ^ static_cast<uint64_t> ( static_cast<int64_t> ( Delta ) >> 63 ) );
+        while ( Zigzag >= 0x80 )
+        {
+            *mPos++ = static_cast<uint8_t> ( Zigzag | 0x80 );
+            Zigzag >>= 7;
+        }
+        *mPos++ = static_cast<uint8_t> ( Zigzag );
+        mLast = Tics;
+        mSegment->mBytes = static_cast<uint32_t> ( mPos - mData );
+        mSegment->mCount += 1;
+        mSegment->mLast = Tics;
+        ++mCount;
+        return true;
+    };
+
+    /// get the number of appended records
+    inline uint64_t GetCount() const
+    {
+        return mCount;
+    };
+
+    /// write the mapped pages to the file, e.g. before the file is read by another process
+    void Flush();
+
+private:
+    /// unmap the full segment and map the next one, whose first value is Tics
+    bool NextSegment ( const int64_t Tics );
+
+    /// descriptor of the file, -1 if not open
+    int mFd;
+
+    /// mapped header of the file
+    HPTicsLogHeader * mHeader;
+
+    /// mapped current segment
+    HPTicsLogSegment * mSegment;
+
+    /// begin of the records of the current segment
+    uint8_t * mData;
+
+    /// next byte to write
+    uint8_t * mPos;
+
+    /// end of the current segment
+    uint8_t * mEnd;
+
+    /// value of the last record
+    int64_t mLast;
+
+    /// number of records
+    uint64_t mCount;
+};
+
+//! Reader of the log, decoding the records of the mapped file
+/*!
+ * The values are converted to nanoseconds with the calibration of the header, not with the one of the
+ * reading process, by the batch conversion of HighPerTimer.
+ */
+class HPTicsLogReader
+{
+public:
+    /// standard ctor, not opened
+    HPTicsLogReader();
+
+    /// close the file
+    ~HPTicsLogReader();
+
+    HPTicsLogReader ( const HPTicsLogReader & ) = delete;
+    HPTicsLogReader & operator= ( const HPTicsLogReader & ) = delete;
+
+    /** map the file and check its header
+     * @param Path is the name of the file
+     * @return false if the file could not be mapped or is not a log of this version
+     */
+    bool Open ( const std::string & Path );
+
+    /// unmap the file
+    void Close();
+
+    /// return true if the file is open
+    inline bool IsOpen() const
+    {
+        return NULL != mHeader;
+    };
+
+    /// get the header with the calibration of the writer, only valid if the file is open
+    inline const HPTicsLogHeader & GetHeader() const
+    {
+        return *mHeader;
+    };
+
+    /// get the number of records in all segments
+    uint64_t GetCount() const;
+
+    /// continue with the first record
+    void Rewind();
+
+    /** decode the next records
+     * @param Tics points to the storage for Count values
+     * @param Count is the number of requested values
+     * @return number of decoded values, 0 at the end of the log
+     */
+    size_t Read ( int64_t * Tics, const size_t Count );
+
+    /** decode the next records and convert them to nanoseconds since the begin of unix era
+     * with the calibration of the writer
+     * @param NSeconds points to the storage for Count values
+     * @param Count is the number of requested values
+     * @return number of decoded values, 0 at the end of the log
+     */
+    size_t ReadNSec ( int64_t * NSeconds, const size_t Count );
+
+private:
+    /// map the segment with the given index, false if there is none
+    bool EnterSegment ( const uint64_t Index );
+
+    /// mapped file
+    const uint8_t * mFile;
+
+    /// size of the mapped file
+    size_t mFileBytes;
+
+    /// header of the file, NULL if not open
+    const HPTicsLogHeader * mHeader;
+
+    /// index of the current segment
+    uint64_t mSegment;
+
+    /// next byte to decode and end of the records of the current segment
+    const uint8_t * mPos;
+    const uint8_t * mEnd;
+
+    /// records left in the current segment
+    uint64_t mLeft;
+
+    /// value of the last decoded record
+    int64_t mLast;
+};
+
+} // namespace HPTimer
+#endif // _HPTICSLOG_H
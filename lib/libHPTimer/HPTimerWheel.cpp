@@ -0,0 +1,371 @@
+/*
+ * @file   HPTimerWheel.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Hierarchical timer wheel, firing callbacks at HighPerTimer deadlines from one driver thread
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <algorithm>
+#include "HPTimerWheel.h"
+
+// number of bits of the slot index of one level
+constexpr uint32_t SlotBits = 8;
+
+// mask of the slot index of one level
+constexpr int64_t SlotMask = ( 1LL << SlotBits ) - 1;
+
+namespace HPTimer
+{
+
+static_assert ( HPTimerWheel::WheelSlots == ( 1U << SlotBits ), "slots of a level must match the slot bits" );
+
+const HPTimerWheel::TimerId HPTimerWheel::InvalidTimer;
+const uint32_t HPTimerWheel::WheelSlots;
+const uint32_t HPTimerWheel::WheelLevels;
+const uint32_t HPTimerWheel::NilNode;
+
+// unit of the wheel of the given tics, rounded down also for negative tics
+static inline int64_t TicstoUnit ( const int64_t Tics, const int64_t Resolution )
+{
+    int64_t Unit ( Tics / Resolution );
+    if ( ( Tics % Resolution ) < 0 )
+    {
+        --Unit;
+    }
+    return Unit;
+}
+
+// ctor
+// @exception std::out_of_range if the resolution is not positive
+HPTimerWheel::HPTimerWheel ( const HPDuration & Resolution ) :
+        mResolution ( Resolution.HPTics() ),
+        mCurrent ( 0 ),
+        mSlots ( WheelLevels * WheelSlots, NilNode ),
+        mFree ( NilNode ),
+        mCount ( 0 ),
+        mPlannedWake ( INT64_MAX ),
+        mStop ( false )
+{
+    if ( mResolution <= 0 )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HPTimerWheel" ) );
+    }
+    std::fill ( mLevelCount, mLevelCount + WheelLevels, 0 );
+    mCurrent = TicstoUnit ( HPTimestamp::Now().HPTics(), mResolution );
+}
+
+HPTimerWheel::~HPTimerWheel()
+{
+    Stop();
+}
+
+HPTimerWheel::TimerId HPTimerWheel::Schedule ( const HighPerTimer & Deadline, Callback Func )
+{
+    return Add ( Deadline.HPTics(), std::move ( Func ) );
+}
+
+HPTimerWheel::TimerId HPTimerWheel::Schedule ( const HPTimestamp & Deadline, Callback Func )
+{
+    return Add ( Deadline.HPTics(), std::move ( Func ) );
+}
+
+HPTimerWheel::TimerId HPTimerWheel::ScheduleAfter ( const HPDuration & Delay, Callback Func )
+{
+    return Add ( ( HPTimestamp::Now() + Delay ).HPTics(), std::move ( Func ) );
+}
+
+// take a node from the free list, link it into the wheel and interrupt the driver,
+// if it sleeps to a later time than the new deadline
+HPTimerWheel::TimerId HPTimerWheel::Add ( const int64_t Deadline, Callback && Func )
+{
+    std::lock_guard<std::mutex> Lock ( mMutex );
+    uint32_t Index ( mFree );
+    if ( NilNode == Index )
+    {
+        Index = static_cast<uint32_t> ( mNodes.size() );
+        mNodes.push_back ( Node() );
+        mNodes[Index].mGeneration = 1;
+    }
+    else
+    {
+        mFree = mNodes[Index].mNext;
+    }
+    Node & Timer ( mNodes[Index] );
+    Timer.mDeadline = Deadline;
+    Timer.mFunc = std::move ( Func );
+    Timer.mPending = true;
+    Insert ( Index );
+    ++mCount;
+
+    if ( Deadline < mPlannedWake )
+    {
+        mPlannedWake = Deadline;
+        mSleeper.Interrupt();
+    }
+    return ( static_cast<TimerId> ( Timer.mGeneration ) << 32 ) | Index;
+}
+
+// cancel a pending timer. The generation of the node tells, if the identifier still belongs to it
+bool HPTimerWheel::Cancel ( const TimerId Id )
+{
+    std::lock_guard<std::mutex> Lock ( mMutex );
+    uint32_t Index ( static_cast<uint32_t> ( Id ) );
+    uint32_t Generation ( static_cast<uint32_t> ( Id >> 32 ) );
+    if ( ( Index >= mNodes.size() ) || ( !mNodes[Index].mPending ) || ( mNodes[Index].mGeneration != Generation ) )
+    {
+        return false;
+    }
+    Unlink ( Index );
+    Node & Timer ( mNodes[Index] );
+    Timer.mPending = false;
+    Timer.mFunc = nullptr;
+    // the generation 0 is skipped, so no identifier equals InvalidTimer
+    Timer.mGeneration = ( UINT32_MAX == Timer.mGeneration ) ? 1 : Timer.mGeneration + 1;
+    Timer.mNext = mFree;
+    mFree = Index;
+    --mCount;
+    return true;
+}
+
+size_t HPTimerWheel::Size() const
+{
+    std::lock_guard<std::mutex> Lock ( mMutex );
+    return mCount;
+}
+
+void HPTimerWheel::Start()
+{
+    std::lock_guard<std::mutex> Lock ( mMutex );
+    if ( mDriver.joinable() )
+    {
+        return;
+    }
+    mStop = false;
+    mDriver = std::thread ( &HPTimerWheel::Run, this );
+}
+
+void HPTimerWheel::Stop()
+{
+    {
+        std::lock_guard<std::mutex> Lock ( mMutex );
+        if ( !mDriver.joinable() )
+        {
+            return;
+        }
+        mStop = true;
+        mSleeper.Interrupt();
+    }
+    mDriver.join();
+}
+
+// link the node into the slot of the lowest level, which covers its deadline.
+// A deadline on a level above the lowest one is at least one slot of that level ahead,
+// so the first cascade of its slot comes at the begin of the slot
+void HPTimerWheel::Insert ( const uint32_t Index )
+{
+    Node & Timer ( mNodes[Index] );
+    int64_t Unit ( std::max ( TicstoUnit ( Timer.mDeadline, mResolution ), mCurrent ) );
+    int64_t Delta ( Unit - mCurrent );
+
+    uint32_t Level ( 0 );
+    while ( ( Level < WheelLevels ) && ( Delta >= ( 1LL << ( SlotBits * ( Level + 1 ) ) ) ) )
+    {
+        ++Level;
+    }
+    // beyond the horizon the timer is put to the farthest slot and cascaded again from there
+    if ( WheelLevels == Level )
+    {
+        Level = WheelLevels - 1;
+        Unit = mCurrent + ( 1LL << ( SlotBits * WheelLevels ) ) - 1;
+    }
+
+    uint32_t Slot ( Level * WheelSlots + static_cast<uint32_t> ( ( Unit >> ( SlotBits * Level ) ) & SlotMask ) );
+    Timer.mSlot = Slot;
+    Timer.mPrev = NilNode;
+    Timer.mNext = mSlots[Slot];
+    if ( NilNode != Timer.mNext )
+    {
+        mNodes[Timer.mNext].mPrev = Index;
+    }
+    mSlots[Slot] = Index;
+    ++mLevelCount[Level];
+}
+
+void HPTimerWheel::Unlink ( const uint32_t Index )
+{
+    Node & Timer ( mNodes[Index] );
+    if ( NilNode != Timer.mPrev )
+    {
+        mNodes[Timer.mPrev].mNext = Timer.mNext;
+    }
+    else
+    {
+        mSlots[Timer.mSlot] = Timer.mNext;
+    }
+    if ( NilNode != Timer.mNext )
+    {
+        mNodes[Timer.mNext].mPrev = Timer.mPrev;
+    }
+    --mLevelCount[Timer.mSlot / WheelSlots];
+}
+
+// relink all timers of the current slot of the level, they fall into the lower levels now
+void HPTimerWheel::Cascade ( const uint32_t Level )
+{
+    uint32_t Slot ( Level * WheelSlots + static_cast<uint32_t> ( ( mCurrent >> ( SlotBits * Level ) ) & SlotMask ) );
+    uint32_t Index ( mSlots[Slot] );
+    mSlots[Slot] = NilNode;
+    while ( NilNode != Index )
+    {
+        uint32_t Next ( mNodes[Index].mNext );
+        --mLevelCount[Level];
+        Insert ( Index );
+        Index = Next;
+    }
+}
+
+// turn the wheel up to NowTics and fire the timers with deadlines not later than NowTics.
+// The slots are passed one by one only while the lowest level has timers, otherwise the wheel
+// jumps to the next cascade of the lowest non-empty level
+void HPTimerWheel::Expire ( const int64_t NowTics, std::unique_lock<std::mutex> & Lock )
+{
+    int64_t NowUnit ( TicstoUnit ( NowTics, mResolution ) );
+    while ( true )
+    {
+        uint32_t Slot ( static_cast<uint32_t> ( mCurrent & SlotMask ) );
+        uint32_t Index ( mSlots[Slot] );
+        while ( NilNode != Index )
+        {
+            uint32_t Next ( mNodes[Index].mNext );
+            Node & Timer ( mNodes[Index] );
+            if ( Timer.mDeadline <= NowTics )
+            {
+                Unlink ( Index );
+                mFiring.push_back ( std::move ( Timer.mFunc ) );
+                Timer.mFunc = nullptr;
+                Timer.mPending = false;
+                Timer.mGeneration = ( UINT32_MAX == Timer.mGeneration ) ? 1 : Timer.mGeneration + 1;
+                Timer.mNext = mFree;
+                mFree = Index;
+                --mCount;
+            }
+            Index = Next;
+        }
+        if ( mCurrent >= NowUnit )
+        {
+            break;
+        }
+
+        if ( 0 == mCount )
+        {
+            mCurrent = NowUnit;
+            break;
+        }
+        uint32_t Lowest ( 0 );
+        while ( 0 == mLevelCount[Lowest] )
+        {
+            ++Lowest;
+        }
+        int64_t Step ( 1LL << ( SlotBits * Lowest ) );
+        mCurrent = std::min ( ( mCurrent & ~( Step - 1 ) ) + Step, NowUnit );
+
+        // the highest level is cascaded first, so its timers can fall through all lower levels
+        uint32_t Level ( 1 );
+        while ( ( Level < WheelLevels ) && ( 0 == ( mCurrent & ( ( 1LL << ( SlotBits * Level ) ) - 1 ) ) ) )
+        {
+            ++Level;
+        }
+        while ( --Level > 0 )
+        {
+            Cascade ( Level );
+        }
+    }
+
+    if ( !mFiring.empty() )
+    {
+        Lock.unlock();
+        for ( size_t i = 0; i < mFiring.size(); ++i )
+        {
+            mFiring[i]();
+        }
+        mFiring.clear();
+        Lock.lock();
+    }
+}
+
+// nearest deadline, if it is in the slots of the lowest level before the next cascade,
+// otherwise the time of the next cascade of the lowest non-empty level
+int64_t HPTimerWheel::NextWake() const
+{
+    if ( 0 == mCount )
+    {
+        return INT64_MAX;
+    }
+    int64_t Boundary ( ( mCurrent | SlotMask ) + 1 );
+    if ( mLevelCount[0] > 0 )
+    {
+        for ( int64_t Unit = mCurrent; Unit < Boundary; ++Unit )
+        {
+            uint32_t Index ( mSlots[static_cast<uint32_t> ( Unit & SlotMask )] );
+            if ( NilNode == Index )
+            {
+                continue;
+            }
+            int64_t Wake ( INT64_MAX );
+            for ( ; NilNode != Index; Index = mNodes[Index].mNext )
+            {
+                Wake = std::min ( Wake, mNodes[Index].mDeadline );
+            }
+            return Wake;
+        }
+        return Boundary * mResolution;
+    }
+    uint32_t Lowest ( 1 );
+    while ( 0 == mLevelCount[Lowest] )
+    {
+        ++Lowest;
+    }
+    int64_t Step ( 1LL << ( SlotBits * Lowest ) );
+    return ( ( mCurrent & ~( Step - 1 ) ) + Step ) * mResolution;
+}
+
+// main loop of the driver thread: fire the expired timers and sleep to the nearest deadline.
+// A timer, which is added with an earlier deadline, interrupts the sleep
+void HPTimerWheel::Run()
+{
+    std::unique_lock<std::mutex> Lock ( mMutex );
+    while ( !mStop )
+    {
+        Expire ( HPTimestamp::Now().HPTics(), Lock );
+        if ( mStop )
+        {
+            break;
+        }
+        mPlannedWake = NextWake();
+        // without a pending timer the wait lasts untill Add() interrupts it. The shift is negative for a clock ahead
+        // of CLOCK_REALTIME, e.g. CLOCK_TAI, so a late wake up is saturated instead of overflowing
+        int64_t Shift ( HighPerTimer::GetUnixZeroShift() );
+        int64_t WakeTics ( ( INT64_MAX == mPlannedWake ) || ( ( Shift < 0 ) && ( mPlannedWake > INT64_MAX + Shift ) )
+                           ? INT64_MAX : mPlannedWake - Shift );
+        mSleeper.WaitTo ( Lock, WakeTics );
+    }
+    mPlannedWake = INT64_MAX;
+}
+
+} // namespace HPTimer
@@ -0,0 +1,190 @@
+/*
+ * @file   HPTimerWheel.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Hierarchical timer wheel, firing callbacks at HighPerTimer deadlines from one driver thread
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPTIMERWHEEL_H
+#define _HPTIMERWHEEL_H
+#include "HPTimestamp.h"
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HPTimer
+{
+
+//! Scheduler of many deadlines, served by a single driver thread
+/*!
+ * Deadlines are kept in a hierarchical timer wheel of WheelLevels levels with WheelSlots slots each.
+ * A slot of the lowest level covers Resolution, a slot of each higher level covers all slots of the level below.
+ * Insert and cancel are O(1), the timers are moved to the lower levels when the wheel turns.
+ * The driver thread sleeps with the hybrid wait of HPSleeper exactly to the nearest deadline,
+ * so a callback is fired tic-accurate and not only at the resolution of the wheel.
+ * The callbacks are executed in the driver thread without holding the lock of the wheel,
+ * so they may schedule and cancel timers themselves, but should not block for a long time.
+ */
+class HPTimerWheel
+{
+public:
+    /// identifier of a scheduled timer, used to cancel it
+    typedef uint64_t TimerId;
+
+    /// callback fired at the deadline
+    typedef std::function<void()> Callback;
+
+    /// identifier, which is never returned for a scheduled timer
+    static const TimerId InvalidTimer = 0;
+
+    /** ctor
+     * @param Resolution is the time covered by a slot of the lowest level. The horizon of the wheel
+     * is Resolution * WheelSlots ^ WheelLevels, the timers beyond it are cascaded from the highest level repeatedly
+     */
+    explicit HPTimerWheel ( const HPDuration & Resolution = HPDuration::FromUSec ( 100 ) );
+
+    /// dtor, stops the driver thread. The pending timers are dropped without firing
+    ~HPTimerWheel();
+
+    HPTimerWheel ( const HPTimerWheel & ) = delete;
+    HPTimerWheel & operator= ( const HPTimerWheel & ) = delete;
+
+    /** schedule the callback at the deadline
+     * @param Deadline is the time since begin of Unix era, at which the callback should be fired
+     * @param Func is the callback
+     * @return identifier of the timer
+     */
+    TimerId Schedule ( const HighPerTimer & Deadline, Callback Func );
+
+    /** schedule the callback at the deadline
+     * @param Deadline is the time at which the callback should be fired
+     * @param Func is the callback
+     * @return identifier of the timer
+     */
+    TimerId Schedule ( const HPTimestamp & Deadline, Callback Func );
+
+    /** schedule the callback after the delay from now
+     * @param Delay is the time after which the callback should be fired
+     * @param Func is the callback
+     * @return identifier of the timer
+     * @exception std::out_of_range if the deadline is out of the HPTimer range
+     */
+    TimerId ScheduleAfter ( const HPDuration & Delay, Callback Func );
+
+    /** cancel the timer
+     * @param Id is the identifier of the timer
+     * @return true if the timer was pending, false if it was already fired, is being fired or cancelled
+     */
+    bool Cancel ( const TimerId Id );
+
+    /// number of pending timers
+    size_t Size() const;
+
+    /// start the driver thread. Nothing happens if it runs already
+    void Start();
+
+    /// stop the driver thread and wait for it. The pending timers stay in the wheel
+    void Stop();
+
+    /// number of slots of each level
+    static const uint32_t WheelSlots = 256;
+
+    /// number of levels
+    static const uint32_t WheelLevels = 4;
+
+private:
+    /// end of the list of nodes
+    static const uint32_t NilNode = UINT32_MAX;
+
+    /// timer node, linked into the list of a slot or into the free list
+    struct Node
+    {
+        int64_t mDeadline;
+        Callback mFunc;
+        uint32_t mPrev;
+        uint32_t mNext;
+        uint32_t mGeneration;
+        uint32_t mSlot;
+        bool mPending;
+    };
+
+    /// main routine of the driver thread
+    void Run();
+
+    /// link the node into the slot of its deadline
+    void Insert ( const uint32_t Index );
+
+    /// unlink the node from its slot
+    void Unlink ( const uint32_t Index );
+
+    /// move the timers of the slot of the given level to the lower levels
+    void Cascade ( const uint32_t Level );
+
+    /// fire all timers up to the given time, the lock is held and released for the callbacks
+    void Expire ( const int64_t NowTics, std::unique_lock<std::mutex> & Lock );
+
+    /// calculate the tics, at which the driver should wake up next. INT64_MAX if no timer is pending
+    int64_t NextWake() const;
+
+    /// schedule the node under the lock and wake the driver if the deadline is the nearest one
+    TimerId Add ( const int64_t Deadline, Callback && Func );
+
+    /// tics of a slot of the lowest level
+    int64_t mResolution;
+
+    /// index of the slot of the lowest level, which is processed now, in units of mResolution
+    int64_t mCurrent;
+
+    /// heads of the lists of the slots of all levels
+    std::vector<uint32_t> mSlots;
+
+    /// storage of all nodes, the unused nodes form the free list
+    std::vector<Node> mNodes;
+
+    /// head of the free list
+    uint32_t mFree;
+
+    /// number of pending timers
+    size_t mCount;
+
+    /// number of pending timers of each level
+    size_t mLevelCount[WheelLevels];
+
+    /// tics, to which the driver sleeps now
+    int64_t mPlannedWake;
+
+    /// the driver shall leave
+    bool mStop;
+
+    /// callbacks collected for fireing outside of the lock
+    std::vector<Callback> mFiring;
+
+    /// protects the wheel
+    mutable std::mutex mMutex;
+
+    /// sleeper of the driver thread
+    HPSleeper mSleeper;
+
+    /// driver thread
+    std::thread mDriver;
+};
+
+} // namespace HPTimer
+#endif // _HPTIMERWHEEL_H
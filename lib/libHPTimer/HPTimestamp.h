@@ -0,0 +1,487 @@
+/*
+ * @file   HPTimestamp.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Compact time point and time interval values, holding only the tics of the timer counter
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPTIMESTAMP_H
+#define _HPTIMESTAMP_H
+#include "HighPerTimer.h"
+#include <type_traits>
+
+namespace HPTimer
+{
+
+/// range check of the sum of two tic values against the max and min HPTimer values
+/// @exception std::out_of_range if the sum is out of the HPTimer range
+inline int64_t HPTicsAdd ( const int64_t Tics1, const int64_t Tics2 )
+{
+    if ( ( Tics2 > 0 ) && ( ( HighPerTimer::MaxHPTics() - Tics2 ) < Tics1 ) )
+    {
+        HPTimer::ThrowOverflow();
+    }
+    if ( ( Tics2 < 0 ) && ( ( HighPerTimer::MinHPTics() - Tics2 ) > Tics1 ) )
+    {
+        HPTimer::ThrowOverflow();
+    }
+    return Tics1 + Tics2;
+}
+
+/// range check of the difference of two tic values against the max and min HPTimer values
+/// @exception std::out_of_range if the difference is out of the HPTimer range
+inline int64_t HPTicsSub ( const int64_t Tics1, const int64_t Tics2 )
+{
+    if ( ( Tics2 > 0 ) && ( ( HighPerTimer::MinHPTics() + Tics2 ) > Tics1 ) )
+    {
+        HPTimer::ThrowOverflow();
+    }
+    if ( ( Tics2 < 0 ) && ( ( HighPerTimer::MaxHPTics() + Tics2 ) < Tics1 ) )
+    {
+        HPTimer::ThrowOverflow();
+    }
+    return Tics1 - Tics2;
+}
+
+//! Time interval of the timer counter
+/*!
+ * HPDuration holds only the signed amount of tics and is trivially copyable, so it fits into a register
+ * and can be stored in arrays and shared memory. Seconds and nanoseconds parts are calculated on each access,
+ * so use HighPerTimer, if the parts are accessed frequently.
+ */
+class HPDuration
+{
+public:
+    /// standard ctor, zero interval
+    HPDuration() = default;
+
+    /** ctor
+     * @param Timer is a HighPerTimer, which value is interpreted as time interval
+     */
+    inline explicit HPDuration ( const HighPerTimer & Timer ) :
+            mHPTics ( Timer.HPTics() )
+    {
+    };
+
+    /// create the interval from the tics of the timer counter
+    inline static HPDuration FromTics ( const int64_t HPTics )
+    {
+        HPDuration Duration;
+        Duration.mHPTics = HPTics;
+        return Duration;
+    };
+
+    /// create the interval from seconds
+    /// @exception std::out_of_range if the interval is out of the HPTimer range
+    inline static HPDuration FromSec ( const int64_t Seconds )
+    {
+        return HPDuration ( HighPerTimer ( Seconds, static_cast<int64_t> ( 0 ) ) );
+    };
+
+    /// create the interval from useconds
+    /// @exception std::out_of_range if the interval is out of the HPTimer range
+    inline static HPDuration FromUSec ( const int64_t USeconds )
+    {
+        if ( ( USeconds > INT64_MAX / 1000LL ) || ( USeconds < INT64_MIN / 1000LL ) )
+        {
+            HPTimer::ThrowOverflow();
+        }
+        return FromTics ( HighPerTimer::NSectoTic ( USeconds * 1000LL ) );
+    };
+
+    /// create the interval from nseconds
+    inline static HPDuration FromNSec ( const int64_t NSeconds )
+    {
+        return FromTics ( HighPerTimer::NSectoTic ( NSeconds ) );
+    };
+
+    /// zero interval
+    inline static HPDuration Nil()
+    {
+        return HPDuration();
+    };
+
+    /// get the tics of the interval
+    inline int64_t HPTics() const
+    {
+        return mHPTics;
+    };
+
+    /// get the seconds part of the interval
+    inline uint64_t Seconds() const
+    {
+        return AbsNSec() / NSecPerSec;
+    };
+
+    /// get the useconds part of the interval
+    inline uint64_t USeconds() const
+    {
+        return ( AbsNSec() % NSecPerSec ) / 1000LL;
+    };
+
+    /// get the nseconds part of the interval
+    inline uint64_t NSeconds() const
+    {
+        return AbsNSec() % NSecPerSec;
+    };
+
+    /// returns true if the interval is negative
+    inline bool Negative() const
+    {
+        return mHPTics < 0;
+    };
+
+    /// returns true if the interval is zero
+    inline bool IsNil() const
+    {
+        return 0 == mHPTics;
+    };
+
+    /// convert the interval to signed nseconds
+    inline int64_t ToNSec() const
+    {
+        return HighPerTimer::TictoNSec ( mHPTics );
+    };
+
+    /// convert the interval to seconds as double
+    inline double ToD() const
+    {
+        return HighPerTimer::TictoD ( mHPTics );
+    };
+
+    /// convert the interval to HighPerTimer
+    inline HighPerTimer ToHPTimer() const
+    {
+        return HighPerTimer ( mHPTics, false );
+    };
+
+    /// sleep the amount of time of the interval. Use a HPSleeper to be able to interrupt the sleep
+    inline void Sleep() const
+    {
+        HPSleeper().Sleep ( *this );
+    };
+
+    /// print the interval in seconds and nanoseconds
+    inline std::string PrintTime() const
+    {
+        return ToHPTimer().PrintTime();
+    };
+
+    inline bool operator== ( const HPDuration & Duration ) const { return mHPTics == Duration.mHPTics; };
+    inline bool operator!= ( const HPDuration & Duration ) const { return mHPTics != Duration.mHPTics; };
+    inline bool operator< ( const HPDuration & Duration ) const { return mHPTics < Duration.mHPTics; };
+    inline bool operator> ( const HPDuration & Duration ) const { return mHPTics > Duration.mHPTics; };
+    inline bool operator<= ( const HPDuration & Duration ) const { return mHPTics <= Duration.mHPTics; };
+    inline bool operator>= ( const HPDuration & Duration ) const { return mHPTics >= Duration.mHPTics; };
+
+    /// @exception std::out_of_range if the sum is out of the HPTimer range
+    inline HPDuration & operator+= ( const HPDuration & Duration )
+    {
+        mHPTics = HPTicsAdd ( mHPTics, Duration.mHPTics );
+        return *this;
+    };
+
+    /// @exception std::out_of_range if the difference is out of the HPTimer range
+    inline HPDuration & operator-= ( const HPDuration & Duration )
+    {
+        mHPTics = HPTicsSub ( mHPTics, Duration.mHPTics );
+        return *this;
+    };
+
+    /// @exception std::out_of_range if the inverted interval is out of the HPTimer range
+    inline HPDuration operator- () const
+    {
+        return FromTics ( HPTicsSub ( 0, mHPTics ) );
+    };
+
+private:
+    /// nanoseconds per second
+    static constexpr uint64_t NSecPerSec = 1000000000ULL;
+
+    /// absolute value of the interval in nseconds, unsigned to keep the min value
+    inline uint64_t AbsNSec() const
+    {
+        int64_t NSec ( HighPerTimer::TictoNSec ( mHPTics ) );
+        return ( NSec < 0 ) ? 0ULL - static_cast<uint64_t> ( NSec ) : static_cast<uint64_t> ( NSec );
+    };
+
+    /// signed amount of tics of the interval
+    int64_t mHPTics = 0;
+};
+
+//! Point of time of the timer counter since begin of Unix era
+/*!
+ * HPTimestamp holds only the tics of the timer counter, shifted to unix zero as in HighPerTimer,
+ * and is trivially copyable. Differences of timestamps are HPDuration values.
+ */
+class HPTimestamp
+{
+public:
+    /// standard ctor, the Unix zero time
+    HPTimestamp() = default;
+
+    /** ctor
+     * @param Timer is a HighPerTimer, which value is interpreted as time since begin of Unix era
+     */
+    inline explicit HPTimestamp ( const HighPerTimer & Timer ) :
+            mHPTics ( Timer.HPTics() )
+    {
+    };
+
+    /** ctor
+     * @param TV is a timeval since begin of Unix era
+     * @exception std::out_of_range if the time is out of the HPTimer range
+     */
+    inline explicit HPTimestamp ( const timeval & TV ) :
+            mHPTics ( HighPerTimer ( TV ).HPTics() )
+    {
+    };
+
+    /** ctor
+     * @param TS is a timespec since begin of Unix era
+     * @exception std::out_of_range if the time is out of the HPTimer range
+     */
+    inline explicit HPTimestamp ( const timespec & TS ) :
+            mHPTics ( HighPerTimer ( TS ).HPTics() )
+    {
+    };
+
+    /// create the timestamp from tics, shifted to unix zero
+    inline static HPTimestamp FromTics ( const int64_t HPTics )
+    {
+        HPTimestamp Timestamp;
+        Timestamp.mHPTics = HPTics;
+        return Timestamp;
+    };
+
+    /// create the timestamp from seconds since begin of Unix era
+    /// @exception std::out_of_range if the time is out of the HPTimer range
+    inline static HPTimestamp FromSec ( const int64_t Seconds )
+    {
+        return FromTics ( HPDuration::FromSec ( Seconds ).HPTics() );
+    };
+
+    /// create the timestamp from useconds since begin of Unix era
+    /// @exception std::out_of_range if the time is out of the HPTimer range
+    inline static HPTimestamp FromUSec ( const int64_t USeconds )
+    {
+        return FromTics ( HPDuration::FromUSec ( USeconds ).HPTics() );
+    };
+
+    /// create the timestamp from nseconds since begin of Unix era
+    inline static HPTimestamp FromNSec ( const int64_t NSeconds )
+    {
+        return FromTics ( HighPerTimer::NSectoTic ( NSeconds ) );
+    };
+
+    /// get the correct time
+    inline static HPTimestamp Now()
+    {
+        return FromTics ( HighPerTimer::GetTimerTics() + HighPerTimer::GetUnixZeroShift() );
+    };
+
+    /// get the correct time, reading the timer counter with the reader given at compile time
+    /// NOTE: Reader must be equal to HighPerTimer::GetTicsReader()
+    template <TicsReader Reader>
+    inline static HPTimestamp Now()
+    {
+        return FromTics ( HighPerTimer::ReaderTics<Reader>() + HighPerTimer::GetUnixZeroShift() );
+    };
+
+    /// get the tics of the timestamp, shifted to unix zero
+    inline int64_t HPTics() const
+    {
+        return mHPTics;
+    };
+
+    /// get the interval since begin of Unix era
+    inline HPDuration SinceUnixZero() const
+    {
+        return HPDuration::FromTics ( mHPTics );
+    };
+
+    /// get the seconds part of the time
+    inline uint64_t Seconds() const
+    {
+        return SinceUnixZero().Seconds();
+    };
+
+    /// get the useconds part of the time
+    inline uint64_t USeconds() const
+    {
+        return SinceUnixZero().USeconds();
+    };
+
+    /// get the nseconds part of the time
+    inline uint64_t NSeconds() const
+    {
+        return SinceUnixZero().NSeconds();
+    };
+
+    /// returns true if the time is before begin of Unix era
+    inline bool Negative() const
+    {
+        return mHPTics < 0;
+    };
+
+    /// returns true if the time is the Unix zero time
+    inline bool IsNil() const
+    {
+        return 0 == mHPTics;
+    };
+
+    /// convert the time to signed nseconds since begin of Unix era
+    inline int64_t ToNSec() const
+    {
+        return HighPerTimer::TictoNSec ( mHPTics );
+    };
+
+    /// convert the time to seconds since begin of Unix era as double
+    inline double ToD() const
+    {
+        return HighPerTimer::TictoD ( mHPTics );
+    };
+
+    /// set the timeval TV to the time, the sign is ignored
+    inline void SetTV ( struct timeval & TV ) const
+    {
+        TV.tv_sec = Seconds();
+        TV.tv_usec = USeconds();
+    };
+
+    /// set the timespec TS to the time, the sign is ignored
+    inline void SetTS ( struct timespec & TS ) const
+    {
+        TS.tv_sec = Seconds();
+        TS.tv_nsec = NSeconds();
+    };
+
+    /// convert the time to HighPerTimer
+    inline HighPerTimer ToHPTimer() const
+    {
+        return HighPerTimer ( mHPTics, false );
+    };
+
+    /// wait untill this time is reached. Use a HPSleeper to be able to interrupt the sleep
+    inline void SleepTo() const
+    {
+        HPSleeper().SleepTo ( *this );
+    };
+
+    /** print the time
+     * @param HPTimer_only might be true if only the time value should be printed
+     * @param UnixTime might be false if time in seconds should be printed
+     */
+    inline std::string PrintTime ( bool HPTimer_only = false, bool UnixTime = true ) const
+    {
+        return ToHPTimer().PrintTime ( HPTimer_only, UnixTime );
+    };
+
+    /** write the time into the buffer of the caller without allocation, see HighPerTimer::FormatTo()
+     * @return number of the written characters without the terminating zero, 0 if the buffer is too small
+     */
+    inline size_t FormatTo ( char * Buffer, const size_t Length, const TimeFormat Format = TimeFormat::Unix ) const
+    {
+        return ToHPTimer().FormatTo ( Buffer, Length, Format );
+    };
+
+    inline bool operator== ( const HPTimestamp & Timestamp ) const { return mHPTics == Timestamp.mHPTics; };
+    inline bool operator!= ( const HPTimestamp & Timestamp ) const { return mHPTics != Timestamp.mHPTics; };
+    inline bool operator< ( const HPTimestamp & Timestamp ) const { return mHPTics < Timestamp.mHPTics; };
+    inline bool operator> ( const HPTimestamp & Timestamp ) const { return mHPTics > Timestamp.mHPTics; };
+    inline bool operator<= ( const HPTimestamp & Timestamp ) const { return mHPTics <= Timestamp.mHPTics; };
+    inline bool operator>= ( const HPTimestamp & Timestamp ) const { return mHPTics >= Timestamp.mHPTics; };
+
+    /// @exception std::out_of_range if the time is out of the HPTimer range
+    inline HPTimestamp & operator+= ( const HPDuration & Duration )
+    {
+        mHPTics = HPTicsAdd ( mHPTics, Duration.HPTics() );
+        return *this;
+    };
+
+    /// @exception std::out_of_range if the time is out of the HPTimer range
+    inline HPTimestamp & operator-= ( const HPDuration & Duration )
+    {
+        mHPTics = HPTicsSub ( mHPTics, Duration.HPTics() );
+        return *this;
+    };
+
+private:
+    /// tics of the timer counter, shifted to unix zero
+    int64_t mHPTics = 0;
+};
+
+static_assert ( sizeof ( HPDuration ) == sizeof ( int64_t ) && std::is_trivially_copyable<HPDuration>::value,
+                "HPDuration must be a trivially copyable 8 byte value" );
+static_assert ( sizeof ( HPTimestamp ) == sizeof ( int64_t ) && std::is_trivially_copyable<HPTimestamp>::value,
+                "HPTimestamp must be a trivially copyable 8 byte value" );
+
+/// interval between two timestamps
+/// @exception std::out_of_range if the interval is out of the HPTimer range
+inline HPDuration operator- ( const HPTimestamp & Timestamp1, const HPTimestamp & Timestamp2 )
+{
+    return HPDuration::FromTics ( HPTicsSub ( Timestamp1.HPTics(), Timestamp2.HPTics() ) );
+}
+
+/// @exception std::out_of_range if the time is out of the HPTimer range
+inline HPTimestamp operator+ ( const HPTimestamp & Timestamp, const HPDuration & Duration )
+{
+    return HPTimestamp::FromTics ( HPTicsAdd ( Timestamp.HPTics(), Duration.HPTics() ) );
+}
+
+/// @exception std::out_of_range if the time is out of the HPTimer range
+inline HPTimestamp operator+ ( const HPDuration & Duration, const HPTimestamp & Timestamp )
+{
+    return Timestamp + Duration;
+}
+
+/// @exception std::out_of_range if the time is out of the HPTimer range
+inline HPTimestamp operator- ( const HPTimestamp & Timestamp, const HPDuration & Duration )
+{
+    return HPTimestamp::FromTics ( HPTicsSub ( Timestamp.HPTics(), Duration.HPTics() ) );
+}
+
+/// @exception std::out_of_range if the interval is out of the HPTimer range
+inline HPDuration operator+ ( const HPDuration & Duration1, const HPDuration & Duration2 )
+{
+    return HPDuration::FromTics ( HPTicsAdd ( Duration1.HPTics(), Duration2.HPTics() ) );
+}
+
+/// @exception std::out_of_range if the interval is out of the HPTimer range
+inline HPDuration operator- ( const HPDuration & Duration1, const HPDuration & Duration2 )
+{
+    return HPDuration::FromTics ( HPTicsSub ( Duration1.HPTics(), Duration2.HPTics() ) );
+}
+
+/// left shift operator
+inline std::ostream & operator<< ( std::ostream & OStr, const HPTimestamp & Timestamp )
+{
+    OStr << Timestamp.ToHPTimer();
+    return OStr;
+}
+
+/// left shift operator
+inline std::ostream & operator<< ( std::ostream & OStr, const HPDuration & Duration )
+{
+    OStr << Duration.ToHPTimer();
+    return OStr;
+}
+
+} // namespace HPTimer
+#endif // _HPTIMESTAMP_H
@@ -0,0 +1,356 @@
+/*
+ * @file   HPTrace.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  In-process span recorder on raw tics with per-thread rings, a drain thread and the Chrome trace output
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "HPTrace.h"
+
+namespace HPTimer
+{
+
+std::atomic<bool> HPTrace::Enabled ( false );
+bool HPTrace::UseCPUTics ( false );
+thread_local HPTraceRing * HPTrace::LocalRing ( nullptr );
+
+HPTraceRing::HPTraceRing ( const size_t Capacity, const uint32_t ThreadId ) :
+        mCapacity ( 1 ),
+        mThreadId ( ThreadId ),
+        mCachedTail ( 0 ),
+        mHead ( 0 ),
+        mDropped ( 0 ),
+        mTail ( 0 ),
+        mRetired ( false )
+{
+    while ( mCapacity < Capacity )
+    {
+        mCapacity <<= 1;
+    }
+    mEvents.resize ( mCapacity );
+}
+
+// an event moved out of a ring, with the thread which recorded it
+struct CollectedEvent
+{
+    HPTraceEvent mEvent;
+    uint32_t mThreadId;
+};
+
+// owner of a ring with the state of the drain, only accessed under the lock
+struct RingEntry
+{
+    HPTraceRing * mRing;
+    uint64_t mDroppedSeen;
+};
+
+struct TraceSite
+{
+    std::string mName;
+    std::string mCategory;
+};
+
+// the rings, the sites, the collected events and the state of the drain thread, protected by one mutex.
+// The lock is taken on the first recorded event of a thread, on its exit and by the drains, never by a push
+struct TraceRegistry
+{
+    std::mutex mMutex;
+    std::vector<RingEntry> mRings;
+    std::vector<TraceSite> mSites;
+    std::vector<CollectedEvent> mEvents;
+    uint64_t mDropped = 0;
+    int64_t mBaseTics = INT64_MIN;
+    int64_t mInterval = 0;
+    size_t mRingEvents = 0;
+    bool mStop = false;
+    HPSleeper mSleeper;
+    std::thread mDriver;
+};
+
+static TraceRegistry & Registry()
+{
+    // leaked on purpose: a span recorded from a static destructor still attaches its ring, and the drain thread,
+    // which is not joined if Stop() is never called, keeps using the registry untill the process ends
+    static TraceRegistry * Instance ( new TraceRegistry );
+    return *Instance;
+}
+
+// set when the RingOwner of the thread is destroyed. It has no destructor, so it stays valid
+// for the thread_local destructors, which run after the one of the owner
+static thread_local bool Detached ( false );
+
+// retires the ring of the thread on its exit. The drain collects its last events and deletes it
+struct RingOwner
+{
+    HPTraceRing * mRing = nullptr;
+
+    ~RingOwner()
+    {
+        Detached = true;
+        if ( mRing )
+        {
+            HPTrace::LocalRing = nullptr;
+            mRing->mRetired.store ( true, std::memory_order_release );
+        }
+    }
+};
+
+static thread_local RingOwner Owner;
+
+// the drain moves the events of [tail, head) and publishes the new tail, so the writer can reuse the slots
+void HPTrace::DrainLocked()
+{
+    TraceRegistry & Reg ( Registry() );
+    for ( size_t i = 0; i < Reg.mRings.size(); )
+    {
+        HPTraceRing * Ring ( Reg.mRings[i].mRing );
+        bool Retired ( Ring->mRetired.load ( std::memory_order_acquire ) );
+        uint64_t Head ( Ring->mHead.load ( std::memory_order_acquire ) );
+        uint64_t Tail ( Ring->mTail.load ( std::memory_order_relaxed ) );
+        for ( ; Tail != Head; ++Tail )
+        {
+            CollectedEvent Collected = { Ring->mEvents[Tail & ( Ring->mCapacity - 1 )], Ring->mThreadId };
+            Reg.mEvents.push_back ( Collected );
+        }
+        Ring->mTail.store ( Tail, std::memory_order_release );
+        uint64_t Dropped ( Ring->mDropped.load ( std::memory_order_relaxed ) );
+        Reg.mDropped += Dropped - Reg.mRings[i].mDroppedSeen;
+        Reg.mRings[i].mDroppedSeen = Dropped;
+        if ( Retired )
+        {
+            delete Ring;
+            Reg.mRings[i] = Reg.mRings.back();
+            Reg.mRings.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+uint32_t HPTrace::RegisterSite ( const std::string & Name, const std::string & Category )
+{
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    TraceSite Site = { Name, Category };
+    Reg.mSites.push_back ( Site );
+    return static_cast<uint32_t> ( Reg.mSites.size() - 1 );
+}
+
+// the clock and its base are chosen on the first start after a clear, so all collected events share them
+// @exception std::out_of_range if a parameter is not positive
+void HPTrace::Start ( const HPDuration & DrainInterval, const size_t RingEvents )
+{
+    if ( ( DrainInterval.HPTics() <= 0 ) || ( 0 == RingEvents ) )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HPTrace" ) );
+    }
+    HPTimestamp::Now();
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    if ( Reg.mDriver.joinable() )
+    {
+        return;
+    }
+    if ( INT64_MIN == Reg.mBaseTics )
+    {
+        HPTrace::UseCPUTics = ( TimeSource::TSC == HighPerTimer::GetHPSource() ) && !HighPerTimer::IsTSCSkewCorrected();
+        Reg.mBaseTics = HPTrace::Tics();
+    }
+    Reg.mInterval = DrainInterval.HPTics();
+    Reg.mRingEvents = RingEvents;
+    Reg.mStop = false;
+    Reg.mDriver = std::thread ( &HPTrace::Run );
+    HPTrace::Enabled.store ( true, std::memory_order_release );
+}
+
+// a span, which is still running, is recorded into its ring and collected by the next drain
+void HPTrace::Stop()
+{
+    TraceRegistry & Reg ( Registry() );
+    {
+        std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+        if ( !Reg.mDriver.joinable() )
+        {
+            return;
+        }
+        HPTrace::Enabled.store ( false, std::memory_order_relaxed );
+        Reg.mStop = true;
+        Reg.mSleeper.Interrupt();
+    }
+    Reg.mDriver.join();
+    HPTrace::Drain();
+}
+
+void HPTrace::Drain()
+{
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    HPTrace::DrainLocked();
+}
+
+// main loop of the drain thread: sleep one interval and drain, Stop() interrupts the sleep
+void HPTrace::Run()
+{
+    TraceRegistry & Reg ( Registry() );
+    std::unique_lock<std::mutex> Lock ( Reg.mMutex );
+    while ( !Reg.mStop )
+    {
+        Reg.mSleeper.WaitTo ( Lock, HPTimestamp::Now().HPTics() + Reg.mInterval - HighPerTimer::GetUnixZeroShift() );
+        HPTrace::DrainLocked();
+    }
+}
+
+HPTraceRing * HPTrace::AttachThread()
+{
+    if ( !HPTrace::IsEnabled() )
+    {
+        return nullptr;
+    }
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    // an event of a later thread_local destructor of an exiting thread would need a ring, which no owner retires
+    if ( Detached )
+    {
+        ++Reg.mDropped;
+        return nullptr;
+    }
+    HPTraceRing * Ring ( new HPTraceRing ( Reg.mRingEvents, static_cast<uint32_t> ( syscall ( SYS_gettid ) ) ) );
+    RingEntry Entry = { Ring, 0 };
+    Reg.mRings.push_back ( Entry );
+    Owner.mRing = Ring;
+    HPTrace::LocalRing = Ring;
+    return Ring;
+}
+
+// write the microseconds with the fraction of the nanoseconds, as the format takes floating point times
+static void WriteMicroseconds ( std::ostream & OStr, const int64_t NSeconds )
+{
+    char Text[32];
+    int64_t Abs ( NSeconds < 0 ? -NSeconds : NSeconds );
+    snprintf ( Text, sizeof ( Text ), "%s%lld.%03lld", NSeconds < 0 ? "-" : "", static_cast<long long> ( Abs / 1000 ),
+               static_cast<long long> ( Abs % 1000 ) );
+    OStr << Text;
+}
+
+// names are written as JSON strings, the control characters escaped
+static void WriteString ( std::ostream & OStr, const std::string & Text )
+{
+    OStr << '"';
+    for ( const char c : Text )
+    {
+        if ( ( '"' == c ) || ( '\\' == c ) )
+        {
+            OStr << '\\' << c;
+        }
+        else if ( static_cast<unsigned char> ( c ) < 0x20 )
+        {
+            char Escape[8];
+            snprintf ( Escape, sizeof ( Escape ), "\\u%04x", c );
+            OStr << Escape;
+        }
+        else
+        {
+            OStr << c;
+        }
+    }
+    OStr << '"';
+}
+
+// spans are written as complete events with their duration, so a dropped event never leaves a span open
+void HPTrace::WriteChromeTrace ( std::ostream & OStr )
+{
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    HPTrace::DrainLocked();
+    long long Pid ( getpid() );
+    OStr << "{\"traceEvents\":[";
+    bool First ( true );
+    for ( const CollectedEvent & Collected : Reg.mEvents )
+    {
+        const HPTraceEvent & Event ( Collected.mEvent );
+        const TraceSite & Site ( Reg.mSites[Event.mSite] );
+        OStr << ( First ? "\n" : ",\n" ) << "{\"name\":";
+        WriteString ( OStr, Site.mName );
+        OStr << ",\"cat\":";
+        WriteString ( OStr, Site.mCategory );
+        OStr << ",\"pid\":" << Pid << ",\"tid\":" << Collected.mThreadId << ",\"ts\":";
+        WriteMicroseconds ( OStr, HighPerTimer::TictoNSec ( Event.mBegin - Reg.mBaseTics ) );
+        if ( HPTrace::Span == Event.mKind )
+        {
+            OStr << ",\"ph\":\"X\",\"dur\":";
+            WriteMicroseconds ( OStr, HighPerTimer::TictoNSec ( Event.mEnd - Event.mBegin ) );
+        }
+        else
+        {
+            OStr << ",\"ph\":\"i\",\"s\":\"t\"";
+        }
+        OStr << "}";
+        First = false;
+    }
+    OStr << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":" << Reg.mDropped << "}}\n";
+}
+
+bool HPTrace::WriteChromeTrace ( const std::string & Path )
+{
+    std::ofstream File ( Path.c_str() );
+    if ( !File )
+    {
+        return false;
+    }
+    HPTrace::WriteChromeTrace ( File );
+    File.close();
+    return !File.fail();
+}
+
+// the base is reset only while the tracing is stopped, a running trace keeps its clock
+void HPTrace::Clear()
+{
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    HPTrace::DrainLocked();
+    Reg.mEvents.clear();
+    Reg.mDropped = 0;
+    if ( !Reg.mDriver.joinable() )
+    {
+        Reg.mBaseTics = INT64_MIN;
+    }
+}
+
+size_t HPTrace::GetEventCount()
+{
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    return Reg.mEvents.size();
+}
+
+uint64_t HPTrace::GetDroppedCount()
+{
+    TraceRegistry & Reg ( Registry() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    return Reg.mDropped;
+}
+
+} // namespace HPTimer
@@ -0,0 +1,281 @@
+/*
+ * @file   HPTrace.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  In-process span recorder on raw tics with per-thread rings, a drain thread and the Chrome trace output
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPTRACE_H
+#define _HPTRACE_H
+#include <stdint.h>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "HPTimestamp.h"
+
+namespace HPTimer
+{
+
+struct RingOwner;
+
+/// one recorded span or instant, in raw tics of the trace clock
+struct HPTraceEvent
+{
+    /// tics at the begin of the span
+    int64_t mBegin;
+
+    /// tics at the end of the span, equal to mBegin for an instant
+    int64_t mEnd;
+
+    /// id of the site, as returned by HPTrace::RegisterSite()
+    uint32_t mSite;
+
+    /// kind of the event, see HPTrace::Span and HPTrace::Instant
+    uint32_t mKind;
+};
+
+//! Ring of the events of one thread, written by its thread and read by the drain thread
+/*!
+ * The writer only loads the read index, when its cached copy says the ring is full, so a push touches
+ * no cache line of the drain thread in the common case. A full ring drops the new event and counts it.
+ */
+class HPTraceRing
+{
+    friend class HPTrace;
+    friend struct RingOwner;
+public:
+    /** ctor
+     * @param Capacity is the number of events, rounded up to a power of two
+     * @param ThreadId is the id of the writing thread in the output
+     */
+    HPTraceRing ( const size_t Capacity, const uint32_t ThreadId );
+
+    /// append the event, or count it as dropped if the ring is full
+    inline void Push ( const int64_t Begin, const int64_t End, const uint32_t Site, const uint32_t Kind )
+    {
+        uint64_t Head ( mHead.load ( std::memory_order_relaxed ) );
+        if ( Head - mCachedTail >= mCapacity )
+        {
+            mCachedTail = mTail.load ( std::memory_order_acquire );
+            if ( Head - mCachedTail >= mCapacity )
+            {
+                mDropped.store ( mDropped.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+                return;
+            }
+        }
+        HPTraceEvent & Event ( mEvents[Head & ( mCapacity - 1 )] );
+        Event.mBegin = Begin;
+        Event.mEnd = End;
+        Event.mSite = Site;
+        Event.mKind = Kind;
+        mHead.store ( Head + 1, std::memory_order_release );
+    };
+
+private:
+    /// storage of the events
+    std::vector<HPTraceEvent> mEvents;
+
+    /// number of events, a power of two
+    uint64_t mCapacity;
+
+    /// id of the writing thread
+    uint32_t mThreadId;
+
+    /// copy of the read index, only used by the writer
+    uint64_t mCachedTail;
+
+    /// keeps the write index of the writer and the read index of the drain thread in different cache lines
+    char mPad0[64];
+
+    /// number of events written
+    std::atomic<uint64_t> mHead;
+
+    /// number of dropped events, written by the writer only
+    std::atomic<uint64_t> mDropped;
+
+    char mPad1[64];
+
+    /// number of events read
+    std::atomic<uint64_t> mTail;
+
+    /// the writing thread has exited, the ring is released when it is empty
+    std::atomic<bool> mRetired;
+};
+
+//! Low-overhead recorder of spans, converted to the Chrome trace format at dump time
+/*!
+ * A span costs two reads of the counter and one store into the ring of the calling thread, no lock and no
+ * system call, so it can be left in code which is measured: the TSC by RDTSCP if the TSC is the time source
+ * and not corrected for skew, otherwise the current time source. The events stay in raw tics, a drain thread
+ * moves them from the rings into the collected list and the conversion to time by the calibration of
+ * HighPerTimer is done only by WriteChromeTrace(). The output is the JSON of the Chrome trace event format,
+ * which is opened by chrome://tracing and by the Perfetto UI.
+ * When the tracing is not started, a span only loads one flag.
+ * Usage:
+ *     static const uint32_t Site ( HPTimer::HPTrace::RegisterSite ( "ParsePacket" ) );
+ *     HPTimer::HPTraceScope Scope ( Site );
+ */
+class HPTrace
+{
+    friend struct RingOwner;
+public:
+    /// kinds of the events
+    static const uint32_t Span = 0;
+    static const uint32_t Instant = 1;
+
+    /// exclude creating any instance of HPTrace class
+    HPTrace() = delete;
+
+    /** register a site of spans. Call it once per site, e.g. to initialize a static local variable
+     * @param Name is the name of the spans in the output
+     * @param Category is the category of the spans in the output
+     * @return id of the site
+     */
+    static uint32_t RegisterSite ( const std::string & Name, const std::string & Category = "HPTrace" );
+
+    /** start the recording and the drain thread
+     * @param DrainInterval is the time between two drains of the rings
+     * @param RingEvents is the number of events of the ring of each thread, which can be kept between two drains
+     * @exception std::out_of_range if a parameter is not positive
+     */
+    static void Start ( const HPDuration & DrainInterval = HPDuration::FromUSec ( 10000 ), const size_t RingEvents = 1 << 16 );
+
+    /// stop the recording and the drain thread. The events in the rings are collected
+    static void Stop();
+
+    /// return true if the events are recorded
+    inline static bool IsEnabled()
+    {
+        return HPTrace::Enabled.load ( std::memory_order_relaxed );
+    };
+
+    /// read the trace clock, the value to pass as begin to Record()
+    inline static int64_t Tics()
+    {
+        return HPTrace::UseCPUTics ? HighPerTimer::CPU_Tics() : HPTimestamp::Now().HPTics();
+    };
+
+    /** record a span of the calling thread
+     * @param Site is the id of the site
+     * @param Begin is the value of Tics() at the begin of the span
+     */
+    inline static void Record ( const uint32_t Site, const int64_t Begin )
+    {
+        HPTraceRing * Ring ( HPTrace::LocalRing );
+        if ( !Ring && !( Ring = HPTrace::AttachThread() ) )
+        {
+            return;
+        }
+        Ring->Push ( Begin, HPTrace::Tics(), Site, HPTrace::Span );
+    };
+
+    /// record an instant of the calling thread, e.g. a packet drop
+    inline static void Mark ( const uint32_t Site )
+    {
+        if ( !HPTrace::IsEnabled() )
+        {
+            return;
+        }
+        HPTraceRing * Ring ( HPTrace::LocalRing );
+        if ( !Ring && !( Ring = HPTrace::AttachThread() ) )
+        {
+            return;
+        }
+        int64_t Now ( HPTrace::Tics() );
+        Ring->Push ( Now, Now, Site, HPTrace::Instant );
+    };
+
+    /// move the events from the rings into the collected list, also called by the drain thread
+    static void Drain();
+
+    /** write the collected events in the Chrome trace event format. The times are in microseconds since Start()
+     * @param OStr is the stream to write to
+     */
+    static void WriteChromeTrace ( std::ostream & OStr );
+
+    /** write the collected events in the Chrome trace event format into the file
+     * @param Path is the name of the file
+     * @return false if the file could not be written
+     */
+    static bool WriteChromeTrace ( const std::string & Path );
+
+    /// discard the collected events and the counts of the dropped ones
+    static void Clear();
+
+    /// get the number of collected events
+    static size_t GetEventCount();
+
+    /// get the number of events, dropped because a ring was full or recorded by an exiting thread after it released its ring
+    static uint64_t GetDroppedCount();
+
+private:
+    /// create the ring of the calling thread, nullptr if the tracing is not started or the thread has released its ring
+    /// on exit. The events of an exiting thread after its release are counted as dropped
+    static HPTraceRing * AttachThread();
+
+    /// drain of the rings, the lock held by the caller
+    static void DrainLocked();
+
+    /// main loop of the drain thread
+    static void Run();
+
+    /// the events are recorded
+    static std::atomic<bool> Enabled;
+
+    /// the trace clock is the TSC, read by CPU_Tics(), otherwise HPTimestamp::Now()
+    static bool UseCPUTics;
+
+    /// ring of the calling thread
+    static thread_local HPTraceRing * LocalRing;
+};
+
+//! RAII marker of a span: from its construction to its destruction
+class HPTraceScope
+{
+public:
+    /// begin the span of the site
+    explicit HPTraceScope ( const uint32_t Site ) :
+            mSite ( Site ),
+            mBegin ( HPTrace::IsEnabled() ? HPTrace::Tics() : INT64_MIN )
+    {
+    };
+
+    /// record the span, if the tracing was started at its begin
+    ~HPTraceScope()
+    {
+        if ( INT64_MIN != mBegin )
+        {
+            HPTrace::Record ( mSite, mBegin );
+        }
+    };
+
+    HPTraceScope ( const HPTraceScope & ) = delete;
+    HPTraceScope & operator= ( const HPTraceScope & ) = delete;
+
+private:
+    /// id of the site
+    uint32_t mSite;
+
+    /// tics at the begin, INT64_MIN if not recorded
+    int64_t mBegin;
+};
+
+} // namespace HPTimer
+#endif // _HPTRACE_H
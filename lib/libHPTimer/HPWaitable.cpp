@@ -0,0 +1,152 @@
+/*
+ * @file   HPWaitable.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Precise deadlines in event loops: a timer descriptor refined by the busy-wait and the sleep on descriptors
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <cerrno>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#include "HPWaitable.h"
+
+// C++ macro for one billion ( 10^9 )
+constexpr int64_t ONE_BILLION = 1000000000LL;
+
+// interval in nanoseconds of the checks of the descriptors in the busy-wait tail, a poll() costs below a microsecond
+constexpr int64_t TailPollNSec = 5000;
+
+namespace HPTimer
+{
+
+// poll the descriptors for at most NSeconds, a negative or zero time only checks them.
+// returns as poll(), a signal is reported as 0, so the caller checks the time again
+static int PollFor ( struct pollfd * Fds, const size_t Count, const int64_t NSeconds )
+{
+    struct timespec Timeout;
+    Timeout.tv_sec = NSeconds > 0 ? NSeconds / ONE_BILLION : 0;
+    Timeout.tv_nsec = NSeconds > 0 ? NSeconds % ONE_BILLION : 0;
+    int Ready ( ppoll ( Fds, static_cast<nfds_t> ( Count ), &Timeout, NULL ) );
+    return ( ( Ready < 0 ) && ( EINTR == errno ) ) ? 0 : Ready;
+}
+
+// wait on the descriptors in the OS untill the busy-wait tail, then busy-wait in steps of TailPollNSec
+// and check the descriptors between the steps. The last step is not followed by a check, so the wake up is not delayed
+int HPSleeper::SleepToOrReadable ( struct pollfd * Fds, const size_t Count, const int64_t WakeTics ) const
+{
+    ClearInterrupt();
+    int64_t BusyNSeconds ( HighPerTimer::GetBusyWaitNSec() );
+    int64_t SysNSeconds ( HighPerTimer::TictoNSec ( WakeTics - HighPerTimer::GetTimerTics() ) );
+    while ( SysNSeconds > BusyNSeconds )
+    {
+        int Ready ( PollFor ( Fds, Count, SysNSeconds - BusyNSeconds ) );
+        if ( 0 != Ready )
+        {
+            return Ready;
+        }
+        SysNSeconds = HighPerTimer::TictoNSec ( WakeTics - HighPerTimer::GetTimerTics() );
+    }
+
+    int64_t StepTics ( HighPerTimer::NSectoTic ( TailPollNSec ) );
+    int64_t Now ( HighPerTimer::GetTimerTics() );
+    while ( ( WakeTics - Now > StepTics ) && !mInterrupted.load ( std::memory_order_relaxed ) )
+    {
+        int Ready ( PollFor ( Fds, Count, 0 ) );
+        if ( 0 != Ready )
+        {
+            return Ready;
+        }
+        WaitFor ( Now + StepTics );
+        Now = HighPerTimer::GetTimerTics();
+    }
+    WaitFor ( WakeTics );
+    return 0;
+}
+
+// wait untill the given time since begin of Unix era is reached or one of the descriptors is ready
+int HPSleeper::SleepToOrReadable ( struct pollfd * Fds, const size_t Count, const HPTimestamp & WakeTime ) const
+{
+    return SleepToOrReadable ( Fds, Count, WakeTime.HPTics() - HighPerTimer::GetUnixZeroShift() );
+}
+
+HPTimerFd::HPTimerFd() :
+        mFd ( timerfd_create ( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC ) ),
+        mArmed ( false )
+{
+}
+
+HPTimerFd::~HPTimerFd()
+{
+    if ( mFd >= 0 )
+    {
+        ::close ( mFd );
+    }
+}
+
+// the timerfd is set relative, so the clocks of the OS and of HighPerTimer need not be mapped.
+// A zero it_value would disarm it, so a deadline within the busy-wait tail expires after one nanosecond
+bool HPTimerFd::Arm ( const HPTimestamp & WakeTime )
+{
+    if ( mFd < 0 )
+    {
+        return false;
+    }
+    int64_t NSeconds ( HighPerTimer::TictoNSec ( WakeTime.HPTics() - HPTimestamp::Now().HPTics() ) - HighPerTimer::GetBusyWaitNSec() );
+    NSeconds = NSeconds > 0 ? NSeconds : 1;
+    struct itimerspec Spec;
+    Spec.it_interval.tv_sec = 0;
+    Spec.it_interval.tv_nsec = 0;
+    Spec.it_value.tv_sec = NSeconds / ONE_BILLION;
+    Spec.it_value.tv_nsec = NSeconds % ONE_BILLION;
+    mWakeTime = WakeTime;
+    mArmed = ( 0 == timerfd_settime ( mFd, 0, &Spec, NULL ) );
+    return mArmed;
+}
+
+bool HPTimerFd::Arm ( const HPDuration & Duration )
+{
+    return Arm ( HPTimestamp::Now() + Duration );
+}
+
+// setting the timer resets the expirations, which were not read
+bool HPTimerFd::Disarm()
+{
+    mArmed = false;
+    if ( mFd < 0 )
+    {
+        return false;
+    }
+    struct itimerspec Spec = { { 0, 0 }, { 0, 0 } };
+    return 0 == timerfd_settime ( mFd, 0, &Spec, NULL );
+}
+
+// the read fails with EAGAIN, if the timer has not expired since it was set
+bool HPTimerFd::Complete()
+{
+    uint64_t Expirations ( 0 );
+    if ( !mArmed || ( sizeof ( Expirations ) != ::read ( mFd, &Expirations, sizeof ( Expirations ) ) ) )
+    {
+        return false;
+    }
+    mArmed = false;
+    mSleeper.SleepTo ( mWakeTime );
+    return true;
+}
+
+} // namespace HPTimer
@@ -0,0 +1,110 @@
+/*
+ * @file   HPWaitable.h
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Precise deadlines in event loops: a timer descriptor refined by the busy-wait and the sleep on descriptors
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#ifndef _HPWAITABLE_H
+#define _HPWAITABLE_H
+#include <poll.h>
+#include "HPTimestamp.h"
+
+namespace HPTimer
+{
+
+//! Deadline of HighPerTimer as a descriptor for epoll, poll or select
+/*!
+ * The timerfd is armed with the coarse part of the deadline, i.e. the busy-wait tail of the sleeps before it, so it gets
+ * readable shortly before the deadline. The event loop then calls Complete(), which busy-waits the rest on the timer counter.
+ * The timerfd counts relative to CLOCK_MONOTONIC, so the time source of HighPerTimer may be any.
+ * One descriptor shall be used by one thread only.
+ */
+class HPTimerFd
+{
+public:
+    /// create the non-blocking timerfd, it is not armed. IsOpen() tells if it could be created
+    HPTimerFd();
+
+    /// close the timerfd
+    ~HPTimerFd();
+
+    HPTimerFd ( const HPTimerFd & ) = delete;
+    HPTimerFd & operator= ( const HPTimerFd & ) = delete;
+
+    /// return true if the timerfd was created
+    inline bool IsOpen() const
+    {
+        return mFd >= 0;
+    };
+
+    /// get the descriptor to wait on for readability
+    inline int GetFd() const
+    {
+        return mFd;
+    };
+
+    /** arm the descriptor, a former deadline is replaced
+     * @param WakeTime is the deadline. A deadline in the busy-wait tail makes the descriptor readable at once
+     * @return false if the timerfd could not be set
+     */
+    bool Arm ( const HPTimestamp & WakeTime );
+
+    /** arm the descriptor for the deadline after the given time
+     * @param Duration is the time from now to the deadline
+     * @return false if the timerfd could not be set
+     */
+    bool Arm ( const HPDuration & Duration );
+
+    /// disarm the descriptor and discard an expiration, which was not completed
+    bool Disarm();
+
+    /// return true if a deadline is armed and not completed
+    inline bool IsArmed() const
+    {
+        return mArmed;
+    };
+
+    /// get the armed deadline
+    inline const HPTimestamp & GetWakeTime() const
+    {
+        return mWakeTime;
+    };
+
+    /** take the expiration after the descriptor got readable and busy-wait untill the deadline
+     * @return true if the deadline is reached, false if the descriptor has not expired, e.g. after a rearm, or is not armed
+     */
+    bool Complete();
+
+private:
+    /// descriptor of the timerfd, -1 if it could not be created
+    int mFd;
+
+    /// a deadline is armed
+    bool mArmed;
+
+    /// the armed deadline
+    HPTimestamp mWakeTime;
+
+    /// sleeper for the busy-wait of the rest
+    HPSleeper mSleeper;
+};
+
+} // namespace HPTimer
+#endif // _HPWAITABLE_H
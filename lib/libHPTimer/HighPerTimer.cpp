@@ -30,16 +30,25 @@
 #include <vector>
 #include <numeric>    
 #include <algorithm> 
+#include <cmath>
 #include <fstream>    
 #include <sys/resource.h> 
 #include <sys/time.h>    
 #include <thread>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
 #include <chrono>
-#include <condition_variable>
+#include <cerrno>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include "HighPerTimer.h"
+#include "HPTimestamp.h"
+#include "HPSleepProfile.h"
+#include "HPChrono.h"
 
 // type saver for big numbers
-constexpr double ONE_QUADRILLION = 1000000000000000.0; // C++ macro for one quadrillion ( 10^15 )
 constexpr uint64_t ONE_BILLION = 1000000000LL; // C++ macro for one billion ( 10^9 )
 constexpr uint64_t ONE_MILLION = 1000000LL; // C++ macro for one million ( 10^6 )
 
@@ -48,6 +57,32 @@ constexpr uint32_t HZ1000 = 1000;
 constexpr uint32_t HZ300 = 300;
 constexpr uint32_t HZ250 = 250;
 constexpr uint32_t HZ100 = 100;
+
+// period of the event stream of the Linux kernel for WFE on ARM, in nanoseconds
+constexpr int64_t EventStreamNSec = 100000;
+// nanoseconds before the wake up, which are spun after the waits of UMWAIT or MWAITX, more than their wake latency
+constexpr int64_t MonitorGuardNSec = 500;
+// remaining nanoseconds, above which UMWAIT may enter C0.2
+constexpr int64_t MonitorDeepNSec = 10000;
+// number of back-to-back stamps, of which the median is the overhead
+constexpr uint32_t OverheadSamples = 1024;
+// number of reads of a counter, which are timed together to measure the cost of one read
+constexpr uint32_t ReadCostBatch = 16;
+// number of batches of reads of each candidate, which the benchmark of the time source keeps at most
+constexpr uint32_t SelectionBatches = 64;
+// cost in nanoseconds of one read, above which a read of the TSC is taken as trapped, if the OS timer is cheaper
+constexpr double TrapReadNSec = 100;
+// relative difference of the read costs of HPET and the OS timer, below which the spread decides
+constexpr double SimilarCost = 0.25;
+// clocksource of the kernel and the ones, which it does not consider unstable
+constexpr char CurrentClocksourcePath[] = "/sys/devices/system/clocksource/clocksource0/current_clocksource";
+constexpr char AvailableClocksourcePath[] = "/sys/devices/system/clocksource/clocksource0/available_clocksource";
+// number of reads of CLOCK_MONOTONIC_RAW, from which the one with the narrowest bracket of counter reads is taken
+constexpr uint32_t RawSampleAttempts = 16;
+// time in seconds of the measurement, against which the frequency reported by the platform is checked
+constexpr double ReportedCheckTime = 0.002;
+// relative deviation of the reported frequency from the measured one, up to which the reported one is taken
+constexpr double ReportedTolerance = 0.01;
  
 
 namespace HPTimer
@@ -60,24 +95,50 @@ HighPerTimer HighPerTimer::HPTimer_MIN;
 static HPTimerInitAndClean the_HPTimerInitAndClean;
 
 TimeSource HighPerTimer::HPTimerSource;
-int64_t HighPerTimer::TicsPerUsec;
-double HighPerTimer::NsecPerTic;
-int64_t HighPerTimer::UnixZeroShift;
-double HighPerTimer::HPJiffies;
-
-// variables for implementing the mechanism of sleep and interruption 
-std::condition_variable HPcond;
-std::mutex HPmutex;
-
-// counter of the number of failures during initializing frequency InitHPFrequency(). 
-// if the first attempt to initialize frequency was failed, we do reinitialize and recursion.
-// recursion is allowed to do only three times, after that abort with error.
-uint32_t InitFreqAttempt(0);
+TicsReader HighPerTimer::HPTicsReader;
+// a read before the initialization initializes the timer
+int64_t ( *HighPerTimer::ReadTics ) () ( &HighPerTimer::LazyTics );
+std::atomic<int64_t> HighPerTimer::TicsPerUsec;
+std::atomic<double> HighPerTimer::NsecPerTic;
+std::atomic<uint32_t> HighPerTimer::ConversionSeq ( 0 );
+std::atomic<uint64_t> HighPerTimer::NSecMult;
+std::atomic<uint32_t> HighPerTimer::NSecShift;
+std::atomic<uint64_t> HighPerTimer::TicsMult;
+std::atomic<uint32_t> HighPerTimer::TicsShift;
+std::atomic<int64_t> HighPerTimer::UnixZeroShift;
+std::atomic<int64_t> HighPerTimer::MaxTics;
+std::atomic<int64_t> HighPerTimer::MinTics;
+std::atomic<uint64_t> HighPerTimer::MaxNSec;
+int64_t HighPerTimer::StampOverhead ( 0 );
+int64_t HighPerTimer::ReadOverhead ( 0 );
+std::atomic<double> HighPerTimer::HPJiffies;
+SleepMode HighPerTimer::HPSleepMode;
+std::atomic<int64_t> HighPerTimer::BusyWaitNSec;
+bool HighPerTimer::MonitorWait ( false );
+std::atomic<bool> HighPerTimer::Initialized ( false );
+constexpr bool HPClock::is_steady;
+
+void ThrowOverflow()
+{
+    throw  std::out_of_range ( "HPTimer overflow" );
+}
+
+// guards the initialization, it is done by the first thread only
+static std::once_flag InitFlag;
+
+// the calling thread runs InitAll(), its conversions must not start the initialization again
+static thread_local bool Initializing ( false );
 
 // busy waiting. 
 static inline void RepNop ( void )
 {
-#ifdef __arm__ 
+#if defined ( __aarch64__ )
+// the hint of AArch64 for spin loops, it yields the pipeline to another hardware thread of the core
+    asm volatile
+    ( 
+        "yield"
+    );
+#elif defined ( __arm__ ) 
 // This is ARM assembly code which is preferred architecture
     asm volatile
     ( 
@@ -92,12 +153,29 @@ static inline void RepNop ( void )
 #endif
 }
 
-// standard ctor
-// set tics of HPTimer equal to zero in lazy behavior
-HighPerTimer::HighPerTimer() :
-        mHPTics ( 0 ),
-        mNormalized ( false )
+// convert an amount of seconds, microseconds or nanoseconds into tics
+// @param Units is the amount which should be converted
+// @param NSecPerUnit is the number of nanoseconds within one unit
+// @return tics, saturated to the max value of int64, if the nanoseconds do not fit into int64
+static inline int64_t UnitstoTics ( const uint64_t Units, const uint64_t NSecPerUnit )
+{
+    if ( Units > static_cast<uint64_t> ( INT64_MAX ) / NSecPerUnit )
+    {
+        return INT64_MAX;
+    }
+    return HighPerTimer::NSectoTic ( static_cast<int64_t> ( Units * NSecPerUnit ) );
+}
+
+// find the fixed-point pair for the given ratio: the largest shift, for which the multiplier keeps 63 significant bits
+// @param Ratio is the conversion factor which is approximated as Mult / 2^Shift
+static void FixedPointPair ( const long double Ratio, uint64_t & Mult, uint32_t & Shift )
 {
+    Shift = 0;
+    while ( ( Shift < 127 ) && ( ldexpl ( Ratio, Shift + 1 ) < 9223372036854775808.0L ) )
+    {
+        Shift++;
+    }
+    Mult = static_cast<uint64_t> ( ldexpl ( Ratio, Shift ) + 0.5L );
 }
 
 // ctor
@@ -112,6 +190,7 @@ HighPerTimer::HighPerTimer ( int64_t Seconds, int64_t NSeconds, bool Sign ) :
         mSign ( Sign ),
         mNormalized ( true )
 {
+    HighPerTimer::EnsureInitialized();
     // when one of the ints is negative, than sign must be false. Otherwise we have an illegal initialitazion values.
     if ( ( Seconds < 0 || NSeconds < 0 ) && true == Sign )
     {
@@ -144,20 +223,16 @@ HighPerTimer::HighPerTimer ( int64_t Seconds, int64_t NSeconds, bool Sign ) :
     mNSeconds = NSeconds % ONE_BILLION;
 
     // check for possible overflow according to max and min value HPTimer
-    if ( ( mSeconds * ONE_BILLION + mNSeconds ) > ( HighPerTimer::HPTimer_MAX.Seconds() * ONE_BILLION + HighPerTimer::HPTimer_MAX.NSeconds() ) )
+    if ( ( mSeconds * ONE_BILLION + mNSeconds ) > HighPerTimer::MaxNSec.load ( std::memory_order_relaxed ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
 
+    // the range is already checked in nanoseconds, so keep rounding of the last tic within the max value
+    mHPTics = std::min ( HighPerTimer::NSectoTic ( mSeconds * ONE_BILLION + mNSeconds ), HighPerTimer::MaxHPTics() );
     if ( mSign )
     {
-        // increase a little bit NsecPerTic to avoid overflow in case we calcukate max value with TSC source
-        mHPTics = - ( static_cast<int64_t> ( ( mSeconds * ONE_BILLION + mNSeconds ) / ( HighPerTimer::NsecPerTic + ( 1/ONE_QUADRILLION ) ) ) );
-    }
-    else
-    {
-        // increase a little bit NsecPerTic to avoid overflow in case we calcukate max value with TSC source
-        mHPTics = static_cast<int64_t> ( ( mSeconds * ONE_BILLION + mNSeconds ) / ( HighPerTimer::NsecPerTic + ( 1/ONE_QUADRILLION ) ) );
+        mHPTics = -mHPTics;
     }
 }
 
@@ -170,11 +245,15 @@ HighPerTimer::HighPerTimer ( int64_t HPTics, bool Shift ) :
         mHPTics ( HPTics ),
         mNormalized ( false )
 {
+    HighPerTimer::EnsureInitialized();
     if ( Shift )
     {
-        if ( ( HighPerTimer::HPTimer_MAX.HPTics() - HighPerTimer::UnixZeroShift  >= mHPTics ) && ( HighPerTimer::HPTimer_MIN.HPTics() + HighPerTimer::UnixZeroShift  <= mHPTics ) )
+        // the shift is negative for a clock ahead of CLOCK_REALTIME, e.g. CLOCK_TAI, so the check depends on its sign
+        int64_t UnixShift ( HighPerTimer::GetUnixZeroShift() );
+        if ( ( UnixShift >= 0 ) ? ( HighPerTimer::MaxHPTics() - UnixShift >= mHPTics )
+                                : ( HighPerTimer::MinHPTics() - UnixShift <= mHPTics ) )
         {
-            mHPTics += HighPerTimer::UnixZeroShift;
+            mHPTics += UnixShift;
         }
         else
         {
@@ -183,7 +262,7 @@ HighPerTimer::HighPerTimer ( int64_t HPTics, bool Shift ) :
         }
     }
     // check for possible overflow according to max and min value HPTimer
-    if ( ( mHPTics > HighPerTimer::HPTimer_MAX.HPTics() ) || ( mHPTics < HighPerTimer::HPTimer_MIN.HPTics() ) )
+    if ( ( mHPTics > HighPerTimer::MaxHPTics() ) || ( mHPTics < HighPerTimer::MinHPTics() ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
@@ -207,12 +286,13 @@ HighPerTimer::HighPerTimer ( const timespec & TS ) :
         mSign ( false ),
         mNormalized ( true )
 {
+    HighPerTimer::EnsureInitialized();
     // check for possible overflow according to max and min value HPTimer
-    if ( ( mSeconds * ONE_BILLION + mNSeconds ) > ( HighPerTimer::HPTimer_MAX.Seconds() * ONE_BILLION + HighPerTimer::HPTimer_MAX.NSeconds() ) )
+    if ( ( mSeconds * ONE_BILLION + mNSeconds ) > HighPerTimer::MaxNSec.load ( std::memory_order_relaxed ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
-    mHPTics = static_cast<int64_t> ( ( mSeconds * ONE_BILLION + mNSeconds ) / ( HighPerTimer::NsecPerTic + ( 1/ONE_QUADRILLION ) ) );       
+    mHPTics = std::min ( HighPerTimer::NSectoTic ( mSeconds * ONE_BILLION + mNSeconds ), HighPerTimer::MaxHPTics() );
 }
 
 // copy ctor, use lazy assignment approach
@@ -232,100 +312,245 @@ HighPerTimer::HighPerTimer ( HighPerTimer && Timer ) :
 }
 
 // initialize Min and Max value of HPTimer
-// when HPET is timer source, the max possible value of NSecPerTic is 100 and it can be caused a possible overflow and a loss of accuracy calculating Seconds and NSeconds part of timer
-// so in HPET case it is more reliable to decrease limits for max and min HPTimer values
-// when TSC or OS clock are timer sources, the NSecPerTic value is always less than zero. So it is still safe to limit max and min HPTimer values within max and min values of int64 type
+// the limits are the tics, whose value in nanoseconds still fits into int64. Since the conversion is done in integers,
+// there is no loss of accuracy up to these limits.
+// when HPET is timer source, NSecPerTic is greater than one and the limits are decreased accordingly
+// when TSC or OS clock are timer sources, the NSecPerTic value is not greater than one. So the conversion saturates to max and min values of int64 type
 void HighPerTimer::InitMaxMinHPTimer()
 {
-    if ( TimeSource::HPET == HighPerTimer::HPTimerSource ) // HPET case
+    HighPerTimer::StoreRangeLimits();
+    HighPerTimer::HPTimer_MAX.SetTics ( HighPerTimer::MaxHPTics() );
+    HighPerTimer::HPTimer_MIN.SetTics ( HighPerTimer::MinHPTics() );
+}
+
+void HighPerTimer::StoreRangeLimits()
+{
+    int64_t Max ( HighPerTimer::NSectoTic ( std::numeric_limits<int64_t>::max() ) );
+    HighPerTimer::MaxTics.store ( Max, std::memory_order_relaxed );
+    HighPerTimer::MinTics.store ( HighPerTimer::NSectoTic ( std::numeric_limits<int64_t>::min() ), std::memory_order_relaxed );
+    HighPerTimer::MaxNSec.store ( static_cast<uint64_t> ( HighPerTimer::TictoNSec ( Max ) ), std::memory_order_relaxed );
+}
+// nanoseconds of CLOCK_MONOTONIC_RAW, the reference of the benchmarks
+static int64_t RawNSec()
+{
+    timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC_RAW, &ts );
+    return static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + ts.tv_nsec;
+}
+
+// benchmark of the reads of one candidate of the time source, the costs of its batches are kept in a fixed buffer
+struct ReadBench
+{
+    explicit ReadBench ( int64_t ( *ReadFunc ) () ) :
+            Read ( ReadFunc ),
+            Batches ( 0 ),
+            Backsteps ( 0 ),
+            Last ( ReadFunc() )
     {
-        HighPerTimer::HPTimer_MAX.SetTics ( std::numeric_limits<int64_t>::max() / 120 );
-        HighPerTimer::HPTimer_MIN.SetTics ( std::numeric_limits<int64_t>::min() / 120 );
     }
-    else
+
+    int64_t ( *Read ) ();
+    double Cost[SelectionBatches];
+    uint32_t Batches;
+    uint32_t Backsteps;
+    int64_t Last;
+};
+
+// time one batch of reads with CLOCK_MONOTONIC_RAW and count the reads, which step backwards
+static void BenchBatch ( ReadBench & Bench )
+{
+    int64_t Begin ( RawNSec() );
+    for ( uint32_t i ( 0 ); i < ReadCostBatch; ++i )
     {
-        HighPerTimer::HPTimer_MAX.SetTics ( std::numeric_limits<int64_t>::max() );
-        HighPerTimer::HPTimer_MIN.SetTics ( std::numeric_limits<int64_t>::min() );
+        int64_t Tics ( Bench.Read() );
+        Bench.Backsteps += ( Tics < Bench.Last ) ? 1 : 0;
+        Bench.Last = Tics;
     }
+    Bench.Cost[Bench.Batches++] = static_cast<double> ( RawNSec() - Begin ) / ReadCostBatch;
 }
-// initialize all kind of timer source and choose the most optimal.
-// @return current time source which obtains accurate tics value
-void HighPerTimer::InitTimerSource()
+
+// benchmark two candidates alternating, so they are compared under the same conditions, untill the buffers are full
+// or the budget is spent. The results are written to the candidates of the selection, the median is robust against
+// the batches, which were hit by an interrupt or a preemption
+static void BenchPair ( ReadBench & Bench1, SourceSelection::Candidate & Candidate1,
+                        ReadBench & Bench2, SourceSelection::Candidate & Candidate2, const double Budget )
+{
+    int64_t End ( RawNSec() + static_cast<int64_t> ( Budget * ONE_BILLION ) );
+    do
+    {
+        BenchBatch ( Bench1 );
+        BenchBatch ( Bench2 );
+    }
+    while ( ( Bench1.Batches < SelectionBatches ) && ( RawNSec() < End ) );
+
+    ReadBench * Benches[2] = { &Bench1, &Bench2 };
+    SourceSelection::Candidate * Candidates[2] = { &Candidate1, &Candidate2 };
+    for ( uint32_t i ( 0 ); i < 2; ++i )
+    {
+        ReadBench & Bench ( *Benches[i] );
+        std::sort ( Bench.Cost, Bench.Cost + Bench.Batches );
+        Candidates[i]->Batches = Bench.Batches;
+        Candidates[i]->ReadNSec = Bench.Cost[Bench.Batches / 2];
+        Candidates[i]->SpreadNSec = Bench.Cost[Bench.Batches * 3 / 4] - Bench.Cost[Bench.Batches / 4];
+        Candidates[i]->Backsteps = Bench.Backsteps;
+    }
+}
+
+// first line of a file of sysfs without the trailing white space, empty if it can not be read
+static std::string ReadSysLine ( const char * Path )
 {
-    uint32_t LoopCount ( 1000 );
-    int64_t HPtimerNow1 ( 0 ), HPtimerNow2 ( 0 );
-    double HPdelta ( 0 ), Percentage ( 0 );
-    // value of percents means a limit which is compared with Mean percentage
-    // to determine if mean values are "similar" or "different" and  deviation values should be also checked
-    double Limit (25.0);
+    std::ifstream File ( Path );
+    std::string Line;
+    std::getline ( File, Line );
+    Line.erase ( Line.find_last_not_of ( " \t\n" ) + 1 );
+    return Line;
+}
 
-    double MeanHpet ( 0 ), MeanOs ( 0 ), SqSum ( 0 ), StDevHpet ( 0 ), StDevOs ( 0 );  
-    std::vector <double> VecHpet, VecOs;
+// read the clocksources of the kernel into the selection, return false if the list of the available ones could not be read
+static bool ReadKernelClocksource ( SourceSelection & Selection )
+{
+    Selection.KernelClocksource = ReadSysLine ( CurrentClocksourcePath );
+    std::string Available ( ReadSysLine ( AvailableClocksourcePath ) );
+    Selection.KernelListsTSC = ( std::string::npos != ( " " + Available + " " ).find ( " tsc " ) );
+    return !Available.empty();
+}
 
-    // TSC is preferred timer, so we are checking it first
-    if ( TSCTimer::InitTSCTimer() )
+// the kernel checks the TSC against its watchdog and drops it from the list, if it is unstable.
+// A hypervisor often hides the invariant TSC, then its TSC is only trusted, when the kernel uses it
+std::string HighPerTimer::DistrustTSC ( const bool TSCAvailable )
+{
+    SourceSelection & Selection ( HighPerTimer::Selection() );
+    TSCTimer::GetHypervisor();
+    Selection.Hypervisor = TSCTimer::HasHypervisor;
+    Selection.HypervisorVendor = TSCTimer::HypervisorString;
+    bool KernelKnown ( ReadKernelClocksource ( Selection ) );
+    if ( !TSCAvailable )
     {
-        HighPerTimer::HPTimerSource =  TimeSource::TSC;
-        return;
+        return "no TSC with a constant rate";
+    }
+    if ( KernelKnown && !Selection.KernelListsTSC )
+    {
+        return "the kernel marked the TSC unstable";
     }
-    else if ( HPETTimer::InitHPETTimer() )
+    if ( Selection.Hypervisor && !TSCTimer::HasInvariantTSC && ( "tsc" != Selection.KernelClocksource ) )
     {
+        return "the TSC of the hypervisor is not invariant and the kernel does not use it";
+    }
+    return std::string();
+}
+
+SourceSelection & HighPerTimer::Selection()
+{
+    static SourceSelection TheSelection;
+    return TheSelection;
+}
+
+// initialize all kind of timer source and choose the most optimal.
+// The TSC is preferred, unless the kernel, the hypervisor or the benchmark of its reads tell, that it is not reliable
+// or not fast. Otherwise HPET and the OS timer are benchmarked against each other
+void HighPerTimer::InitTimerSource ( const double Budget )
+{
+    SourceSelection & Selection ( HighPerTimer::Selection() );
+    Selection = SourceSelection();
+    SourceSelection::Candidate & Tsc ( Selection.Candidates[static_cast<int> ( TimeSource::TSC )] );
+    SourceSelection::Candidate & Hpet ( Selection.Candidates[static_cast<int> ( TimeSource::HPET )] );
+    SourceSelection::Candidate & Os ( Selection.Candidates[static_cast<int> ( TimeSource::OS )] );
+    SourceSelection::Candidate & Arm ( Selection.Candidates[static_cast<int> ( TimeSource::ARM )] );
+    std::ostringstream Reason;
+
+    Tsc.Available = TSCTimer::InitTSCTimer();
+    std::string Distrust ( HighPerTimer::DistrustTSC ( Tsc.Available ) );
+    Os.Available = true;
+
+    // the generic timer is the counter of ARM, it has a constant frequency on every core
+    Arm.Available = ARMTimer::InitARMTimer();
+    if ( Arm.Available )
+    {
+        Selection.Chosen = HighPerTimer::HPTimerSource = TimeSource::ARM;
+        Selection.Reason = "the generic timer of ARM";
+        return;
+    }
 
-        // in case tsc unavailable, check which TimerSource setting costs more: hpet or clock_gettime. It is expected to be clock_gettime there
-        for ( uint32_t i ( 0 ); i < LoopCount; i++ )
+    if ( !Distrust.empty() )
+    {
+        Reason << Distrust;
+    }
+    else
+    {
+        ReadBench TscBench ( &TSCTimer::CPU_TSC ), OsBench ( &OSTimer::GetOSTimerTics );
+        BenchPair ( TscBench, Tsc, OsBench, Os, Budget / 2 );
+        if ( 0 != Tsc.Backsteps )
         {
-            HPtimerNow1 = HPETTimer::GetHPETTics();
-            HPtimerNow2 = HPETTimer::GetHPETTics();
-            HPdelta = HPtimerNow2 - HPtimerNow1;
-            VecHpet.push_back(( HPdelta / HPETTimer::GetHPETFrequency() ) );          
-
-            HPtimerNow1 = OSTimer::GetOSTimerTics();
-            HPtimerNow2 = OSTimer::GetOSTimerTics();
-            HPdelta = HPtimerNow2 - HPtimerNow1;
-            VecOs.push_back(( HPdelta / OSTimer::OSTimerFrequency ) );
+            Reason << "the TSC stepped backwards " << Tsc.Backsteps << " times";
         }
-
-        // sum up a range of elements, calculate mean value, express results in microseconds to compare
-        MeanOs = std::accumulate(VecOs.begin(), VecOs.end(), 0.0) / LoopCount;     
-        MeanHpet = std::accumulate(VecHpet.begin(), VecHpet.end(), 0.0) / LoopCount;
-      
-        // calculate percentage of mean values to compare
-        if ( MeanHpet < MeanOs )
+        // a read, which exits to the hypervisor or emulates RDTSC in the kernel, costs a microsecond, a native one some tens of nanoseconds
+        else if ( ( Tsc.ReadNSec > TrapReadNSec ) && ( Tsc.ReadNSec > Os.ReadNSec ) )
         {
-            Percentage = 100 - ( MeanHpet / MeanOs * 100 );
+            Reason << "the reads of the TSC trap, " << Tsc.ReadNSec << " ns against " << Os.ReadNSec << " ns of the OS timer";
         }
         else
         {
-            Percentage = 100 - ( MeanOs / MeanHpet * 100 );
-        }      
-      
-        // when the mean values are similar (the difference is no more than 25%), use standard deviation as a secondary parameter
-        if ( Percentage < Limit )
+            Selection.Chosen = HighPerTimer::HPTimerSource = TimeSource::TSC;
+            Reason << "TSC with " << Tsc.ReadNSec << " ns per read, the OS timer " << Os.ReadNSec << " ns";
+            Selection.Reason = Reason.str();
+            return;
+        }
+    }
+
+    Selection.Chosen = HighPerTimer::HPTimerSource = TimeSource::OS;
+    Hpet.Available = HPETTimer::InitHPETTimer();
+    if ( Hpet.Available )
+    {
+        // the one with the cheaper reads is taken. If the costs are similar, the more stable one
+        ReadBench HpetBench ( &HPETTimer::GetHPETTics ), OsBench ( &OSTimer::GetOSTimerTics );
+        BenchPair ( HpetBench, Hpet, OsBench, Os, Budget / 2 );
+        HPETTimer::ReadNSec = Hpet.ReadNSec;
+        OSTimer::ReadNSec = Os.ReadNSec;
+        bool Similar ( std::fabs ( Hpet.ReadNSec - Os.ReadNSec ) < SimilarCost * std::max ( Hpet.ReadNSec, Os.ReadNSec ) );
+        if ( ( 0 == Hpet.Backsteps ) && ( Similar ? ( Hpet.SpreadNSec < Os.SpreadNSec ) : ( Hpet.ReadNSec < Os.ReadNSec ) ) )
         {
-            SqSum = std::inner_product ( VecOs.begin(), VecOs.end(), VecOs.begin(), 0.0 );
-            StDevOs = std::sqrt ( SqSum / VecOs.size() - MeanOs * MeanOs );
-            SqSum = std::inner_product ( VecHpet.begin(), VecHpet.end(), VecHpet.begin(), 0.0 );
-            StDevHpet = std::sqrt ( SqSum / VecHpet.size() - MeanHpet * MeanHpet );
-           
-            if ( StDevHpet < StDevOs)
-            {
-                HighPerTimer::HPTimerSource =  TimeSource::HPET;
-                return;
-            }
-            else
-            {
-                HighPerTimer::HPTimerSource =  TimeSource::OS;
-                return;
-            }
+            Selection.Chosen = HighPerTimer::HPTimerSource = TimeSource::HPET;
         }
-        else if ( MeanHpet < MeanOs )
+        Reason << "; HPET with " << Hpet.ReadNSec << " ns per read, the OS timer " << Os.ReadNSec << " ns";
+    }
+    Reason << "; " << ( TimeSource::HPET == Selection.Chosen ? "HPET" : "the OS timer" ) << " is used";
+    Selection.Reason = Reason.str();
+}
+
+// read the counter and CLOCK_MONOTONIC_RAW at the same time. The clock read is bracketed by two counter reads,
+// the pair of the narrowest bracket of several attempts is taken, with the counter in the middle of the bracket
+static void RawClockSample ( int64_t ( *Tics ) (), int64_t & TicsAt, int64_t & NSecAt )
+{
+    int64_t Narrowest ( INT64_MAX );
+    for ( uint32_t i ( 0 ); i < RawSampleAttempts; ++i )
+    {
+        timespec ts;
+        int64_t Before ( Tics() );
+        clock_gettime ( CLOCK_MONOTONIC_RAW, &ts );
+        int64_t After ( Tics() );
+        if ( After - Before < Narrowest )
         {
-            HighPerTimer::HPTimerSource =  TimeSource::HPET;
-            return;
+            Narrowest = After - Before;
+            TicsAt = Before + Narrowest / 2;
+            NSecAt = static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( ts.tv_nsec );
         }
     }
-    HighPerTimer::HPTimerSource =  TimeSource::OS;
-    return;
+}
+
+// measure the nanoseconds per tic of the counter against CLOCK_MONOTONIC_RAW, which is never slewed by NTP.
+// The error is the width of the two brackets divided by the window, so a long window gives a precise value.
+// @return: 0 if the clock or the counter did not advance
+static double MeasureNsecPerTic ( int64_t ( *Tics ) (), const double Window )
+{
+    int64_t Tics1 ( 0 ), NSec1 ( 0 ), Tics2 ( 0 ), NSec2 ( 0 );
+    RawClockSample ( Tics, Tics1, NSec1 );
+    usleep ( static_cast<useconds_t> ( Window * ONE_MILLION ) );
+    RawClockSample ( Tics, Tics2, NSec2 );
+    if ( ( Tics2 <= Tics1 ) || ( NSec2 <= NSec1 ) )
+    {
+        return 0;
+    }
+    return static_cast<double> ( NSec2 - NSec1 ) / ( Tics2 - Tics1 );
 }
 
 // set the frequency and reciprocal value NsecPerTic depends on timer source
@@ -335,112 +560,107 @@ void HighPerTimer::InitHPFrequency( const double DelayTime )
     // TSC case
     if ( TimeSource::TSC == HighPerTimer::HPTimerSource ) 
     {
-        struct timesStruct
+        // the reported frequency is exact, only check it against a short measurement to reject bogus values of a hypervisor
+        double Reported ( TSCTimer::GetTSCFrequency() );
+        if ( Reported > 0 )
         {
-            int64_t TSC1,TSC2 ;
-	    double usFreq;            
-	    timespec ts1, ts2;	   
-        };
-	int64_t t1(0), t2(0);
-        long timeStructSize ( 5 );
-	
-        // perform frequency estimation 5 times,
-        timesStruct times[timeStructSize];
-        for ( uint32_t i ( 0 ); i < timeStructSize; i++ )
-        {     
-            clock_gettime ( CLOCK_REALTIME, &times[i].ts1 );
-            times[i].TSC1 = HighPerTimer::CPU_Tics ();
-            usleep ( DelayTime * ONE_MILLION );
-            clock_gettime ( CLOCK_REALTIME, &times[i].ts2 ); 
-	    times[i].TSC2 = HighPerTimer::CPU_Tics ();      
-	    t1 = static_cast<int64_t> ( times[i].ts1.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( times[i].ts1.tv_nsec );
-	    t2 = static_cast<int64_t> ( times[i].ts2.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( times[i].ts2.tv_nsec );    
-	                       
-	    if ( t1 != t2 )
+            double Measured ( MeasureNsecPerTic ( &HighPerTimer::CPU_Tics, ReportedCheckTime ) );
+            if ( ( Measured > 0 ) && ( std::abs ( Measured * Reported / 1000.0 - 1.0 ) < ReportedTolerance ) )
             {
-	        // nsec per tics
-                times[i].usFreq = static_cast<double> ( t2 - t1 ) / ( times[i].TSC2 - times[i].TSC1 ) ;
+                HighPerTimer::NsecPerTic.store ( 1000.0 / Reported, std::memory_order_relaxed );
+                HighPerTimer::TicsPerUsec.store ( static_cast<int64_t> ( round ( Reported ) ), std::memory_order_relaxed );
+                HighPerTimer::InitFixedPoint();
+                return;
             }
-            else
-            {
-                times[i].usFreq = 0;
-            }               
-        }            
-        
-        // write the field of struct with frequency to vector
-        std::vector <double> VecFreq;
-        for ( uint32_t i ( 0 ); i < timeStructSize; i++ )
-        {
-            VecFreq.push_back(times[i].usFreq);
         }
 
-        // calculate statistcs
-        double mean = std::accumulate(std::begin(VecFreq), std::end(VecFreq), 0.0) / VecFreq.size();
-        double accum = 0.0;
-        std::for_each (std::begin(VecFreq), std::end(VecFreq), [&](const double d) {
-            accum += (d - mean) * (d - mean);
-        });
-        double stdev = sqrt(accum / (VecFreq.size()-1));
-    
-	// exlude peak
-	uint32_t peak(0);
-        for ( std::vector<double>::iterator it = VecFreq.begin(); it != VecFreq.end();)
+        // calibrate over the whole delay time of the former five measurements
+        TSCTimer::FreqOrigin = TSCFreqOrigin::Measured;
+        double Measured ( MeasureNsecPerTic ( &HighPerTimer::CPU_Tics, 5 * DelayTime ) );
+        if ( !( Measured > 0 ) )
         {
-            // if this is the first peak in range, no peaks were found before
-            if (peak < 1)
-            { 
-                // Grubb's Test for outliers. Factor 1,7885 was chosen exactly for 5 iterations      
-                if ( std::abs(mean - *it) > ( stdev * 1.7885 ) )
-	        {                    
-                    ++peak;
-                    VecFreq.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-            // if more than one peak, abort or reinitialize
-            else
-            { 
-	        // stop, after three attepmt to initilize frequency
-	        if (InitFreqAttempt < 3)
-                {
-                    InitFreqAttempt++;
-		    // recursion is allowed only 3 times
-                    return HighPerTimer::InitHPFrequency( DelayTime );
-                }
-                else
-                {
-                    std::cerr << "TSC frequency can not be defined! Initialize process of libHPTimer was aborted!"<< std::endl;
-                    throw std::exception();    
-                    return;                   
-                }
-            }
-        }        
-       
-        HighPerTimer::NsecPerTic = mean;
-        HighPerTimer::TicsPerUsec = static_cast<uint64_t>( round  ( 1000.0 / mean ) );
-	return;
-
+            // the raw clock does not advance, keep at least a sane value instead of aborting the process
+            Measured = 1.0;
+        }
+        HighPerTimer::NsecPerTic.store ( Measured, std::memory_order_relaxed );
+        HighPerTimer::TicsPerUsec.store ( static_cast<int64_t> ( round ( 1000.0 / Measured ) ), std::memory_order_relaxed );
+        HighPerTimer::InitFixedPoint();
+        return;
+    }
+    else if ( TimeSource::ARM == HighPerTimer::HPTimerSource )
+    {
+        // the frequency of the generic timer is given by CNTFRQ_EL0, no calibration is needed
+        HighPerTimer::NsecPerTic.store ( static_cast<double> ( ONE_BILLION ) / ARMTimer::Frequency, std::memory_order_relaxed );
+        HighPerTimer::TicsPerUsec.store ( static_cast<int64_t> ( round ( ARMTimer::Frequency / 1e6 ) ), std::memory_order_relaxed );
+        HighPerTimer::InitFixedPoint();
+        return;
     }
     else if ( TimeSource::HPET == HighPerTimer::HPTimerSource )
     {
         // TmpFreq still keeps double value of Frequency
         // needs not to call GetHPETFrequency function twice and not to open device twice
         double TmpFreq = HPETTimer::GetHPETFrequency();
-        HighPerTimer::NsecPerTic = 1000.0 / TmpFreq;
-        HighPerTimer::TicsPerUsec = static_cast<int64_t> ( TmpFreq );
+        HighPerTimer::NsecPerTic.store ( 1000.0 / TmpFreq, std::memory_order_relaxed );
+        HighPerTimer::TicsPerUsec.store ( static_cast<int64_t> ( TmpFreq ), std::memory_order_relaxed );
+        HighPerTimer::InitFixedPoint();
         return;
     }
     else
     {
-        HighPerTimer::NsecPerTic =  1000.0 / OSTimer::OSTimerFrequency;
-        HighPerTimer::TicsPerUsec = OSTimer::OSTimerFrequency;
+        HighPerTimer::NsecPerTic.store ( 1000.0 / OSTimer::OSTimerFrequency, std::memory_order_relaxed );
+        HighPerTimer::TicsPerUsec.store ( OSTimer::OSTimerFrequency, std::memory_order_relaxed );
+        HighPerTimer::InitFixedPoint();
         return;
     }
 }
 
+// median of back-to-back stamps and reads, the first round warms up the caches and the branch predictors
+void HighPerTimer::InitStampOverhead()
+{
+    std::vector<int64_t> Stamps ( OverheadSamples ), Reads ( OverheadSamples );
+    for ( uint32_t Round ( 0 ); Round < 2; ++Round )
+    {
+        for ( uint32_t i ( 0 ); i < OverheadSamples; ++i )
+        {
+            int64_t Start ( HighPerTimer::ReadStartStamp() );
+            Stamps[i] = HighPerTimer::StopStamp() - Start;
+            int64_t First ( HighPerTimer::GetTimerTics() );
+            Reads[i] = HighPerTimer::GetTimerTics() - First;
+        }
+    }
+    std::nth_element ( Stamps.begin(), Stamps.begin() + OverheadSamples / 2, Stamps.end() );
+    std::nth_element ( Reads.begin(), Reads.begin() + OverheadSamples / 2, Reads.end() );
+    HighPerTimer::StampOverhead = Stamps[OverheadSamples / 2];
+    HighPerTimer::ReadOverhead = Reads[OverheadSamples / 2];
+}
+
+// compute the fixed-point pairs for the conversion between tics and nanoseconds from NsecPerTic
+void HighPerTimer::InitFixedPoint()
+{
+    uint64_t NMult, TMult;
+    uint32_t NShift, TShift;
+    double NsecPerTic ( HighPerTimer::NsecPerTic.load ( std::memory_order_relaxed ) );
+    FixedPointPair ( NsecPerTic, NMult, NShift );
+    FixedPointPair ( 1.0L / NsecPerTic, TMult, TShift );
+    HighPerTimer::StoreFixedPoint ( NMult, NShift, TMult, TShift );
+}
+
+// the odd sequence number is taken by a compare and swap, so it locks out the other writers as well
+void HighPerTimer::StoreFixedPoint ( const uint64_t NMult, const uint32_t NShift, const uint64_t TMult, const uint32_t TShift )
+{
+    uint32_t Seq ( HighPerTimer::ConversionSeq.load ( std::memory_order_relaxed ) );
+    while ( ( Seq & 1 ) || !HighPerTimer::ConversionSeq.compare_exchange_weak ( Seq, Seq + 1, std::memory_order_relaxed ) )
+    {
+        Seq = HighPerTimer::ConversionSeq.load ( std::memory_order_relaxed );
+    }
+    std::atomic_thread_fence ( std::memory_order_release );
+    HighPerTimer::NSecMult.store ( NMult, std::memory_order_relaxed );
+    HighPerTimer::NSecShift.store ( NShift, std::memory_order_relaxed );
+    HighPerTimer::TicsMult.store ( TMult, std::memory_order_relaxed );
+    HighPerTimer::TicsShift.store ( TShift, std::memory_order_relaxed );
+    HighPerTimer::ConversionSeq.store ( Seq + 2, std::memory_order_release );
+}
+
 
 
 // initialize the value of jiffies depends on the clock interrupt frequency of the particular hardware platform
@@ -473,7 +693,7 @@ void HighPerTimer::InitSecPerJiffy()
     {
         // return resource usage statistics for the calling process - sleep for 14500 usec
         getrusage(RUSAGE_THREAD, &ru1);
-        Target = HighPerTimer::GetTimerTics() + ( SleepTime / ( HighPerTimer::NsecPerTic / 1000LL ) ) ;
+        Target = HighPerTimer::GetTimerTics() + HighPerTimer::NSectoTic ( SleepTime * 1000LL );
         while ( HighPerTimer::GetTimerTics() < Target )
         {
             RepNop();
@@ -492,7 +712,7 @@ void HighPerTimer::InitSecPerJiffy()
             count100++;
             if ( count100 == 2)
             {
-                HighPerTimer::HPJiffies = HZ100Jiffies;
+                HighPerTimer::HPJiffies.store ( HZ100Jiffies, std::memory_order_relaxed );
                 return;
             }
         }
@@ -501,7 +721,7 @@ void HighPerTimer::InitSecPerJiffy()
             count250++;
             if ( count250 == 2)
             {
-                HighPerTimer::HPJiffies = HZ250Jiffies;
+                HighPerTimer::HPJiffies.store ( HZ250Jiffies, std::memory_order_relaxed );
                 return;
             }
         }
@@ -510,7 +730,7 @@ void HighPerTimer::InitSecPerJiffy()
             count300++;
             if ( count300 == 2)
             {
-                HighPerTimer::HPJiffies = HZ300Jiffies;
+                HighPerTimer::HPJiffies.store ( HZ300Jiffies, std::memory_order_relaxed );
                 return;
             }
         }
@@ -519,48 +739,314 @@ void HighPerTimer::InitSecPerJiffy()
             count1000++;
             if ( count1000 == 2)
             {
-                HighPerTimer::HPJiffies = HZ1000Jiffies;
+                HighPerTimer::HPJiffies.store ( HZ1000Jiffies, std::memory_order_relaxed );
                 return;
             }
         }
     } // end of the loop
 
     // in the case, when none of the HZ frequencies was detected, choose HZ 250 
-    HighPerTimer::HPJiffies = HZ250Jiffies;	
+    HighPerTimer::HPJiffies.store ( HZ250Jiffies, std::memory_order_relaxed );	
     return;
 }
 
 
-// get tics of the appropriate timer
-int64_t HighPerTimer::GetTimerTics()
+// histogram of the wakeup overshoot of the OS wait. The buckets are logarithmic with four buckets per power of two,
+// so the p99 is known with an error of less than 25%. The counts are halved on every update, so old samples fade away
+constexpr uint32_t OvershootBuckets = 160;
+
+// number of accounted waits of a thread between its updates of the busy-wait tail
+constexpr uint32_t OvershootUpdate = 256;
+
+// number and duration of OS waits, measured at initialization
+constexpr uint32_t CalibrationWaits = 64;
+constexpr int64_t CalibrationWaitNSec = 50000;
+
+// number and duration of the short OS waits of ProbeBusyWait()
+constexpr uint32_t ProbeWaits = 16;
+constexpr int64_t ProbeWaitNSec = 10000;
+
+// overshoot counts of one thread, written by its thread only, so they are incremented by a plain load and store.
+// The counts only grow, the update takes their increase since its last merge. A slot is taken over by a new thread
+// after its thread has exited
+struct ThreadOvershoot
+{
+    std::atomic<uint32_t> mCounts[OvershootBuckets];
+    uint32_t mMerged[OvershootBuckets];
+    uint32_t mSamples;
+    bool mInUse;
+
+    ThreadOvershoot() :
+            mSamples ( 0 ),
+            mInUse ( true )
+    {
+        for ( uint32_t i = 0; i < OvershootBuckets; ++i )
+        {
+            mCounts[i].store ( 0, std::memory_order_relaxed );
+            mMerged[i] = 0;
+        }
+    }
+
+    // the increase of the counts since the last merge, the differences hold across a wrap of the counters
+    void MergeTo ( uint64_t * Histogram )
+    {
+        for ( uint32_t i = 0; i < OvershootBuckets; ++i )
+        {
+            uint32_t Count ( mCounts[i].load ( std::memory_order_relaxed ) );
+            Histogram[i] += Count - mMerged[i];
+            mMerged[i] = Count;
+        }
+    }
+};
+
+// the counts of all threads and the merged histogram, protected by one mutex. A sleep takes the lock for the update
+// only if it is free, as the update by another thread merges its counts as well
+struct OvershootRegistry
+{
+    std::mutex mMutex;
+    std::vector<ThreadOvershoot *> mThreads;
+    uint64_t mHistogram[OvershootBuckets];
+};
+
+static OvershootRegistry & Overshoots()
+{
+    // leaked on purpose: the OvershootOwner of a thread, which exits after main() has returned, still takes its mutex
+    static OvershootRegistry * Instance ( new OvershootRegistry() );
+    return *Instance;
+}
+
+// releases the counts of the thread on its exit, the next update still merges them
+struct OvershootOwner
+{
+    ThreadOvershoot * mCounts = nullptr;
+
+    ~OvershootOwner()
+    {
+        if ( !mCounts )
+        {
+            return;
+        }
+        OvershootRegistry & Reg ( Overshoots() );
+        std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+        mCounts->mInUse = false;
+    }
+};
+
+static thread_local OvershootOwner LocalOvershoot;
+
+static ThreadOvershoot & LocalOvershootCounts()
+{
+    if ( !LocalOvershoot.mCounts )
+    {
+        OvershootRegistry & Reg ( Overshoots() );
+        std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+        for ( ThreadOvershoot * Counts : Reg.mThreads )
+        {
+            if ( !Counts->mInUse )
+            {
+                Counts->mInUse = true;
+                LocalOvershoot.mCounts = Counts;
+                break;
+            }
+        }
+        if ( !LocalOvershoot.mCounts )
+        {
+            LocalOvershoot.mCounts = new ThreadOvershoot;
+            Reg.mThreads.push_back ( LocalOvershoot.mCounts );
+        }
+    }
+    return *LocalOvershoot.mCounts;
+}
+
+// bucket of the overshoot histogram
+static inline uint32_t OvershootBucket ( const uint64_t NSeconds )
+{
+    if ( NSeconds < 8 )
+    {
+        return static_cast<uint32_t> ( NSeconds );
+    }
+    uint32_t Msb ( 63 - __builtin_clzll ( NSeconds ) );
+    uint32_t Bucket ( 4 * Msb + ( ( NSeconds >> ( Msb - 2 ) ) & 3 ) );
+    return std::min ( Bucket, OvershootBuckets - 1 );
+}
+
+// upper edge of the bucket in nanoseconds
+static inline int64_t OvershootBucketEdge ( const uint32_t Bucket )
+{
+    if ( Bucket < 8 )
+    {
+        return Bucket + 1;
+    }
+    return static_cast<int64_t> ( 5 + ( Bucket & 3 ) ) << ( Bucket / 4 - 2 );
+}
+
+// merge the counts of the threads, set the busy-wait tail to the p99 of the histogram, but not longer than one jiffy,
+// and halve the merged counts. The mutex of the registry is held by the caller
+static void UpdateBusyWait ( OvershootRegistry & Reg, std::atomic<int64_t> & BusyWait, const double Jiffies )
+{
+    for ( ThreadOvershoot * Counts : Reg.mThreads )
+    {
+        Counts->MergeTo ( Reg.mHistogram );
+    }
+    uint64_t Total ( 0 );
+    for ( uint32_t i = 0; i < OvershootBuckets; ++i )
+    {
+        Total += Reg.mHistogram[i];
+    }
+    if ( 0 == Total )
+    {
+        return;
+    }
+    uint64_t Rank ( Total - Total / 100 );
+    uint64_t Sum ( 0 );
+    uint32_t Bucket ( 0 );
+    for ( ; Bucket < OvershootBuckets - 1; ++Bucket )
+    {
+        Sum += Reg.mHistogram[Bucket];
+        if ( Sum >= Rank )
+        {
+            break;
+        }
+    }
+    for ( uint32_t i = 0; i < OvershootBuckets; ++i )
+    {
+        Reg.mHistogram[i] /= 2;
+    }
+    BusyWait.store ( std::min ( OvershootBucketEdge ( Bucket ), static_cast<int64_t> ( Jiffies * ONE_BILLION ) ), std::memory_order_relaxed );
+}
+
+// overshoots of Count futex waits of WaitNSec each, nobody wakes up. They are added to the merged histogram directly
+static void MeasureOvershoot ( OvershootRegistry & Reg, const uint32_t Count, const int64_t WaitNSec )
+{
+    std::atomic<int> Word ( 0 );
+    struct timespec Timeout;
+    Timeout.tv_sec = 0;
+    Timeout.tv_nsec = WaitNSec;
+    for ( uint32_t i = 0; i < Count; ++i )
+    {
+        HPTimestamp Before ( HPTimestamp::Now() );
+        syscall ( SYS_futex, reinterpret_cast<int *> ( &Word ), FUTEX_WAIT_PRIVATE, 0, &Timeout, NULL, 0 );
+        int64_t Overshoot ( HighPerTimer::TictoNSec ( ( HPTimestamp::Now() - Before ).HPTics() ) - WaitNSec );
+        if ( Overshoot >= 0 )
+        {
+            ++Reg.mHistogram[OvershootBucket ( Overshoot )];
+        }
+    }
+}
+
+// change the way the busy-wait tail of the sleeps is chosen
+void HighPerTimer::SetSleepMode ( const SleepMode Mode )
+{
+    if ( SleepMode::Adaptive == Mode )
+    {
+        HighPerTimer::InitBusyWait();
+        return;
+    }
+    HighPerTimer::HPSleepMode = SleepMode::Jiffies;
+    HighPerTimer::BusyWaitNSec.store ( static_cast<int64_t> ( HighPerTimer::HPJiffies.load ( std::memory_order_relaxed ) * ONE_BILLION ), std::memory_order_relaxed );
+}
+
+// measure the overshoot of short futex waits. The merged histogram starts with them, the counts of the threads
+// so far are taken as merged
+void HighPerTimer::InitBusyWait()
+{
+    HighPerTimer::HPSleepMode = SleepMode::Adaptive;
+    HighPerTimer::BusyWaitNSec.store ( static_cast<int64_t> ( HighPerTimer::HPJiffies.load ( std::memory_order_relaxed ) * ONE_BILLION ), std::memory_order_relaxed );
+    OvershootRegistry & Reg ( Overshoots() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    for ( ThreadOvershoot * Counts : Reg.mThreads )
+    {
+        Counts->MergeTo ( Reg.mHistogram );
+    }
+    for ( uint32_t i = 0; i < OvershootBuckets; ++i )
+    {
+        Reg.mHistogram[i] = 0;
+    }
+    MeasureOvershoot ( Reg, CalibrationWaits, CalibrationWaitNSec );
+    UpdateBusyWait ( Reg, HighPerTimer::BusyWaitNSec, HighPerTimer::HPJiffies.load ( std::memory_order_relaxed ) );
+}
+
+// the waits are short against the calibration, so a tail longer than the current overshoot shrinks after a few probes
+void HighPerTimer::ProbeBusyWait()
+{
+    if ( SleepMode::Adaptive != HighPerTimer::HPSleepMode )
+    {
+        return;
+    }
+    HighPerTimer::EnsureInitialized();
+    OvershootRegistry & Reg ( Overshoots() );
+    std::lock_guard<std::mutex> Lock ( Reg.mMutex );
+    MeasureOvershoot ( Reg, ProbeWaits, ProbeWaitNSec );
+    UpdateBusyWait ( Reg, HighPerTimer::BusyWaitNSec, HighPerTimer::HPJiffies.load ( std::memory_order_relaxed ) );
+}
+
+// account the overshoot of one OS wait of a sleep. Negative values come from signals and spurious wakeups and are ignored
+void HighPerTimer::AddWakeupOvershoot ( const int64_t NSeconds )
+{
+    if ( ( NSeconds < 0 ) || ( SleepMode::Adaptive != HighPerTimer::HPSleepMode ) )
+    {
+        return;
+    }
+    ThreadOvershoot & Counts ( LocalOvershootCounts() );
+    std::atomic<uint32_t> & Counter ( Counts.mCounts[OvershootBucket ( NSeconds )] );
+    Counter.store ( Counter.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    if ( 0 == ++Counts.mSamples % OvershootUpdate )
+    {
+        OvershootRegistry & Reg ( Overshoots() );
+        std::unique_lock<std::mutex> Lock ( Reg.mMutex, std::try_to_lock );
+        if ( Lock.owns_lock() )
+        {
+            UpdateBusyWait ( Reg, HighPerTimer::BusyWaitNSec, HighPerTimer::HPJiffies.load ( std::memory_order_relaxed ) );
+        }
+    }
+}
+
+// resolve the reader of the appropriate timer once, so GetTimerTics() does not branch on every call
+void HighPerTimer::InitTicsReader()
 {
     if ( TimeSource::TSC == HighPerTimer::HPTimerSource )
     {
-        return TSCTimer::CPU_TSC();
+        if ( HighPerTimer::TSCSkewCorrected )
+        {
+            HighPerTimer::HPTicsReader = TicsReader::RDTSCPOffset;
+            HighPerTimer::ReadTics = &HighPerTimer::ReaderTics<TicsReader::RDTSCPOffset>;
+        }
+        else if ( TSCTimer::HasRDTSCPinst )
+        {
+            HighPerTimer::HPTicsReader = TicsReader::RDTSCP;
+            HighPerTimer::ReadTics = &HighPerTimer::ReaderTics<TicsReader::RDTSCP>;
+        }
+        else
+        {
+            HighPerTimer::HPTicsReader = TicsReader::RDTSC;
+            HighPerTimer::ReadTics = &HighPerTimer::ReaderTics<TicsReader::RDTSC>;
+        }
+    }
+    else if ( TimeSource::ARM == HighPerTimer::HPTimerSource )
+    {
+        HighPerTimer::HPTicsReader = TicsReader::CNTVCT;
+        HighPerTimer::ReadTics = &HighPerTimer::ReaderTics<TicsReader::CNTVCT>;
     }
     else if ( TimeSource::HPET == HighPerTimer::HPTimerSource )
     {
-        return HPETTimer::GetHPETTics();
+        HighPerTimer::HPTicsReader = TicsReader::HPET;
+        HighPerTimer::ReadTics = &HighPerTimer::ReaderTics<TicsReader::HPET>;
     }
     else
     {
-        return OSTimer::GetOSTimerTics();
+        HighPerTimer::HPTicsReader = TicsReader::OS;
+        HighPerTimer::ReadTics = &HighPerTimer::ReaderTics<TicsReader::OS>;
     }
 }
 
 // get the HighPerTimer counter offset against the Unix Zero Time
 void HighPerTimer::InitUnixZeroShift()
 {
-    // have Unix offset equall zero if it is OS Timer Source
-    if ( TimeSource::OS == HighPerTimer::HPTimerSource )
-    {
-        HighPerTimer::UnixZeroShift = 0;
-        return;
-    }
-           
+    // also the clocks of the OS source are shifted, so the timer reads the time since Unix zero with each source
     timespec ts;
     clock_gettime ( CLOCK_REALTIME, &ts );
-    HighPerTimer::UnixZeroShift = ( static_cast<int64_t> ( ( static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( ts.tv_nsec ) ) / HighPerTimer::NsecPerTic ) )- HighPerTimer::GetTimerTics();
+    HighPerTimer::UnixZeroShift.store ( HighPerTimer::NSectoTic ( static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( ts.tv_nsec ) )
+                                        - HighPerTimer::GetTimerTics(), std::memory_order_relaxed );
            
     return;
 }
@@ -573,13 +1059,15 @@ void HighPerTimer::Normalize() const
     {
         return;
     }
+    HighPerTimer::EnsureInitialized();
     // most significant bit represents the sign
     mSign =  mHPTics >> 63;
-    int64_t toNSecs ( static_cast<int64_t> ( mHPTics * HighPerTimer::NsecPerTic ) );
-    if ( toNSecs >> 63 )
-    {
-        toNSecs = std::abs ( toNSecs );
-    }
+    // convert the magnitude, so the min value of int64 is handled as well
+    uint64_t AbsTics ( mSign ? 0 - static_cast<uint64_t> ( mHPTics ) : static_cast<uint64_t> ( mHPTics ) );
+    uint64_t Mult;
+    uint32_t Shift;
+    HighPerTimer::LoadPair ( HighPerTimer::NSecMult, HighPerTimer::NSecShift, Mult, Shift );
+    uint64_t toNSecs ( HighPerTimer::MulShift ( AbsTics, Mult, Shift ) );
     mSeconds = toNSecs / ONE_BILLION;
     mNSeconds = toNSecs % ONE_BILLION;
     mNormalized = true;
@@ -601,6 +1089,13 @@ TimeSource HighPerTimer::SetTimerSource ( const TimeSource UserSource )
             return HighPerTimer::HPTimerSource;
         }
     }
+    else if ( TimeSource::ARM == UserSource )
+    {
+        if ( !ARMTimer::InitARMTimer() )
+        { // not able to initialize the generic timer. Fallback to old time source
+            return HighPerTimer::HPTimerSource;
+        }
+    }
     else if ( TimeSource::HPET == UserSource )
     {
         if ( !HPETTimer::InitHPETTimer() )
@@ -609,12 +1104,30 @@ TimeSource HighPerTimer::SetTimerSource ( const TimeSource UserSource )
         }
     }
     HighPerTimer::HPTimerSource = UserSource;
+    HighPerTimer::InitTicsReader();
     HighPerTimer::InitHPFrequency( 0.02 ) ;
     HighPerTimer::InitUnixZeroShift();
     HighPerTimer::InitMaxMinHPTimer();
+    HighPerTimer::InitStampOverhead();
     return HighPerTimer::HPTimerSource;
 }
 
+// changes the clock of the OS source. Only before determining the main routine!
+bool HighPerTimer::SetOSClock ( const OSClock Clock )
+{
+    if ( !OSTimer::InitOSTimer ( Clock ) )
+    {
+        return false;
+    }
+    if ( TimeSource::OS == HighPerTimer::HPTimerSource )
+    {
+        HighPerTimer::InitUnixZeroShift();
+        HighPerTimer::InitMaxMinHPTimer();
+        HighPerTimer::InitStampOverhead();
+    }
+    return true;
+}
+
 // changes clock skew. Only before determining the main routine!
 bool HighPerTimer::SetClockSkew ( const double DelayTime )
 {      
@@ -704,11 +1217,11 @@ HighPerTimer & HighPerTimer::operator= ( HighPerTimer &&  Timer )
 // add tics of Timer
 HighPerTimer & HighPerTimer::operator+= ( const HighPerTimer & Timer )
 {
-    if ( ( Timer.HPTics() > 0 ) && ( ( HighPerTimer::HPTimer_MAX.HPTics() - Timer.HPTics()  ) <= ( mHPTics ) ) )
+    if ( ( Timer.HPTics() > 0 ) && ( ( HighPerTimer::MaxHPTics() - Timer.HPTics()  ) <= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
-    if ( ( Timer.HPTics() < 0 ) && ( ( HighPerTimer::HPTimer_MIN.HPTics() - (Timer.HPTics() ) ) >= ( mHPTics ) ) )
+    if ( ( Timer.HPTics() < 0 ) && ( ( HighPerTimer::MinHPTics() - (Timer.HPTics() ) ) >= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
@@ -720,11 +1233,11 @@ HighPerTimer & HighPerTimer::operator+= ( const HighPerTimer & Timer )
 // substract tics of Timer
 HighPerTimer & HighPerTimer::operator-= ( const HighPerTimer & Timer )
 {
-    if ( ( Timer.HPTics() > 0 ) && ( ( HighPerTimer::HPTimer_MIN.HPTics() + ( Timer.HPTics() ) ) >= ( mHPTics ) ) )
+    if ( ( Timer.HPTics() > 0 ) && ( ( HighPerTimer::MinHPTics() + ( Timer.HPTics() ) ) >= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
-    if ( ( Timer.HPTics() < 0 ) && ( ( HighPerTimer::HPTimer_MAX.HPTics() + ( Timer.HPTics() ) ) <= ( mHPTics ) ) )
+    if ( ( Timer.HPTics() < 0 ) && ( ( HighPerTimer::MaxHPTics() + ( Timer.HPTics() ) ) <= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
@@ -736,15 +1249,16 @@ HighPerTimer & HighPerTimer::operator-= ( const HighPerTimer & Timer )
 // add double value of seconds to HPTimer
 HighPerTimer & HighPerTimer::operator+= ( const double Seconds )
 {
-    if ( ( Seconds > 0 ) && ( ( HighPerTimer::HPTimer_MAX.HPTics() - ( static_cast<int64_t> ( Seconds /  HighPerTimer::NsecPerTic * ONE_BILLION ) ) ) <= ( mHPTics ) ) )
+    const int64_t Tics ( HighPerTimer::NSectoTic ( static_cast<int64_t> ( Seconds * ONE_BILLION ) ) );
+    if ( ( Seconds > 0 ) && ( ( HighPerTimer::MaxHPTics() - Tics ) <= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
-    if ( ( Seconds < 0 ) && ( ( HighPerTimer::HPTimer_MIN.HPTics() - ( static_cast<int64_t> ( Seconds /  HighPerTimer::NsecPerTic * ONE_BILLION ) ) ) >= ( mHPTics ) ) )
+    if ( ( Seconds < 0 ) && ( ( HighPerTimer::MinHPTics() - Tics ) >= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
-    mHPTics += static_cast<int64_t> ( Seconds /  HighPerTimer::NsecPerTic * ONE_BILLION );
+    mHPTics += Tics;
     mNormalized = false;
     return *this;
 }
@@ -752,15 +1266,16 @@ HighPerTimer & HighPerTimer::operator+= ( const double Seconds )
 // substract double value of seconds to HPTimer
 HighPerTimer & HighPerTimer::operator-= ( const double Seconds )
 {
-    if ( ( Seconds > 0 ) && ( ( HighPerTimer::HPTimer_MIN.HPTics() + ( static_cast<int64_t> ( Seconds /  HighPerTimer::NsecPerTic * ONE_BILLION ) ) ) >= ( mHPTics ) ) )
+    const int64_t Tics ( HighPerTimer::NSectoTic ( static_cast<int64_t> ( Seconds * ONE_BILLION ) ) );
+    if ( ( Seconds > 0 ) && ( ( HighPerTimer::MinHPTics() + Tics ) >= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
-    if ( ( Seconds < 0 ) && ( ( HighPerTimer::HPTimer_MAX.HPTics() + ( static_cast<int64_t> ( Seconds /  HighPerTimer::NsecPerTic * ONE_BILLION ) ) ) <= ( mHPTics ) ) )
+    if ( ( Seconds < 0 ) && ( ( HighPerTimer::MaxHPTics() + Tics ) <= ( mHPTics ) ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
-    mHPTics -= static_cast<int64_t> ( Seconds / HighPerTimer::NsecPerTic * ONE_BILLION );
+    mHPTics -= Tics;
     mNormalized = false;
     return *this;
 }
@@ -774,349 +1289,251 @@ HighPerTimer HighPerTimer::Nil()
 // add seconds
 HighPerTimer & HighPerTimer::SecAdd ( const uint64_t Seconds )
 {
-    if ( ( HighPerTimer::HPTimer_MAX.HPTics() - ( Seconds / HighPerTimer::NsecPerTic * ONE_BILLION ) ) >= ( mHPTics ) )
-    {
-        mHPTics += Seconds / HighPerTimer::NsecPerTic * ONE_BILLION;
-    }
-    else
-    {
-        throw  std::out_of_range ( "HPTimer overflow" );
-    }
-    mNormalized = false;
-    return *this;
+    return this->TicAdd ( UnitstoTics ( Seconds, ONE_BILLION ) );
 }
 
 // add useconds
 HighPerTimer & HighPerTimer::USecAdd ( const uint64_t USeconds )
 {
-    if ( ( HighPerTimer::HPTimer_MAX.HPTics() - ( USeconds / HighPerTimer::NsecPerTic * 1000LL ) ) >= ( mHPTics ) )
-    {
-        mHPTics += USeconds / HighPerTimer::NsecPerTic * 1000LL;
-    }
-    else
-    {
-        throw  std::out_of_range ( "HPTimer overflow" );
-    }
-    mNormalized = false;
-    return *this;
+    return this->TicAdd ( UnitstoTics ( USeconds, 1000LL ) );
 }
 
 // add nseconds
 HighPerTimer & HighPerTimer::NSecAdd ( const uint64_t NSeconds )
 {
-    if ( ( HighPerTimer::HPTimer_MAX.HPTics() - ( NSeconds / HighPerTimer::NsecPerTic ) ) >= ( mHPTics ) )
-    {
-        mHPTics += NSeconds / HighPerTimer::NsecPerTic;
-    }
-    else
-    {
-        throw  std::out_of_range ( "HPTimer overflow" );
-    }
-    mNormalized = false;
-    return *this;
+    return this->TicAdd ( UnitstoTics ( NSeconds, 1LL ) );
 }
 
 // substract seconds
 HighPerTimer & HighPerTimer::SecSub ( const uint64_t Seconds )
 {
-    if ( ( HighPerTimer::HPTimer_MIN.HPTics() + ( ( Seconds / HighPerTimer::NsecPerTic ) * ONE_BILLION ) ) <= ( mHPTics ) )
-    {
-        mHPTics -= Seconds / HighPerTimer::NsecPerTic * ONE_BILLION;
-    }
-    else
-    {
-        throw  std::out_of_range ( "HPTimer overflow" );
-    }
-    mNormalized = false;
-    return *this;
+    return this->TicSub ( UnitstoTics ( Seconds, ONE_BILLION ) );
 }
 
 // substract useconds, decrement seconds if to many useconds
 HighPerTimer & HighPerTimer::USecSub ( const uint64_t USeconds )
 {
-    if ( ( HighPerTimer::HPTimer_MIN.HPTics() + ( ( USeconds / HighPerTimer::NsecPerTic ) * 1000LL ) ) <= ( mHPTics ) )
-    {
-        mHPTics -= USeconds  / HighPerTimer::NsecPerTic * 1000LL;
-    }
-    else
-    {
-        throw  std::out_of_range ( "HPTimer overflow" );
-    }
-    mNormalized = false;
-    return *this;
+    return this->TicSub ( UnitstoTics ( USeconds, 1000LL ) );
 }
 
 // substract nseconds, decrement seconds if to many nseconds
 HighPerTimer & HighPerTimer::NSecSub ( const uint64_t NSeconds )
 {
-    if ( ( HighPerTimer::HPTimer_MIN.HPTics() + ( NSeconds / HighPerTimer::NsecPerTic ) ) <= ( mHPTics ) )
-    {
-        mHPTics -= NSeconds / HighPerTimer::NsecPerTic;
-    }
-    else
+    return this->TicSub ( UnitstoTics ( NSeconds, 1LL ) );
+}
+
+
+HPSleeper::HPSleeper()
+    :   mInterrupted ( 0 )
+{
+}
+
+HPSleeper::HPSleeper ( const HPSleeper & )
+    :   mInterrupted ( 0 )
+{
+}
+
+HPSleeper & HPSleeper::operator= ( const HPSleeper & )
+{
+    return *this;
+}
+
+// wait on the futex word as long as it is zero, but not longer than NSeconds.
+// returns on timeout, on interruption, on a signal or on a spurious wakeup, so the caller has to check the state
+static inline void FutexWait ( std::atomic<int> & Word, const int64_t NSeconds )
+{
+    struct timespec Timeout;
+    Timeout.tv_sec = NSeconds / ONE_BILLION;
+    Timeout.tv_nsec = NSeconds % ONE_BILLION;
+    syscall ( SYS_futex, reinterpret_cast<int *> ( &Word ), FUTEX_WAIT_PRIVATE, 0, &Timeout, NULL, 0 );
+}
+
+// wake the thread waiting on the futex word
+static inline void FutexWake ( std::atomic<int> & Word )
+{
+    syscall ( SYS_futex, reinterpret_cast<int *> ( &Word ), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+}
+
+// wait untill the timer counter, not shifted to unix zero, reaches WakeTics.
+// An interrupt, which came before the sleep, is discarded. The sleep waits on the futex of the sleeper and busy-waits the
+// last BusyWaitNSec, which is either one jiffy or the p99 of the measured wakeup overshoot of the futex wait
+void HPSleeper::SleepTo ( const int64_t WakeTics ) const
+{
+    ClearInterrupt();
+    WaitTo ( WakeTics );
+}
+
+// wait untill the timer counter reaches WakeTics or the sleeper is interrupted, the profiler is only fed if enabled.
+// The time spinning includes the system calls of the waits, only the time between the reads around them is blocked
+void HPSleeper::WaitTo ( const int64_t WakeTics ) const
+{
+    if ( !HPSleepProfile::IsEnabled() )
     {
-        throw  std::out_of_range ( "HPTimer overflow" );
+        WaitFor ( WakeTics );
+        return;
     }
-    mNormalized = false;
-    return *this;
+    int64_t Begin ( HighPerTimer::GetTimerTics() );
+    int64_t Blocked ( WaitFor ( WakeTics ) );
+    int64_t End ( HighPerTimer::GetTimerTics() );
+    HPSleepProfile::Record ( HighPerTimer::TictoNSec ( End - WakeTics ), HighPerTimer::TictoNSec ( Blocked ),
+                             HighPerTimer::TictoNSec ( End - Begin - Blocked ), 0 != mInterrupted.load ( std::memory_order_relaxed ) );
 }
 
+void HPSleeper::WaitTo ( std::unique_lock<std::mutex> & Lock, const int64_t WakeTics ) const
+{
+    ClearInterrupt();
+    Lock.unlock();
+    WaitTo ( WakeTics );
+    Lock.lock();
+}
 
-void HighPerTimer::USecSleep ( const uint64_t USeconds ) const
-{      
-    mCancelled = false;  
-    int64_t TargetTics (  HighPerTimer::GetTimerTics() + ( USeconds * 1000 / ( HighPerTimer::NsecPerTic ) ) );
-       
-    // target timer counter not shifted to unix zero
-    long Counter ( 0 );
-    mInterrupted = false;      
-    uint64_t BusyUSeconds ( static_cast<uint64_t> (HighPerTimer::HPJiffies * 1000000 ));        
-    if ( USeconds >=  BusyUSeconds )        
-    {     
-        std::unique_lock<std::mutex> lock (HPmutex);     
-        if ( mInterrupted == true )
+// wait untill the timer counter reaches WakeTics or the sleeper is interrupted.
+// The interruption flag is not reset here, so an interrupt which came before the wait ends it immediately
+int64_t HPSleeper::WaitFor ( const int64_t WakeTics ) const
+{
+    static_assert ( sizeof ( std::atomic<int> ) == sizeof ( int ), "futex word must be a plain int" );
+    int64_t BusyNSeconds ( HighPerTimer::GetBusyWaitNSec() );
+    int64_t SysNSeconds ( HighPerTimer::TictoNSec ( WakeTics - HighPerTimer::GetTimerTics() ) );
+    int64_t Blocked ( 0 );
+
+    // in case when given sleep time is too little, SysNSeconds can be negative.
+    // the futex wait is repeated after signals and spurious wakeups with the remaining time
+    while ( ( SysNSeconds > 0 ) && ( SysNSeconds >= BusyNSeconds ) )
+    {
+        if ( mInterrupted.load ( std::memory_order_acquire ) )
         {
-          mCancelled = true;   
-        }        
-        HPcond.wait_for(lock, std::chrono::microseconds(USeconds - BusyUSeconds));  
-    }
-    
-    while ( HighPerTimer::GetTimerTics() < TargetTics )
-    {        
-        // since the mInterrupted is always on the stack, we should access it not too often!
-        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted )
+            return Blocked;
+        }
+        int64_t WaitNSeconds ( SysNSeconds - BusyNSeconds );
+        int64_t Before ( HighPerTimer::GetTimerTics() );
+        FutexWait ( mInterrupted, WaitNSeconds );
+        int64_t After ( HighPerTimer::GetTimerTics() );
+        Blocked += After - Before;
+        SysNSeconds = HighPerTimer::TictoNSec ( WakeTics - After );
+
+        // the overshoot of the wait tells, how long the busy-wait tail has to be
+        if ( !mInterrupted.load ( std::memory_order_relaxed ) )
         {
-            return;
+            HighPerTimer::AddWakeupOvershoot ( HighPerTimer::TictoNSec ( After - Before ) - WaitNSeconds );
         }
-        RepNop();
-    } 
-    return;
-}
+    }
 
-// wait the amount of corresponding time in nanoseconds
-// NOTE: Though WakeHPTimer can be done only from another thread, no thread synchronization is done here.
-// So guarantee that WakeHPTimer really wakes up the timer, can be given.
-void HighPerTimer::NSecSleep ( const uint64_t NSeconds ) const
-{    
-    mCancelled = false; 
-    int64_t TargetTics ( HighPerTimer::GetTimerTics()  + ( NSeconds / HighPerTimer::NsecPerTic ) );    
-    // target timer counter not shifted to unix zero
     long Counter ( 0 );
-    mInterrupted = false;
-        
-    uint64_t BusyNSeconds ( static_cast<int64_t> (HighPerTimer::HPJiffies * ONE_BILLION ) );       
-   
-    if ( NSeconds >= BusyNSeconds )
-    {         
-         std::unique_lock<std::mutex> lock (HPmutex);     
-         if ( mInterrupted == true )
-         {
-              mCancelled = true;   
-         } 
-         HPcond.wait_for(lock, std::chrono::microseconds( ( NSeconds - BusyNSeconds ) / 1000 ) );      
-    }
-    
-    while ( HighPerTimer::GetTimerTics() < TargetTics )
+#ifdef __aarch64__
+    // WFE pauses the core until the next event of the kernel's event stream, so we spin with it as long as
+    // the remaining time is longer than two periods of the stream, the rest with yield as on x86
+    if ( ARMTimer::HasEventStream )
     {
-        // since the mInterrupted is always on the stack, we should access it not too often!
-        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted )
+        int64_t EventTics ( HighPerTimer::NSectoTic ( 2 * EventStreamNSec ) );
+        while ( WakeTics - HighPerTimer::GetTimerTics() > EventTics )
         {
-            return;
+            if ( mInterrupted.load ( std::memory_order_relaxed ) )
+            {
+                return Blocked;
+            }
+            ARMTimer::WaitForEvent();
         }
-        RepNop();
     }
-    return;
-}
-
-// wait the amount of time in tics which the corresponding timer is set to
-// NOTE: Though WakeHPTimer can be done only from another thread, no thread synchronization is done here.
-// So guarantee that WakeHPTimer really wakes up the timer, can be given.
-void HighPerTimer::TicsSleep ( const  uint64_t HPTics ) const
-{
-     mCancelled = false; 
-    int64_t TargetTics ( HighPerTimer::GetTimerTics() + HPTics );
-    // target timer counter not shifted to unix zero
-    long Counter ( 0 );
-    mInterrupted = false;    
-    
-    int64_t BusyNSeconds ( static_cast<int64_t> (HighPerTimer::HPJiffies * ONE_BILLION ) );       
-       
-    if ( ( mHPTics > 0) && ( HPTics * HighPerTimer::NsecPerTic >=  BusyNSeconds ) )
-    {        
-        int64_t AllNSeconds ( HPTics * HighPerTimer::NsecPerTic );
-        std::unique_lock<std::mutex> lock (HPmutex);      
-        if ( mInterrupted == true )
+#elif defined ( __x86_64__ ) || defined ( __i386__ )
+    // UMWAIT and MWAITX wait on the interrupt flag, which Interrupt() writes, until a timeout of the TSC. The timeout
+    // is taken relative to the current tics, so it holds for the skew corrected TSC too. The waits end by the guard
+    // before the wake up, the rest is spun with pause
+    if ( HighPerTimer::MonitorWait && ( TimeSource::TSC == HighPerTimer::HPTimerSource ) )
+    {
+        int64_t GuardTics ( HighPerTimer::NSectoTic ( MonitorGuardNSec ) );
+        int64_t DeepTics ( HighPerTimer::NSectoTic ( MonitorDeepNSec ) );
+        int64_t Left;
+        while ( ( Left = WakeTics - HighPerTimer::GetTimerTics() ) > GuardTics )
         {
-            mCancelled = true;   
-        } 
-        HPcond.wait_for(lock, std::chrono::microseconds( ( AllNSeconds - BusyNSeconds ) / 1000 ) );       
+            // the flag is checked after arming the monitor, so an interrupt in between is not missed
+            TSCTimer::MonitorAddress ( &mInterrupted );
+            if ( mInterrupted.load ( std::memory_order_relaxed ) )
+            {
+                return Blocked;
+            }
+            TSCTimer::WaitMonitor ( Left - GuardTics, Left > DeepTics );
+        }
     }
-    
-    while ( HighPerTimer::GetTimerTics() < TargetTics )
+#endif
+    while ( HighPerTimer::GetTimerTics() < WakeTics )
     {
-        // since the mInterrupted is always on the stack, we should access it not too often!
-        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted )
+        // the state is shared with the interrupting thread, so we should access it not too often!
+        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted.load ( std::memory_order_relaxed ) )
         {
-            return;
+            return Blocked;
         }
         RepNop();
     }
-    return;
+    return Blocked;
+}
+
+// wait untill the given time since begin of Unix era is reached
+void HPSleeper::SleepTo ( const HPTimestamp & WakeTime ) const
+{
+    SleepTo ( WakeTime.HPTics() - HighPerTimer::GetUnixZeroShift() );
+}
+
+// wait the given amount of time
+void HPSleeper::Sleep ( const HPDuration & Duration ) const
+{
+    SleepTo ( HighPerTimer::GetTimerTics() + Duration.HPTics() );
+}
+
+// interrupt current sleep. Can only be called from a different thread, accessing the same object.
+// Only the thread sleeping on this sleeper is woken up, no lock is shared with other sleepers
+void HPSleeper::Interrupt()
+{
+    mInterrupted.store ( 1, std::memory_order_release );
+    FutexWake ( mInterrupted );
+}
+
+// wait the amount of corresponding time in useconds
+void HighPerTimer::USecSleep ( const uint64_t USeconds ) const
+{
+    // target timer counter not shifted to unix zero
+    mSleeper.SleepTo ( HighPerTimer::GetTimerTics() + UnitstoTics ( USeconds, 1000LL ) );
+}
+
+// wait the amount of corresponding time in nanoseconds
+void HighPerTimer::NSecSleep ( const uint64_t NSeconds ) const
+{
+    mSleeper.SleepTo ( HighPerTimer::GetTimerTics() + UnitstoTics ( NSeconds, 1LL ) );
 }
 
-// wait untill CPU or  main counter time since begin of Unix era
-// inline is not allowed here because of forced alignment
-// NOTE: Though WakeHPTimer can be done only from another thread, no thread synchronization is done here.
-// So guarantee that WakeHPTimer really wakes up the timer, can be given.
+// wait the amount of time in tics
+void HighPerTimer::TicsSleep ( const  uint64_t HPTics ) const
+{
+    mSleeper.SleepTo ( HighPerTimer::GetTimerTics() + HPTics );
+}
+
+// wait untill CPU or  main counter time, not shifted to unix zero
 void HighPerTimer::SleepTo ( const int64_t WakeHPTimer ) const
 {
-    mCancelled = false;
-    int64_t SysNSeconds ( ( WakeHPTimer - HighPerTimer::GetTimerTics() ) * HighPerTimer::NsecPerTic );    
-    
-    long Counter ( 0 );
-    mInterrupted = false;
-    
-    int64_t BusyNSeconds ( static_cast<int64_t> (HighPerTimer::HPJiffies * ONE_BILLION ) );      
-        
-    if ( ( SysNSeconds > 0 ) && ( SysNSeconds >=  BusyNSeconds ) )
-    {         
-        std::unique_lock<std::mutex> lock (HPmutex);      
-        if ( mInterrupted == true )
-        {
-             mCancelled = true;   
-        } 
-        HPcond.wait_for(lock, std::chrono::microseconds( ( SysNSeconds - BusyNSeconds ) / 1000 ));            
-    }
-    
-    while ( HighPerTimer::GetTimerTics() < WakeHPTimer )
-    {
-        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted )
-        {
-            return;
-        }
-        RepNop();
-    }
+    mSleeper.SleepTo ( WakeHPTimer );
 }
 
-// wait for WaitTo ticks
-// inline is not allowed here because of forced alignment
-// NOTE: Though WakeHPTimer can be done only from another thread, no thread synchronization is done here.
-// So guarantee that WakeHPTimer really wakes up the timer, can be given.
+// wait untill the time of WaitTo since begin of Unix era
 void HighPerTimer::SleepTo ( const HighPerTimer & WaitTo ) const
 {
-    mCancelled = false;
-    int64_t SysNSeconds ( ( WaitTo.mHPTics - HighPerTimer::Now().HPTics() ) * HighPerTimer::NsecPerTic );
-    long Counter ( 0 );
-    mInterrupted = false;
-    
-    int64_t BusyNSeconds ( static_cast<int64_t> (HighPerTimer::HPJiffies * ONE_BILLION ) );   
-
-    // use abs(), because in case when given sleep time is too little, SysNSeconds can be negative
-    if ( ( SysNSeconds > 0 ) && ( SysNSeconds >=  BusyNSeconds ) )
-    {        
-        std::unique_lock<std::mutex> lock (HPmutex); 
-        if ( mInterrupted == true )
-        {
-             mCancelled = true;   
-        } 
-        HPcond.wait_for(lock, std::chrono::microseconds( ( SysNSeconds - BusyNSeconds ) / 1000 ) );        
-    }
-    
-    while ( HighPerTimer::Now() < WaitTo )
-    {
-        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted )
-        {
-            return;
-        }
-        RepNop();
-    }
-    return;
+    mSleeper.SleepTo ( WaitTo.mHPTics - HighPerTimer::GetUnixZeroShift() );
 }
 
 // sleep until 'this' time is reached
-// NOTE: Though WakeHPTimer can be done only from another thread, no thread synchronization is done here.
-// So guarantee that WakeHPTimer really wakes up the timer, can be given.
 void HighPerTimer::SleepToThis () const
 {
-    mCancelled = false;       
-    int64_t SysNSeconds ( ( mHPTics - HighPerTimer::Now().HPTics() ) * HighPerTimer::NsecPerTic );
-    long Counter ( 0 );
-    mInterrupted = false;    
-          
-    int64_t BusyNSeconds ( static_cast<int64_t> (HighPerTimer::HPJiffies * ONE_BILLION ) );        
-       
-    if ( (SysNSeconds > 0) && ( SysNSeconds >=  BusyNSeconds ) )
-    {   
-        std::unique_lock<std::mutex> lock (HPmutex);      
-        if ( mInterrupted == true )
-        {
-             mCancelled = true;   
-        } 
-        HPcond.wait_for(lock, std::chrono::microseconds( ( SysNSeconds - BusyNSeconds ) / 1000 ) );    
-    }     
-     
-    while ( HighPerTimer::Now().HPTics() <  mHPTics )        
-    {   
-        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted )
-        {
-            return;
-        }
-        RepNop();
-    }
-    return;
+    mSleeper.SleepTo ( mHPTics - HighPerTimer::GetUnixZeroShift() );
 }
 
 // wait the amount of time the corresponding timer is set to
-// NOTE: Though WakeHPTimer can be done only from another thread, no thread synchronization is done here.
-// So guarantee that WakeHPTimer really wakes up the timer, can be given.
 void HighPerTimer::Sleep() const
 {
-    mCancelled = false; 
-    int64_t TargetTics ( HighPerTimer::GetTimerTics() + mHPTics );
-    // target hotimer counter not shifted to unix zero
-    long Counter ( 0 );
-    mInterrupted = false;
-    
-    int64_t BusyNSeconds ( static_cast<int64_t> (HighPerTimer::HPJiffies * ONE_BILLION ) );       
-       
-    if ( ( mHPTics > 0) && ( mHPTics * HighPerTimer::NsecPerTic >=  BusyNSeconds ) )
-    {       
-        int64_t AllNSeconds = mHPTics * HighPerTimer::NsecPerTic;
-        std::unique_lock<std::mutex> lock (HPmutex);      
-        if ( mInterrupted == true )
-        {
-             mCancelled = true;   
-        } 
-        HPcond.wait_for(lock, std::chrono::microseconds( ( AllNSeconds - BusyNSeconds ) / 1000 ) );
-    }
- 
-    while ( HighPerTimer::GetTimerTics() < TargetTics )
-    {
-        // since the mInterrupted is always on the stack, we should access it not too often!
-        if ( 0 == ( ++Counter & 0x0F ) && mInterrupted )
-        {
-            return;
-        }
-        RepNop();
-    }
-    return;
+    mSleeper.SleepTo ( HighPerTimer::GetTimerTics() + mHPTics );
 }
 
 // interrupt current timer from sleep. Can only be called from a different thread, accessing the same object.
-// NOTE: Though it is intended to be used in a different thread from sleeps, it is for performance reason
-// not thread save. So Interrupt shall be considered as an effort to wake up permaturely, but gives no garantee on this.
 void HighPerTimer::Interrupt()
 {
-    mCancelled = true; 
-    
-    // avoid possible race condition    
-    while ( mCancelled != true )
-    {  
-        mInterrupted = true;
-    }
-    mInterrupted = true;
-    HPcond.notify_one();   
-    return;
+    mSleeper.Interrupt();
 }
 
 // get the correct time of HPtimer
@@ -1131,7 +1548,7 @@ HighPerTimer HighPerTimer::Now()
 void HighPerTimer::Now ( HighPerTimer & HPTimer )
 {
     HPTimer.mNormalized = false;
-    HPTimer.mHPTics = HighPerTimer::GetTimerTics() + HighPerTimer::UnixZeroShift;
+    HPTimer.mHPTics = HighPerTimer::GetTimerTics() + HighPerTimer::GetUnixZeroShift();
 }
 
 // convert double to HPtimer. Double will be interptreted as Unix time
@@ -1139,7 +1556,8 @@ void HighPerTimer::Now ( HighPerTimer & HPTimer )
 // @return the converted value as HighPerTimer
 HighPerTimer HighPerTimer::DtoHPTimer ( const double Time )
 {
-    return HighPerTimer ( static_cast <int64_t> ( Time * 1e9D  / HighPerTimer::NsecPerTic ), false );
+    HighPerTimer::EnsureInitialized();
+    return HighPerTimer ( HighPerTimer::NSectoTic ( static_cast <int64_t> ( Time * 1e9D ) ), false );
 }
 
 // convert a HPTimer to double.
@@ -1147,7 +1565,7 @@ HighPerTimer HighPerTimer::DtoHPTimer ( const double Time )
 // @return converted time value as double
 double HighPerTimer::HPTimertoD ( const HighPerTimer & HPTimer )
 {
-    return ( HPTimer.HPTics() * static_cast <double> ( HighPerTimer::NsecPerTic ) / 1e9D );
+    return ( HPTimer.HPTics() * static_cast <double> ( HighPerTimer::NsecPerTic.load ( std::memory_order_relaxed ) ) / 1e9D );
 }
 
 // convert int64 tics to double.
@@ -1155,7 +1573,7 @@ double HighPerTimer::HPTimertoD ( const HighPerTimer & HPTimer )
 // @return double number
 double HighPerTimer::TictoD ( const int64_t HPTics )
 {
-    return ( HPTics * static_cast <double> ( HighPerTimer::NsecPerTic ) / 1e9D );
+    return ( HPTics * static_cast <double> ( HighPerTimer::NsecPerTic.load ( std::memory_order_relaxed ) ) / 1e9D );
 }
 
 //convert int64 nanoseconds into a HighPerTimer object. NSeconds will be interptreted as Unix time
@@ -1163,7 +1581,8 @@ double HighPerTimer::TictoD ( const int64_t HPTics )
 // @return corrected HighPerTimer object
 HighPerTimer HighPerTimer::NSectoHPTimer ( const int64_t NSeconds )
 {
-    return HighPerTimer ( NSeconds / HighPerTimer::NsecPerTic, false );
+    HighPerTimer::EnsureInitialized();
+    return HighPerTimer ( HighPerTimer::NSectoTic ( NSeconds ), false );
 }
 
 //convert HighPerTimer to int64 nanoseconds
@@ -1171,15 +1590,7 @@ HighPerTimer HighPerTimer::NSectoHPTimer ( const int64_t NSeconds )
 // @return int64 nanoseconds value
 int64_t HighPerTimer::HPTimertoNSec ( const HighPerTimer & HPTimer )
 {
-    HPTimer.Normalize();
-    if ( HPTimer.Negative() )
-    {
-        return -( HPTimer.Seconds() * ONE_BILLION + HPTimer.NSeconds() );
-    }
-    else
-    {
-        return ( HPTimer.Seconds() * ONE_BILLION + HPTimer.NSeconds() );
-    }
+    return HighPerTimer::TictoNSec ( HPTimer.HPTics() );
 }
 
 // set the timeval TV to the correct value of HighPerTimer
@@ -1261,7 +1672,7 @@ void HighPerTimer::SetNSeconds ( const int64_t NSeconds )
 // @exception std::out_of_range if a memory allocation failed
 void HighPerTimer::SetTics ( const int64_t HPTics )
 {
-    if ( ( HPTics <= HPTimer_MAX.HPTics() ) || ( HPTics >= HPTimer_MAX.HPTics() ) )
+    if ( ( HPTics <= HighPerTimer::MaxHPTics() ) || ( HPTics >= HighPerTimer::MaxHPTics() ) )
     {
         mHPTics = HPTics;
     }
@@ -1279,23 +1690,21 @@ void HighPerTimer::SetTics ( const int64_t HPTics )
 // @exception std::out_of_range if a memory allocation failed
 void HighPerTimer::SetTimer ( uint64_t Seconds, uint64_t NSeconds, bool Sign )
 {
+    HighPerTimer::EnsureInitialized();
     mSeconds = Seconds;
     mNSeconds = NSeconds;
     mSign = Sign;
     // check for possible overflow according to max and min vlaue HPTimer
-    if ( ( mSeconds * ONE_BILLION + mNSeconds ) > ( HighPerTimer::HPTimer_MAX.Seconds() * ONE_BILLION + HighPerTimer::HPTimer_MAX.NSeconds() ) )
+    if ( ( mSeconds * ONE_BILLION + mNSeconds ) > HighPerTimer::MaxNSec.load ( std::memory_order_relaxed ) )
     {
         throw  std::out_of_range ( "HPTimer overflow" );
     }
 
+    // the range is already checked in nanoseconds, so keep rounding of the last tic within the max value
+    mHPTics = std::min ( HighPerTimer::NSectoTic ( mSeconds * ONE_BILLION + mNSeconds ), HighPerTimer::MaxHPTics() );
     if ( mSign )
     {
-        // increase a little bit NsecPerTic to avoid overflow in case we calculate max value of TSC Timer source
-        mHPTics = - ( static_cast<int64_t> ( ( mSeconds * ONE_BILLION + mNSeconds ) / ( HighPerTimer::NsecPerTic + ( 1/ONE_QUADRILLION ) ) ) );
-    }
-    else
-    {
-        mHPTics = static_cast<int64_t> ( ( mSeconds * ONE_BILLION + mNSeconds ) / ( HighPerTimer::NsecPerTic + ( 1/ONE_QUADRILLION ) ) );
+        mHPTics = -mHPTics;
     }
     mNormalized = true;
     return;
@@ -1352,6 +1761,11 @@ std::string HighPerTimer::GetSourceString()
         tmpStr << "HPET";
         return std::string ( tmpStr.str() );  
     } 
+    else if ( HighPerTimer::GetHPSource() == TimeSource::ARM )
+    {
+        tmpStr << "ARM";
+        return std::string ( tmpStr.str() );  
+    }
     else
     {
         tmpStr << "OS";
@@ -1367,65 +1781,33 @@ std::string HighPerTimer::GetSourceString()
 // @exception std::length_error if the maximum size of a string would be exceeded
 std::string HighPerTimer::PrintTime ( bool HPTimer_only, bool UnixTime ) const
 {
-    std::ostringstream tmpStr;
     // if pHPTimer_only is set, print out only the value of the HPET counter
     if ( HPTimer_only == true )
     {
-        tmpStr << mHPTics;
-        return tmpStr.str();
+        return std::to_string ( mHPTics );
     }
     // firstly, set all members!
     this->Normalize();
-    // negative numbers can be printed out only in unix time format
-    if ( this->Negative() )
+    // negative numbers can be printed out only in unix time format, the seconds are right aligned to ten characters
+    if ( UnixTime || this->Negative() )
     {
-        UnixTime = true;
+        char Buffer[FormatLength];
+        size_t Size ( this->FormatTo ( Buffer, sizeof ( Buffer ) ) );
+        size_t Point ( std::find ( Buffer, Buffer + Size, '.' ) - Buffer );
+        std::string Text ( Point < 10 ? 10 - Point : 0, ' ' );
+        return Text.append ( Buffer, Size );
     }
-    struct tm *t_st;
+    std::ostringstream tmpStr;
+    struct tm t_st;
     char tmp_str[64];
     memset ( tmp_str, 0, sizeof ( tmp_str ) );
-    if ( !UnixTime )
+    time_t u_time ( mSeconds );
+    if ( NULL != ::localtime_r ( &u_time, &t_st ) )
     {
-        time_t u_time ( mSeconds );
-        t_st = ::localtime ( ( time_t * ) & u_time );
-        if ( NULL != t_st )
-        {
-            strftime ( tmp_str, sizeof ( tmp_str ) - 1, "%a %b %d %Y %H:%M:%S", t_st );
-            tmpStr << std::dec << tmp_str << "." << std::setfill ( '0' ) << std::setw ( 9 ) << mNSeconds;
-            tmpStr << std::setfill ( ' ' );
-            tmpStr << "\t Timer counter: " << mHPTics;
-        }
-    }
-    // unix time
-    else
-    {
-        tmpStr << std::dec;
-        if ( this->Negative() )
-        {
-
-            // convert from int64 to string
-            std::stringstream str_stream;
-            str_stream << mSeconds;
-            std::string secStr =  str_stream.str();            
-	    
-            // size - returns a count of the number of characters in the string.
-            if ( secStr.size() < 9 )
-            {
-                std::string fillStr ( 9 - secStr.size(), ' ' );
-                tmpStr << fillStr;
-            }
-            tmpStr<< '-'<< secStr;
-        }
-        else
-        {
-            tmpStr.fill ( ' ' );
-            tmpStr.width ( 10 );
-            tmpStr << mSeconds;
-        }
-        tmpStr << ".";
-        tmpStr.fill ( '0' );
-        tmpStr.width ( 9 );
-        tmpStr << mNSeconds << std::flush;
+        strftime ( tmp_str, sizeof ( tmp_str ) - 1, "%a %b %d %Y %H:%M:%S", &t_st );
+        tmpStr << std::dec << tmp_str << "." << std::setfill ( '0' ) << std::setw ( 9 ) << mNSeconds;
+        tmpStr << std::setfill ( ' ' );
+        tmpStr << "\t Timer counter: " << mHPTics;
     }
     return std::string ( tmpStr.str() );
 }
@@ -1441,26 +1823,21 @@ int64_t HighPerTimer::GetSysTime()
 
 // for using system time in logging
 // return string in format <sec>.<nsec>
-std::string HighPerTimer::SysNow () 
-    {
-        timespec ts;
-        std::ostringstream tmpStr;        
-        clock_gettime (CLOCK_REALTIME, &ts );
-	tmpStr << ts.tv_sec;
-        tmpStr << ".";
-        tmpStr.fill ( '0' );
-        tmpStr.width ( 9 );
-        tmpStr << ts.tv_nsec << std::flush;
-        return std::string (tmpStr.str());
-    }
+std::string HighPerTimer::SysNow ()
+{
+    char Buffer[FormatLength];
+    size_t Size ( HighPerTimer::FormatNSecTo ( HighPerTimer::GetSysTime(), Buffer, sizeof ( Buffer ) ) );
+    return std::string ( Buffer, Size );
+}
 
 
 // add seconds and a timer, return result by value
 HighPerTimer operator+ ( const HighPerTimer & HPTimer, const uint64_t SecOffset )
 {
-    if ( ( HighPerTimer::HPTimer_MAX.HPTics() - static_cast <int64_t> ( SecOffset / HighPerTimer::GetNsecPerTic() * ONE_BILLION ) ) >= ( HPTimer.HPTics() ) )
+    const int64_t Tics ( UnitstoTics ( SecOffset, ONE_BILLION ) );
+    if ( ( HighPerTimer::MaxHPTics() - Tics ) >= ( HPTimer.HPTics() ) )
     {
-        return HighPerTimer ( HPTimer.HPTics() + static_cast <int64_t> ( SecOffset / HighPerTimer::GetNsecPerTic() * ONE_BILLION ), false );
+        return HighPerTimer ( HPTimer.HPTics() + Tics, false );
     }
     else
     {
@@ -1471,9 +1848,10 @@ HighPerTimer operator+ ( const HighPerTimer & HPTimer, const uint64_t SecOffset
 // subtraction operator for HighPerTimer
 HighPerTimer operator- ( const HighPerTimer & HPTimer, const uint64_t SecOffset )
 {
-    if ( ( HighPerTimer::HPTimer_MIN.HPTics() + static_cast <int64_t> ( SecOffset / HighPerTimer::GetNsecPerTic() * ONE_BILLION ) ) <= ( HPTimer.HPTics() ) )
+    const int64_t Tics ( UnitstoTics ( SecOffset, ONE_BILLION ) );
+    if ( ( HighPerTimer::MinHPTics() + Tics ) <= ( HPTimer.HPTics() ) )
     {
-        return HighPerTimer ( HPTimer.HPTics() - static_cast <int64_t> ( SecOffset / HighPerTimer::GetNsecPerTic() * ONE_BILLION ), false );
+        return HighPerTimer ( HPTimer.HPTics() - Tics, false );
     }
     else
     {
@@ -1489,13 +1867,119 @@ HighPerTimer operator- ( const HighPerTimer & HPTimer, const uint64_t SecOffset
 // NOTE: Not use instances of this class in main routine.
 HPTimerInitAndClean::HPTimerInitAndClean()
 {
-    // assign -1 to hpet device handle
-    HPETTimer::HpetFd = -1;
-    HighPerTimer::InitTimerSource();
-    HighPerTimer::InitHPFrequency( 0.02 ) ;
-    HighPerTimer::InitUnixZeroShift();
-    HighPerTimer::InitMaxMinHPTimer();
-    HighPerTimer::InitSecPerJiffy();    
+#ifndef HPTIMER_LAZY_INIT
+    HighPerTimer::Initialize();
+#endif
+    // the initialization might come from a static object of another compilation unit
+    // before the ctors of the max and min values in this one, so set them again
+    if ( HighPerTimer::IsInitialized() )
+    {
+        HighPerTimer::InitMaxMinHPTimer();
+    }
+}
+
+// initialize the timer once
+// @exception std::out_of_range if the DelayTime or the SelectionBudget is not positive or MaxTSCSkew is negative
+bool HighPerTimer::Initialize ( const InitOptions & Options )
+{
+    if ( !( Options.DelayTime > 0 ) || !( Options.SelectionBudget > 0 ) || !( Options.MaxTSCSkew >= 0 ) )
+    {
+        throw ( std::out_of_range ( "illegal init Parameters of HighPerTimer" ) );
+    }
+    bool Done ( false );
+    std::call_once ( InitFlag, [&Options, &Done] ()
+    {
+        HighPerTimer::InitAll ( Options );
+        Done = true;
+    } );
+    return Done;
+}
+
+// keep the order of the initialization. The measurements are done on the requested CPU,
+// the affinity of the calling thread is restored afterwards
+void HighPerTimer::InitAll ( const InitOptions & Options )
+{
+    Initializing = true;
+    cpu_set_t OldSet;
+    bool Pinned ( false );
+    if ( ( Options.CPU >= 0 ) && ( Options.CPU < CPU_SETSIZE ) && ( 0 == pthread_getaffinity_np ( pthread_self(), sizeof ( OldSet ), &OldSet ) ) )
+    {
+        cpu_set_t NewSet;
+        CPU_ZERO ( &NewSet );
+        CPU_SET ( Options.CPU, &NewSet );
+        Pinned = ( 0 == pthread_setaffinity_np ( pthread_self(), sizeof ( NewSet ), &NewSet ) );
+    }
+
+    TSCTimer::GetSIMDFeatures();
+    TSCTimer::GetWaitFeatures();
+    HighPerTimer::MonitorWait = Options.UseMonitorWait && ( TSCTimer::HasWaitPkg || TSCTimer::HasMonitorX );
+    if ( !OSTimer::InitOSTimer ( Options.Clock ) )
+    {
+        OSTimer::InitOSTimer ( OSClock::Monotonic );
+    }
+    // the calibration published on this host is taken first, then the one of the last process on this boot,
+    // otherwise measure and save it
+    bool Shared ( Options.UseSharedCalibration && HighPerTimer::AttachCalibration ( true ) );
+    bool Cached ( !Shared && Options.UseCache && HighPerTimer::LoadCalibration() );
+    if ( Shared || Cached )
+    {
+        // the hypervisor and the clocksources of the kernel were read by RestoreSource()
+        HighPerTimer::Selection().Chosen = HighPerTimer::HPTimerSource;
+        HighPerTimer::Selection().Reason = Shared ? "taken from the shared calibration page" : "loaded from the calibration cache";
+    }
+    else
+    {
+        HighPerTimer::InitTimerSource ( Options.SelectionBudget );
+        HighPerTimer::InitTicsReader();
+        HighPerTimer::InitHPFrequency( Options.DelayTime ) ;
+        HighPerTimer::InitUnixZeroShift();
+        HighPerTimer::InitMaxMinHPTimer();
+        HighPerTimer::InitSecPerJiffy();    
+        HighPerTimer::InitBusyWait();
+        if ( Options.UseCache )
+        {
+            HighPerTimer::SaveCalibration();
+        }
+    }
+    if ( Options.PreferSource && ( Options.Source != HighPerTimer::HPTimerSource ) )
+    {
+        if ( Options.Source == HighPerTimer::SetTimerSource ( Options.Source ) )
+        {
+            HighPerTimer::Selection().Chosen = Options.Source;
+            HighPerTimer::Selection().Reason += "; replaced by the preferred source of the options";
+        }
+    }
+
+    HighPerTimer::InitStampOverhead();
+
+    if ( Pinned )
+    {
+        pthread_setaffinity_np ( pthread_self(), sizeof ( OldSet ), &OldSet );
+    }
+    // the probes need all CPUs of the calling thread, so the skew is measured after restoring its affinity
+    if ( Options.MeasureTSCSkew )
+    {
+        HighPerTimer::InitTSCSkew ( Options.MaxTSCSkew, Options.CorrectTSCSkew );
+    }
+    Initializing = false;
+    HighPerTimer::Initialized.store ( true, std::memory_order_release );
+}
+
+// a conversion before the calibration, with HPTIMER_LAZY_INIT or from a static object of another compilation unit,
+// which is constructed before the_HPTimerInitAndClean, would multiply by zero
+void HighPerTimer::InitForConversion()
+{
+    if ( !Initializing )
+    {
+        HighPerTimer::Initialize();
+    }
+}
+
+// read of the timer counter before the initialization
+int64_t HighPerTimer::LazyTics()
+{
+    HighPerTimer::Initialize();
+    return HighPerTimer::ReadTics();
 }
 
 // final clean up timer
@@ -26,14 +26,223 @@
 #include "TimeHardware.h"
 #include <stdexcept>
 #include <atomic>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+struct pollfd;
 
 namespace HPTimer
 {
 
-/// source of timer: TSC Timer, HPET Timer or the timer, provided by the OS
+/// source of timer: TSC Timer, HPET Timer, the timer, provided by the OS, or the generic timer of ARM
 enum class TimeSource
 {
-    TSC, HPET, OS
+    TSC, HPET, OS, ARM
+};
+
+/// reader of the timer counter: the time source together with the instruction used to access it.
+/// RDTSC and RDTSCP both read the TSC Timer, HPET and OS correspond to the appropriate time sources,
+/// CNTVCT reads the virtual counter of the ARM generic timer,
+/// RDTSCPOffset subtracts the measured TSC offset of the CPU, whose number RDTSCP returns, see InitOptions::MeasureTSCSkew
+enum class TicsReader
+{
+    RDTSC, RDTSCP, HPET, OS, CNTVCT, RDTSCPOffset
+};
+
+/// choice of the busy-wait tail of the sleeps: the duration of one jiffy, or the p99 of the wakeup overshoot of the OS wait,
+/// measured at initialization and updated online by the sleeps and by HighPerTimer::ProbeBusyWait()
+enum class SleepMode
+{
+    Jiffies, Adaptive
+};
+
+/// formats of HighPerTimer::FormatTo(): seconds and nanoseconds since begin of Unix era, e.g. 1791980096.123456789;
+/// ISO 8601 in UTC, e.g. 2026-10-14T12:14:56.123456789Z; ISO 8601 in local time, e.g. 2026-10-14T14:14:56.123456789+02:00
+enum class TimeFormat
+{
+    Unix, ISO8601UTC, ISO8601Local
+};
+
+/// options of the initialization of HighPerTimer, see HighPerTimer::Initialize()
+struct InitOptions
+{
+    /// time in seconds of each of the five frequency measurements, the longer the more precise
+    double DelayTime = 0.02;
+
+    /// use Source instead of the automatically chosen time source, if it is available
+    bool PreferSource = false;
+
+    /// the preferred time source
+    TimeSource Source = TimeSource::TSC;
+
+    /// time in seconds of the benchmarks of the reads, which choose the time source. It is shared by all candidates
+    double SelectionBudget = 0.002;
+
+    /// the clock of the OS time source
+    OSClock Clock = OSClock::Monotonic;
+
+    /// pin the thread to this CPU during the measurements, -1 keeps the affinity of the calling thread
+    int CPU = -1;
+
+    /// load the calibration from the cache file and save it there after measuring
+    bool UseCache = true;
+
+    /// take the calibration from the shared page of a publishing process on this host, see HighPerTimer::PublishCalibration().
+    /// It is tried before the cache file, so all processes using the page convert the tics identically
+    bool UseSharedCalibration = true;
+
+    /// measure the TSC offsets between the CPUs. Invariant TSCs of different sockets, or the ones of some hypervisors,
+    /// may still differ by hundreds of nanoseconds, so a duration measured across a thread migration may get negative
+    bool MeasureTSCSkew = false;
+
+    /// offset in seconds between the TSCs of the CPUs, which is tolerated without any correction
+    double MaxTSCSkew = 1e-7;
+
+    /// subtract the offset of the CPU on each read if the skew is above MaxTSCSkew and the CPU is known from RDTSCP.
+    /// Otherwise, or if the uncertainty of the offsets is above MaxTSCSkew too, the HPET or the OS source is used instead
+    bool CorrectTSCSkew = true;
+
+    /// wait the busy-wait tail of the sleeps with UMWAIT or MWAITX on the interrupt flag instead of spinning, if the CPU
+    /// has the instructions and the TSC is the time source. The core saves power and leaves its resources to the SMT sibling
+    bool UseMonitorWait = true;
+};
+
+/// how the initialization has chosen the time source, see AccessTimeHardware::GetSourceSelection()
+struct SourceSelection
+{
+    /// one candidate of the choice
+    struct Candidate
+    {
+        /// the counter could be initialized
+        bool Available = false;
+
+        /// number of batches of reads, which were timed within the budget, 0 if the candidate was not measured
+        uint32_t Batches = 0;
+
+        /// median cost of one read in nanoseconds
+        double ReadNSec = 0;
+
+        /// difference between the upper and the lower quartile of the cost of one read in nanoseconds
+        double SpreadNSec = 0;
+
+        /// number of reads, which returned a smaller value than the read before
+        uint32_t Backsteps = 0;
+    };
+
+    /// the candidates, indexed by the values of TimeSource
+    Candidate Candidates[4];
+
+    /// the CPU runs under a hypervisor
+    bool Hypervisor = false;
+
+    /// vendor signature of the hypervisor, e.g. "KVMKVMKVM", empty without one
+    std::string HypervisorVendor;
+
+    /// current clocksource of the kernel, empty if it could not be read
+    std::string KernelClocksource;
+
+    /// the kernel lists the TSC among its available clocksources. It removes it, when it marks the TSC unstable
+    bool KernelListsTSC = false;
+
+    /// the chosen source
+    TimeSource Chosen = TimeSource::OS;
+
+    /// the reason of the choice and the rejection of the TSC, if it was rejected
+    std::string Reason;
+};
+
+/// throw std::out_of_range ( "HPTimer overflow" ). The throw is out of line, so the inline arithmetic of the headers
+/// compiles also in units built without exceptions, which use the arithmetic of HPArithmetic.h
+[[noreturn]] void ThrowOverflow();
+
+class HPTimestamp;
+class HPDuration;
+
+//! Class for sleeping with the hybrid wait and interrupting the sleep from a different thread
+/*!
+ * A sleep first waits on a futex and spends the rest of the sleep time busy-waiting on the timer counter.
+ * Each sleeper waits on its own futex word, so sleepers share no lock and an interrupt wakes exactly the
+ * thread sleeping on this object. 
+ * HPSleeper keeps the interruption state only, so the sleep state can live apart from the time values:
+ * HighPerTimer holds one for its sleep functions, the compact HPTimestamp and HPDuration have none
+ */
+class HPSleeper
+{
+public:
+    /// standard ctor
+    HPSleeper();
+
+    /// copy ctor, the interruption state is not copied
+    HPSleeper ( const HPSleeper & Sleeper );
+
+    /// copy assignment, the interruption state is not copied
+    HPSleeper & operator= ( const HPSleeper & Sleeper );
+
+    /** wait untill the timer counter reaches the given tics
+     * @param WakeTics value of tics of the current time source, not shifted to unix zero, at which the method should wake up
+     */
+    void SleepTo ( const int64_t WakeTics ) const;
+
+    /** wait untill the given time is reached
+     * @param WakeTime is the time at which the method should wake up
+     */
+    void SleepTo ( const HPTimestamp & WakeTime ) const;
+
+    /** wait the given amount of time
+     * @param Duration is the time to sleep
+     */
+    void Sleep ( const HPDuration & Duration ) const;
+
+    /** wait untill the timer counter reaches the given tics or one of the descriptors is ready, as poll() does.
+     * The OS waits on the descriptors with the coarse part of the sleep, the busy-wait tail checks them every few microseconds.
+     * An interrupt ends the busy-wait tail only, so wake the thread by an eventfd of the set instead.
+     * NOTE: implemented in HPWaitable.cpp, include HPWaitable.h
+     * @param Fds are the descriptors and events as for poll(), their revents are set
+     * @param Count is the number of descriptors
+     * @param WakeTics value of tics of the current time source, not shifted to unix zero, at which the method should wake up
+     * @return number of ready descriptors, 0 if the time was reached, -1 on an error of poll() with errno set
+     */
+    int SleepToOrReadable ( struct ::pollfd * Fds, const size_t Count, const int64_t WakeTics ) const;
+
+    /** wait untill the given time is reached or one of the descriptors is ready, see above
+     * NOTE: implemented in HPWaitable.cpp, include HPWaitable.h
+     */
+    int SleepToOrReadable ( struct ::pollfd * Fds, const size_t Count, const HPTimestamp & WakeTime ) const;
+
+    /** wait untill the timer counter reaches the given tics or the sleeper is interrupted. Unlike SleepTo(), an interrupt,
+     * which came before the wait, is kept and ends it at once, so a thread clears it by ClearInterrupt() before it checks
+     * the state, on which it decides to wait
+     * @param WakeTics value of tics of the current time source, not shifted to unix zero, at which the method should wake up
+     */
+    void WaitTo ( const int64_t WakeTics ) const;
+
+    /** wait of a thread, which sleeps between its jobs and is woken by an Interrupt() under the mutex of its state,
+     * e.g. for a stop or a new deadline. The caller holds Lock while it checks the state, the interrupt is cleared
+     * under the lock and the lock is released for WaitTo(), so an Interrupt(), which comes after the check and before
+     * the wait has begun, still ends the wait
+     * @param Lock is the locked unique_lock of the mutex, it is locked again on return
+     * @param WakeTics value of tics of the current time source, not shifted to unix zero, at which the method should wake up
+     */
+    void WaitTo ( std::unique_lock<std::mutex> & Lock, const int64_t WakeTics ) const;
+
+    /// discard an interrupt, which was not yet taken by a sleep
+    inline void ClearInterrupt() const
+    {
+        mInterrupted.store ( 0, std::memory_order_relaxed );
+    }
+
+    /// interrupt the sleep. Can only be called from a different thread, accessing the same object.
+    /// An interrupt, which comes before the sleep has begun, is discarded by SleepTo() and Sleep(), but ends WaitTo().
+    void Interrupt();
+
+private:
+    /// wait of WaitTo(), return the tics blocked in the OS
+    int64_t WaitFor ( const int64_t WakeTics ) const;
+
+    /// futex word of the sleeper, set to non-zero value on interruption
+    mutable std::atomic<int> mInterrupted;
 };
 
 //! Main class of HighPerTimer, based on the TSC, HPET or system call of clock_gettime() 
@@ -45,10 +254,15 @@ enum class TimeSource
 class HighPerTimer
 {
     friend class HPTimerInitAndClean;
+    friend class HPSleeper;
+    friend class AccessTimeHardware;
+    friend class HPTimestamp;
+    friend class HPTicsLogWriter;
+    friend class HPTicsLogReader;
 public:
-    /// Maximum timer value
+    /// Maximum timer value, set at the initialization. A runtime calibration changes MaxHPTics() only
     static HighPerTimer HPTimer_MAX;
-    /// Minimum timer value
+    /// Minimum timer value, set at the initialization. A runtime calibration changes MinHPTics() only
     static HighPerTimer HPTimer_MIN;
     
     /**
@@ -60,6 +274,52 @@ public:
      * @return new modified Timer Source. In case this function succeeds, it is supposed to be equal UserSource
      */
     static TimeSource SetTimerSource ( const TimeSource UserSource );
+
+    /**
+     * initialize the timer: choose the time source, measure the frequency, the jiffies and the busy-wait tail.
+     * It is done only once, by the first call. By default it is called during static initialization with the default options.
+     * When the library is built with HPTIMER_LAZY_INIT, it is called by the first read of the timer counter or by the
+     * first conversion, e.g. TictoNSec() or HPDuration::FromNSec(), unless the application calls it before with its own options.
+     * The same holds in the default mode for a static object of another compilation unit, which is constructed first.
+     * @param Options are the options of the calibration
+     * @return true if this call has initialized the timer, false if it was initialized already
+     * @exception std::out_of_range if the DelayTime or the SelectionBudget is not positive or MaxTSCSkew is negative
+     */
+    static bool Initialize ( const InitOptions & Options = InitOptions() );
+
+    /// return true if the timer is initialized
+    inline static bool IsInitialized()
+    {
+        return HighPerTimer::Initialized.load ( std::memory_order_acquire );
+    }
+
+    /**
+     * publish the calibration of this process in the shared page, so the processes started later on this host
+     * take it at their initialization instead of measuring their own. The page is
+     * $HPTIMER_CALIBRATION_PAGE or /dev/shm/libHPTimer-calibration, an empty variable disables it.
+     * Call it again to publish a changed calibration, the readers retry on a concurrent update by a sequence lock.
+     * @return false if the page could not be created or is disabled
+     */
+    static bool PublishCalibration();
+
+    /**
+     * set the frequency and the shift to unix zero of this process, e.g. corrected for the drift by HPClockSync,
+     * and publish them in the shared page. The threads of this process, which convert tics meanwhile,
+     * take either the old or the new fixed-point pairs, see ConversionSeq. The frequency and the range limits of
+     * the checks, MaxHPTics() and MinHPTics(), are atomic words, while HPTimer_MAX and HPTimer_MIN keep their initial values
+     * @param NsecPerTic is the new number of nanoseconds of one tic
+     * @param UnixZeroShift is the new shift of the counter to the begin of unix era in tics
+     * @return false if the page could not be written
+     * @exception std::out_of_range if NsecPerTic is not positive
+     */
+    static bool PublishCalibration ( const double NsecPerTic, const int64_t UnixZeroShift );
+
+    /**
+     * take the calibration of the shared page again, if its publisher has changed it since the last read.
+     * It may be called while other threads convert tics, as PublishCalibration ( NsecPerTic, UnixZeroShift )
+     * @return true if a new calibration was taken
+     */
+    static bool RefreshCalibration();
     
     /**
      * change the current value of clock skew. 
@@ -74,6 +334,38 @@ public:
      */    
     static bool SetClockSkew ( const double DelayTime );
 
+    /**
+     * change the clock, which is read by the OS time source. By default it is OSClock::Monotonic.
+     * Whatever clock is selected, the timer counts the time since begin of Unix era: the offset of the clock to
+     * CLOCK_REALTIME is taken once, so the timer is not stepped with the chosen clock afterwards.
+     * OSClock::MonotonicCoarse has the resolution of a jiffy, but it is the cheapest read, e.g. for stamping log lines.
+     * NOTE: The clock is only used, if the time source is TimeSource::OS. Use this function only at system initialization time.
+     * @param Clock is the clock which should be used
+     * @return true if the kernel supports the clock, otherwise the clock before is kept
+     */
+    static bool SetOSClock ( const OSClock Clock );
+
+    /// get the clock of the OS time source
+    inline static OSClock GetOSClock()
+    {
+        return OSTimer::Clock;
+    }
+
+    /**
+     * change the way the busy-wait tail of the sleeps is chosen. By default it is SleepMode::Adaptive.
+     * SleepMode::Jiffies spins the whole last jiffy of every sleep, like on kernels with a periodic tick.
+     * SleepMode::Adaptive measures the wakeup overshoot of the OS wait again and spins about its p99.
+     * @param Mode is the mode which should be set
+     */
+    static void SetSleepMode ( const SleepMode Mode );
+
+    /**
+     * measure the overshoot of a few short OS waits and update the busy-wait tail of SleepMode::Adaptive.
+     * The sleeps only account their own OS waits, so a tail, which is longer than all the sleeps, does not shrink
+     * by them. Call it periodically from a thread without deadlines, e.g. a housekeeping loop. It blocks for some 0.2 ms
+     */
+    static void ProbeBusyWait();
+
     /// set the HighPerTimer counter offset against the Unix zero time - 1 January 1970
     /// NOTE: Use this function only at system initialization time, and in any case
     /// <b> before </b> instantiation of the first HighPerTimer object!
@@ -82,7 +374,11 @@ public:
     
     /// standard ctor
     /// set tics of HPTimer equal to zero in lazy behavior,
-    HighPerTimer();
+    inline HighPerTimer() :
+        mHPTics ( 0 ),
+        mNormalized ( false )
+    {
+    };
 
     /**
      * ctor
@@ -142,6 +438,72 @@ public:
         tsc = TSCTimer::CPU_TSC();
     };
 
+    /** sets tsc to actual tics of TSC counter and cpu to the CPU, on which it was read, e.g. to detect
+     * a migration of the thread between two stamps. Without a system call if IA32_TSC_AUX holds the CPU
+     * @param tsc is a reference of Time stamp counter tics
+     * @param cpu is a reference of the number of the CPU
+     */
+    inline static void CPU_TicsAndCpu ( int64_t & tsc, uint32_t & cpu )
+    {
+        uint32_t node;
+        HighPerTimer::EnsureInitialized();
+        tsc = TSCTimer::CPU_TSC ( cpu, node );
+    };
+
+    /** sets tsc to actual tics of TSC counter, cpu and node to the CPU and the NUMA node, on which it was read
+     * @param tsc is a reference of Time stamp counter tics
+     * @param cpu is a reference of the number of the CPU
+     * @param node is a reference of the number of the NUMA node
+     */
+    inline static void CPU_TicsAndCpu ( int64_t & tsc, uint32_t & cpu, uint32_t & node )
+    {
+        HighPerTimer::EnsureInitialized();
+        tsc = TSCTimer::CPU_TSC ( cpu, node );
+    };
+
+    /** read the counter of the current time source at the begin of a measured section for micro-benchmarks.
+     * The read is fenced, so the code before has finished and the measured code has not started yet:
+     * LFENCE;RDTSC;LFENCE with the TSC, or CPUID;RDTSC on CPUs where LFENCE does not serialize, ISB;MRS;ISB with the ARM timer.
+     * The other sources are read as by GetTimerTics(). Subtract GetStampOverhead() from StopStamp() - StartStamp().
+     * @return raw tics of the current time source, not shifted to unix zero
+     */
+    inline static int64_t StartStamp()
+    {
+        HighPerTimer::EnsureInitialized();
+        return HighPerTimer::ReadStartStamp();
+    };
+
+    /** read the counter of the current time source at the end of a measured section for micro-benchmarks.
+     * The read waits for the measured code and the code after it does not start before: RDTSCP;LFENCE with the TSC,
+     * or RDTSCP;CPUID on CPUs where LFENCE does not serialize, ISB;MRS;ISB with the ARM timer.
+     * @return raw tics of the current time source, not shifted to unix zero
+     */
+    inline static int64_t StopStamp()
+    {
+        if ( TimeSource::TSC == HighPerTimer::HPTimerSource )
+        {
+            return TSCTimer::StopTSC();
+        }
+        if ( TimeSource::ARM == HighPerTimer::HPTimerSource )
+        {
+            return ARMTimer::FencedCNTVCT();
+        }
+        return HighPerTimer::GetTimerTics();
+    };
+
+    /// get the median tics between StartStamp() and StopStamp() without any code in between, measured at initialization.
+    /// It is the overhead, which should be subtracted from a measurement bracketed by them
+    inline static int64_t GetStampOverhead()
+    {
+        return HighPerTimer::StampOverhead;
+    };
+
+    /// get the median tics between two successive reads of the timer counter, e.g. by Now(), measured at initialization
+    inline static int64_t GetReadOverhead()
+    {
+        return HighPerTimer::ReadOverhead;
+    };
+
     /**
      * Comparison operators for timer struct     
      */
@@ -196,13 +558,13 @@ public:
      */
     inline HighPerTimer & TicAdd ( const uint64_t Tics )
     {
-        if ( static_cast<int64_t> ( HighPerTimer::HPTimer_MAX.HPTics() - Tics ) >= ( mHPTics ) )
+        if ( static_cast<int64_t> ( HighPerTimer::MaxHPTics() - Tics ) >= ( mHPTics ) )
         {
              mHPTics += Tics;
         }
         else
         {
-             throw  std::out_of_range ( "HPTimer overflow" );
+             HPTimer::ThrowOverflow();
         }
         mNormalized = false;
         return *this;
@@ -236,13 +598,13 @@ public:
      */
     inline  HighPerTimer & TicSub ( const uint64_t Tics )
     {
-        if ( static_cast<int64_t> ( HighPerTimer::HPTimer_MIN.HPTics() + Tics ) <= ( mHPTics ) )
+        if ( static_cast<int64_t> ( HighPerTimer::MinHPTics() + Tics ) <= ( mHPTics ) )
         {
             mHPTics -= Tics;
         }
         else
         {
-             throw  std::out_of_range ( "HPTimer overflow" );
+             HPTimer::ThrowOverflow();
         }
         mNormalized = false;
         return *this;
@@ -260,44 +622,53 @@ public:
 
     /** wait the amount of corresponding time in tics 
      * @param HPTics number of tics for sleep
-     * NOTE: Though it can be done only from another thread, no thread synchronization is done here.
-     * So guarantee that it really wakes up the timer, can be given.
+     * NOTE: The sleep can be interrupted by Interrupt() from another thread.
      */
     void TicsSleep ( const uint64_t HPTics ) const;
 
     /** wait untill CPU or HPET main counter ticks since begin of Unix era
      * @param WakeHPTimer value of tics, at which the method should wake up 
-     * NOTE: Though it can be done only from another thread, no thread synchronization is done here.
-     * So guarantee that it really wakes up the timer, can be given.
+     * NOTE: The sleep can be interrupted by Interrupt() from another thread.
      */
     void SleepTo ( const int64_t WakeHPTimer ) const;
 
     /** wait for WaitTo ticks
      * @param WaitTo HighPerTimer value till which we have to sleep
-     * NOTE: Though it can be done only from another thread, no thread synchronization is done here.
-     * So guarantee that it really wakes up the timer, can be given.
+     * NOTE: The sleep can be interrupted by Interrupt() from another thread.
      */
     void SleepTo ( const HighPerTimer & WaitTo ) const;
 
     /** wait till the value of *this
-     * NOTE: Though it can be done only from another thread, no thread synchronization is done here.
-     * So guarantee that it really wakes up the timer, can be given.
+     * NOTE: The sleep can be interrupted by Interrupt() from another thread.
      */
     void SleepToThis() const;
 
     /** wait the period of time which the corresponding timer is set to
-     * NOTE: Though it can be done only from another thread, no thread synchronization is done here.
-     * So guarantee that it really wakes up the timer, can be given.
+     * NOTE: The sleep can be interrupted by Interrupt() from another thread.
      */
     void Sleep() const;
 
     /// interrupt the current timer from sleep. Can only be called from a different thread, accessing the same object. 
-    /// NOTE: This operation is not thread save.
+    /// Only the thread sleeping on this timer is woken up.
     void Interrupt();
 
     /// get the correct time
     static HighPerTimer Now();
 
+    /** get the correct time, reading the timer counter with the reader given at compile time.
+     * The read is inlined and does not dispatch on the current time source and on the presence of RDTSCP.
+     * NOTE: Reader must be equal to GetTicsReader(), so select the instantiation once after initialization,
+     * e.g. by a switch on GetTicsReader() around the measuring routine
+     * @return the current time
+     */
+    template <TicsReader Reader> 
+    inline static HighPerTimer Now()
+    {
+        HighPerTimer Timer;
+        Timer.mHPTics = HighPerTimer::ReaderTics<Reader>() + HighPerTimer::GetUnixZeroShift();
+        return Timer;
+    };
+
     /** set the HPTimer to the correct time
      * @param HPTimer is a HighPerTimer which time value shoud be set 
      */
@@ -306,7 +677,17 @@ public:
     /// set timer to the correct time
     inline void SetNow()
     {
-        mHPTics = HighPerTimer::GetTimerTics() + HighPerTimer::UnixZeroShift;
+        mHPTics = HighPerTimer::GetTimerTics() + HighPerTimer::GetUnixZeroShift();
+        mNormalized = false;
+        return;
+    };
+
+    /// set timer to the correct time, reading the timer counter with the reader given at compile time
+    /// NOTE: Reader must be equal to GetTicsReader()
+    template <TicsReader Reader> 
+    inline void SetNow()
+    {
+        mHPTics = HighPerTimer::ReaderTics<Reader>() + HighPerTimer::GetUnixZeroShift();
         mNormalized = false;
         return;
     };
@@ -341,6 +722,83 @@ public:
      */
     static int64_t HPTimertoNSec ( const HighPerTimer & Timer );
 
+    /** convert int64 tics to int64 nanoseconds with the fixed-point pair NSecMult / NSecShift.
+     * The result is truncated toward zero and saturated to the limits of int64
+     * @param HPTics means tics which should be converted
+     * @return int64 nanoseconds value
+     */
+    inline static int64_t TictoNSec ( const int64_t HPTics )
+    {
+        uint64_t Mult;
+        uint32_t Shift;
+        HighPerTimer::LoadPair ( HighPerTimer::NSecMult, HighPerTimer::NSecShift, Mult, Shift );
+        return HighPerTimer::FixedPointMul ( HPTics, Mult, Shift );
+    };
+
+    /** convert int64 nanoseconds to int64 tics with the fixed-point pair TicsMult / TicsShift.
+     * The result is truncated toward zero and saturated to the limits of int64
+     * @param NSeconds means nanoseconds which should be converted
+     * @return int64 tics value
+     */
+    inline static int64_t NSectoTic ( const int64_t NSeconds )
+    {
+        uint64_t Mult;
+        uint32_t Shift;
+        HighPerTimer::LoadPair ( HighPerTimer::TicsMult, HighPerTimer::TicsShift, Mult, Shift );
+        return HighPerTimer::FixedPointMul ( NSeconds, Mult, Shift );
+    };
+
+    /** convert an array of int64 tics to int64 nanoseconds. Each value is converted as by TictoNSec ( const int64_t ),
+     * but with AVX2 or AVX-512 kernels, if the CPU supports them. $HPTIMER_CONVERSION_KERNEL set to "avx2" or "scalar"
+     * limits the kernel, it is read at the first batch conversion.
+     * @param HPTics points to Count tics which should be converted
+     * @param NSeconds points to the storage for Count converted values, it may be equal to HPTics
+     * @param Count is the number of values
+     */
+    static void TictoNSec ( const int64_t * HPTics, int64_t * NSeconds, const size_t Count );
+
+    /** convert an array of int64 nanoseconds to int64 tics. Each value is converted as by NSectoTic ( const int64_t ),
+     * but with AVX2 or AVX-512 kernels, if the CPU supports them.
+     * @param NSeconds points to Count nanoseconds which should be converted
+     * @param HPTics points to the storage for Count converted values, it may be equal to NSeconds
+     * @param Count is the number of values
+     */
+    static void NSectoTic ( const int64_t * NSeconds, int64_t * HPTics, const size_t Count );
+
+    /** convert an array of int64 tics to timeval structs
+     * @param HPTics points to Count tics which should be converted
+     * @param TV points to the storage for Count timeval structs
+     * @param Count is the number of values
+     * @param Shift tells, if the tics are raw counter values, e.g. taken by CPU_Tics, so the UnixZeroShift has to be added
+     * NOTE: negative values are normalized, so that tv_usec is always within [0, 1000000)
+     */
+    static void TictoTV ( const int64_t * HPTics, timeval * TV, const size_t Count, const bool Shift = true );
+
+    /** convert an array of int64 tics to timespec structs
+     * @param HPTics points to Count tics which should be converted
+     * @param TS points to the storage for Count timespec structs
+     * @param Count is the number of values
+     * @param Shift tells, if the tics are raw counter values, e.g. taken by CPU_Tics, so the UnixZeroShift has to be added
+     * NOTE: negative values are normalized, so that tv_nsec is always within [0, 1000000000)
+     */
+    static void TictoTS ( const int64_t * HPTics, timespec * TS, const size_t Count, const bool Shift = true );
+
+    /** convert an array of timeval structs to int64 tics
+     * @param TV points to Count timeval structs which should be converted
+     * @param HPTics points to the storage for Count converted tics
+     * @param Count is the number of values
+     * @param Shift tells, if raw counter values are requested, so the UnixZeroShift has to be substracted
+     */
+    static void TVtoTic ( const timeval * TV, int64_t * HPTics, const size_t Count, const bool Shift = true );
+
+    /** convert an array of timespec structs to int64 tics
+     * @param TS points to Count timespec structs which should be converted
+     * @param HPTics points to the storage for Count converted tics
+     * @param Count is the number of values
+     * @param Shift tells, if raw counter values are requested, so the UnixZeroShift has to be substracted
+     */
+    static void TStoTic ( const timespec * TS, int64_t * HPTics, const size_t Count, const bool Shift = true );
+
     /** set the timeval struct
      * @param TV is a reference to a timeval struct to be set
      * NOTE: the sign value is ignored since timeval is semantically unsigned
@@ -441,13 +899,25 @@ public:
     /// get HPtimer Frequency value (number of tics within one microsecond)
     inline static int64_t GetHPFrequency()
     {
-        return HighPerTimer::TicsPerUsec;
+        return HighPerTimer::TicsPerUsec.load ( std::memory_order_relaxed );
+    }
+
+    /// get the max value of the timer in tics, the upper limit of the range checks
+    inline static int64_t MaxHPTics()
+    {
+        return HighPerTimer::MaxTics.load ( std::memory_order_relaxed );
+    }
+
+    /// get the min value of the timer in tics, the lower limit of the range checks
+    inline static int64_t MinHPTics()
+    {
+        return HighPerTimer::MinTics.load ( std::memory_order_relaxed );
     }
 
     /// get HPtimer time value (number of nanoseconds within one HighPerTimer period)
     inline static double GetNsecPerTic()
     {
-        return HighPerTimer::NsecPerTic;
+        return HighPerTimer::NsecPerTic.load ( std::memory_order_relaxed );
     }
 
     /// get HPtimer Source value
@@ -455,11 +925,55 @@ public:
     {
         return HighPerTimer::HPTimerSource;
     }     
+
+    /// get the reader of the timer counter, which was resolved from the time source at initialization
+    inline static TicsReader GetTicsReader()
+    {
+        return HighPerTimer::HPTicsReader;
+    }
         
+    /// return true if the calibration was loaded from the cache file instead of measuring it at initialization.
+    /// The cache file is $HPTIMER_CALIBRATION_CACHE, $XDG_RUNTIME_DIR/libHPTimer.cache or /tmp/libHPTimer-<euid>/calibration.cache,
+    /// an empty variable disables the cache
+    inline static bool IsCalibrationCached()
+    {
+        return HighPerTimer::CalibrationCached;
+    }
+
+    /// return true if the calibration was taken from the shared page of a publishing process, see PublishCalibration()
+    inline static bool IsCalibrationShared()
+    {
+        return HighPerTimer::CalibrationShared;
+    }
+
+    /// return true if the reads of the TSC are corrected by the measured offset of the CPU, see InitOptions::MeasureTSCSkew
+    inline static bool IsTSCSkewCorrected()
+    {
+        return HighPerTimer::TSCSkewCorrected;
+    }
+
+    /// get the way the busy-wait tail of the sleeps is chosen
+    inline static SleepMode GetSleepMode()
+    {
+        return HighPerTimer::HPSleepMode;
+    }
+
+    /// return true if the busy-wait tail of the sleeps waits with UMWAIT or MWAITX, see InitOptions::UseMonitorWait
+    inline static bool IsMonitorWaitUsed()
+    {
+        return HighPerTimer::MonitorWait;
+    }
+
+    /// get the current busy-wait tail of the sleeps in nanoseconds
+    inline static int64_t GetBusyWaitNSec()
+    {
+        return HighPerTimer::BusyWaitNSec.load ( std::memory_order_relaxed );
+    }
+
     /// get Unix epoch offset value
     inline static int64_t GetUnixZeroShift()
     {
-        return HighPerTimer::UnixZeroShift;
+        return HighPerTimer::UnixZeroShift.load ( std::memory_order_relaxed );
     }
 
     /// get string of current HighPerTimer source
@@ -473,6 +987,28 @@ public:
      */
     std::string PrintTime ( bool HPTimer_only = false, bool UnixTime = true ) const;        
     
+    /// size of a buffer, which takes each format of FormatTo() with the terminating zero
+    static const size_t FormatLength = 48;
+
+    /** write the time into the buffer of the caller without allocation, locale and locks.
+     * The digits are written directly, the offset of the local time is cached for a quarter of an hour,
+     * so localtime_r() is only called when the cached offset has expired.
+     * @param Buffer is the buffer, which gets the zero terminated text
+     * @param Length is the size of the buffer, FormatLength is always enough
+     * @param Format is the format of the text
+     * @return number of the written characters without the terminating zero, 0 if the buffer is too small
+     */
+    size_t FormatTo ( char * Buffer, const size_t Length, const TimeFormat Format = TimeFormat::Unix ) const;
+
+    /** write the time given in nanoseconds since begin of Unix era into the buffer, as FormatTo()
+     * @param NSeconds is the time in nanoseconds since begin of Unix era, e.g. of GetSysTime() or HPClockSync
+     * @param Buffer is the buffer, which gets the zero terminated text
+     * @param Length is the size of the buffer, FormatLength is always enough
+     * @param Format is the format of the text
+     * @return number of the written characters without the terminating zero, 0 if the buffer is too small
+     */
+    static size_t FormatNSecTo ( const int64_t NSeconds, char * Buffer, const size_t Length, const TimeFormat Format = TimeFormat::Unix );
+
     /** get current value of system time in nanoseconds
      * @return the number of nanoseconds 
      */
@@ -499,49 +1035,321 @@ private:
     /// normalized flag - if it is set, seconds, nanoseconds and sign components are syncronized with mHPTics
     mutable bool mNormalized;
 
-    /// flag for sleep interruption
-    mutable volatile bool mInterrupted; 
-    
-    /// flag for sleep interruption, prevent race conditions
-    mutable volatile bool mCancelled;
+    /// sleep and interruption state for the sleep functions of the timer
+    mutable HPSleeper mSleeper;
        
     /// source for High Performance Timer: TSC, HPET or timer, provided by the OS
     static TimeSource HPTimerSource;
 
-    /// frequency of the HighPerTimer counter, measured int increments per microsecond
-    static int64_t TicsPerUsec;
+    /// reader of the timer counter, resolved from HPTimerSource and the presence of RDTSCP
+    static TicsReader HPTicsReader;
+
+    /// function reading the timer counter in accordance to HPTicsReader, so no dispatch is done on every clock read
+    static int64_t ( *ReadTics ) ();
+
+    /// frequency of the HighPerTimer counter, measured int increments per microsecond.
+    /// It is changed at runtime with the fixed-point pairs, so it is atomic as NsecPerTic and HPJiffies
+    static std::atomic<int64_t> TicsPerUsec;
 
     /// the reciprocal value to TicsPerUsec - number of nanoseconds within one HighPerTimer period
-    static double NsecPerTic;
+    static std::atomic<double> NsecPerTic;
+
+    /// sequence number of the fixed-point pairs, odd while a writer changes them. The pairs are changed at runtime
+    /// by PublishCalibration() and RefreshCalibration(), so the conversions read them by LoadPair()
+    static std::atomic<uint32_t> ConversionSeq;
+
+    /// multiplier of the fixed-point conversion from tics to nanoseconds: NSeconds = ( Tics * NSecMult ) >> NSecShift
+    static std::atomic<uint64_t> NSecMult;
+
+    /// shift of the fixed-point conversion from tics to nanoseconds
+    static std::atomic<uint32_t> NSecShift;
+
+    /// multiplier of the fixed-point conversion from nanoseconds to tics: Tics = ( NSeconds * TicsMult ) >> TicsShift
+    static std::atomic<uint64_t> TicsMult;
+
+    /// shift of the fixed-point conversion from nanoseconds to tics
+    static std::atomic<uint32_t> TicsShift;
     
-    /// timer shift (in tics) between zero of the hardware counter and Unix zero time (01.01.1970). All time systems count from Unix zero time
-    static int64_t UnixZeroShift;
+    /// timer shift (in tics) between zero of the hardware counter and Unix zero time (01.01.1970). All time systems count from Unix zero time.
+    /// It is one word, so a reader racing with a new calibration takes the old or the new shift
+    static std::atomic<int64_t> UnixZeroShift;
+
+    /// the range of the timer in tics, the values of HPTimer_MAX and HPTimer_MIN. The range checks read these words
+    /// instead of the timer objects, which are set at the initialization only, see StoreRangeLimits()
+    static std::atomic<int64_t> MaxTics;
+    static std::atomic<int64_t> MinTics;
+
+    /// the value of MaxTics in nanoseconds, the limit of the timers set from seconds and nanoseconds
+    static std::atomic<uint64_t> MaxNSec;
     
     /// the duration of one tick of the system timer interrupt, the reciprocal value to HZ - the clock interrupt frequency of the particular hardware platform
-    static double HPJiffies;
+    static std::atomic<double> HPJiffies;
+
+    /// the way the busy-wait tail of the sleeps is chosen
+    static SleepMode HPSleepMode;
+
+    /// busy-wait tail of the sleeps in nanoseconds, the OS wait is left this time before the wake up
+    static std::atomic<int64_t> BusyWaitNSec;
+
+    /// the busy-wait tail waits with UMWAIT or MWAITX
+    static bool MonitorWait;
+
+    /// how the time source was chosen. The object is created on first use, since the choice is made during static initialization
+    static SourceSelection & Selection();
+
+    /// the calibration was loaded from the cache file
+    static bool CalibrationCached;
+
+    /// the calibration was taken from the shared page
+    static bool CalibrationShared;
+
+    /// the reads of the TSC are corrected by the offset of the CPU
+    static bool TSCSkewCorrected;
+
+    /// the initialization is done
+    static std::atomic<bool> Initialized;
+
+    /// initialize all values in the order they depend on each other
+    static void InitAll ( const InitOptions & Options );
+
+    /// initialize the timer with the default options, if it is not done yet
+    inline static void EnsureInitialized()
+    {
+        if ( !HighPerTimer::Initialized.load ( std::memory_order_acquire ) )
+        {
+            HighPerTimer::Initialize();
+        }
+    }
+
+    /// reader of the timer counter before the initialization. Initializes the timer and reads the resolved reader
+    static int64_t LazyTics();
     
-    /// initialize the most optimal timer counter
-    /// NOTE: Note this function is called by the system on static system initialization. USER SHALL NEVER ISSUE THIS CALL.
-    static void InitTimerSource();
+    /** initialize the most optimal timer counter. The TSC is rejected if the kernel marked it unstable, if it is not invariant
+     * under a hypervisor, which the kernel does not trust either, if it steps backwards or if its reads trap.
+     * The content of the choice is kept in Selection
+     * NOTE: Note this function is called by the system on static system initialization. USER SHALL NEVER ISSUE THIS CALL.
+     * @param Budget is the time in seconds of the benchmarks of the reads
+     */
+    static void InitTimerSource ( const double Budget );
+
+    /** check the TSC by the kernel and the hypervisor, without a measurement. They are read into Selection.
+     * Within one boot the kernel never trusts a TSC again, which its watchdog has dropped, so a stored choice is checked by it as well
+     * @param TSCAvailable is the result of TSCTimer::InitTSCTimer()
+     * @return the reason of the rejection, empty if the TSC passes the checks
+     */
+    static std::string DistrustTSC ( const bool TSCAvailable );
 
-    /** set the frequency and reciprocal value NsecPerTic depends on timer source
+    /** set the frequency and reciprocal value NsecPerTic depends on timer source.
+    * The TSC frequency is taken from CPUID, the hypervisor or the kernel, if they report it. Otherwise it is calibrated
+    * against CLOCK_MONOTONIC_RAW over 5 * DelayTime.
     * @param DelayTime is time for delay in seconds for frequency initialization process. Can be 0.02 sec, 0.1 sec, 1 sec or 10 sec. 
     * Any other value for this param is not allowed.    
     * NOTE: Note this function is called by the system on static system initialization. USER SHALL NEVER ISSUE THIS CALL.
     */
     static void InitHPFrequency( const double DelayTime );
+
+    /// fenced read of StartStamp() without the check of the initialization, so it is usable during the initialization
+    inline static int64_t ReadStartStamp()
+    {
+        if ( TimeSource::TSC == HighPerTimer::HPTimerSource )
+        {
+            return TSCTimer::StartTSC();
+        }
+        if ( TimeSource::ARM == HighPerTimer::HPTimerSource )
+        {
+            return ARMTimer::FencedCNTVCT();
+        }
+        return HighPerTimer::GetTimerTics();
+    };
+
+    /// measure StampOverhead and ReadOverhead for the current time source
+    /// NOTE: called at the end of the initialization and on the change of the time source. USER SHALL NEVER ISSUE THIS CALL.
+    static void InitStampOverhead();
+
+    /// median overhead in tics of a StartStamp() / StopStamp() pair
+    static int64_t StampOverhead;
+
+    /// median overhead in tics of two reads of the timer counter
+    static int64_t ReadOverhead;
+
+    /// compute the fixed-point pairs NSecMult / NSecShift and TicsMult / TicsShift from NsecPerTic
+    /// NOTE: called at the end of InitHPFrequency. USER SHALL NEVER ISSUE THIS CALL.
+    static void InitFixedPoint();
+
+    /// set both fixed-point pairs under the sequence lock ConversionSeq, concurrent writers are serialized by it
+    static void StoreFixedPoint ( const uint64_t NMult, const uint32_t NShift, const uint64_t TMult, const uint32_t TShift );
+
+    /** read one fixed-point pair of the calibration. A zero multiplier is never calibrated, so the pair is read
+     * again after the initialization, which a conversion before the first read of the clock has to start
+     * @param Mult and Shift are the pair, NSecMult / NSecShift or TicsMult / TicsShift
+     * @param MultValue and ShiftValue get the values of the pair, which belong to one calibration
+     */
+    inline static void LoadPair ( const std::atomic<uint64_t> & Mult, const std::atomic<uint32_t> & Shift, uint64_t & MultValue, uint32_t & ShiftValue )
+    {
+        HighPerTimer::ReadPair ( Mult, Shift, MultValue, ShiftValue );
+        if ( 0 == MultValue )
+        {
+            HighPerTimer::InitForConversion();
+            HighPerTimer::ReadPair ( Mult, Shift, MultValue, ShiftValue );
+        }
+    }
+
+    /// initialize the timer for a conversion, unless the conversion is made by the initialization itself
+    static void InitForConversion();
+
+    /// read one fixed-point pair under the sequence lock ConversionSeq. The loop is left at the first try,
+    /// unless a new calibration is stored at the same time
+    inline static void ReadPair ( const std::atomic<uint64_t> & Mult, const std::atomic<uint32_t> & Shift, uint64_t & MultValue, uint32_t & ShiftValue )
+    {
+        uint32_t Seq;
+        do
+        {
+            Seq = HighPerTimer::ConversionSeq.load ( std::memory_order_acquire );
+            MultValue = Mult.load ( std::memory_order_relaxed );
+            ShiftValue = Shift.load ( std::memory_order_relaxed );
+            std::atomic_thread_fence ( std::memory_order_acquire );
+        }
+        while ( ( Seq & 1 ) || ( Seq != HighPerTimer::ConversionSeq.load ( std::memory_order_relaxed ) ) );
+    }
+
+    /** multiply Value by Mult and shift the 128-bit product right by Shift
+     * @return the result, saturated to the max value of uint64
+     */
+    inline static uint64_t MulShift ( const uint64_t Value, const uint64_t Mult, const uint32_t Shift )
+    {
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 Product ( ( static_cast<unsigned __int128> ( Value ) * Mult ) >> Shift );
+        if ( Product >> 64 )
+        {
+            return UINT64_MAX;
+        }
+        return static_cast<uint64_t> ( Product );
+#else
+        // the platform has no 128-bit integer, compose the product from the 32-bit halves
+        uint64_t LoLo ( ( Value & 0xFFFFFFFF ) * ( Mult & 0xFFFFFFFF ) );
+        uint64_t HiLo ( ( Value >> 32 ) * ( Mult & 0xFFFFFFFF ) );
+        uint64_t LoHi ( ( Value & 0xFFFFFFFF ) * ( Mult >> 32 ) );
+        uint64_t HiHi ( ( Value >> 32 ) * ( Mult >> 32 ) );
+        uint64_t Cross ( ( LoLo >> 32 ) + ( HiLo & 0xFFFFFFFF ) + ( LoHi & 0xFFFFFFFF ) );
+        uint64_t High ( HiHi + ( HiLo >> 32 ) + ( LoHi >> 32 ) + ( Cross >> 32 ) );
+        uint64_t Low ( ( Cross << 32 ) | ( LoLo & 0xFFFFFFFF ) );
+        if ( Shift >= 64 )
+        {
+            return High >> ( Shift - 64 );
+        }
+        if ( 0 == Shift )
+        {
+            return High ? UINT64_MAX : Low;
+        }
+        if ( High >> Shift )
+        {
+            return UINT64_MAX;
+        }
+        return ( High << ( 64 - Shift ) ) | ( Low >> Shift );
+#endif
+    };
+
+    /** signed fixed-point multiplication, the sign is applied to the product of the magnitude
+     * @return the result, truncated toward zero and saturated to the limits of int64
+     */
+    inline static int64_t FixedPointMul ( const int64_t Value, const uint64_t Mult, const uint32_t Shift )
+    {
+        if ( Value < 0 )
+        {
+            uint64_t Abs ( HighPerTimer::MulShift ( 0 - static_cast<uint64_t> ( Value ), Mult, Shift ) );
+            return ( Abs > ( static_cast<uint64_t> ( INT64_MAX ) + 1 ) ) ? INT64_MIN : static_cast<int64_t> ( 0 - Abs );
+        }
+        uint64_t Abs ( HighPerTimer::MulShift ( static_cast<uint64_t> ( Value ), Mult, Shift ) );
+        return ( Abs > static_cast<uint64_t> ( INT64_MAX ) ) ? INT64_MAX : static_cast<int64_t> ( Abs );
+    };
+
+    /// signed fixed-point multiplication of an array, performed with the vector kernel which suits the CPU
+    static void FixedPointMul ( const int64_t * Values, int64_t * Results, const size_t Count, const uint64_t Mult, const uint32_t Shift );
          
     /// initialize Max and Min HighPerTimer which save max and min values of Seconds, NSeconds, HPTics
-    /// when HPET is timer source, the max possible value of NSecPerTic is 100 and it can be caused a possible overflow and a loss of accuracy calculating Seconds and NSeconds parts of timer
-    /// so in HPET case it is more reliable to decrease limits for max and min HPTimer values 
-    /// when TSC or OS clock are timer sources, the NSecPerTic value is always less than zero. So it is still safe to limit max and min HPTimer values within max and min values of int64 type 
+    /// the limits are the tics, whose value in nanoseconds still fits into int64.
+    /// when HPET is timer source, NSecPerTic is greater than one, so the limits are decreased accordingly
+    /// when TSC or OS clock are timer sources, the NSecPerTic value is not greater than one. So the limits are the max and min values of int64 type 
     static void InitMaxMinHPTimer();
+
+    /// set the range limits of the checks from the current fixed-point pair, without HPTimer_MAX and HPTimer_MIN.
+    /// The runtime calibration changes only these, as other threads may read the timer objects meanwhile
+    static void StoreRangeLimits();
     
     /// initialize the value of jiffies depends on the clock interrupt frequency of the particular hardware platform
     static void InitSecPerJiffy();
 
+    /// measure the wakeup overshoot of the OS wait and set the busy-wait tail of the sleeps to its p99
+    static void InitBusyWait();
+
+    /** load time source, frequency, jiffies and busy-wait tail from the cache file and initialize the timer with them.
+     * The cache is only valid for the same CPU brand string, TSC flags and boot id.
+     * @return true if the cache was valid, otherwise nothing is changed except of the TSC flags and the calibration has to be measured
+     */
+    static bool LoadCalibration();
+
+    /// save the measured calibration to the cache file
+    static void SaveCalibration();
+
+    /** get the CPU brand string, the boot id and the TSC flags, which have to be equal for a stored calibration
+     * @param TSCAvailable is set to the result of TSCTimer::InitTSCTimer(), if it is given. Before the calibration is measured,
+     * the brand and the flags are not known yet, so the TSC is probed by CPUID first, which is cheap against a measurement
+     * @return the key, empty if the boot id is unknown
+     */
+    static std::string CalibrationKey ( bool * TSCAvailable = NULL );
+
+    /** set the time source of a stored calibration, if it is usable on this host
+     * @param Source is the stored value of TimeSource
+     * @param FreqOrigin is the stored value of TSCFreqOrigin
+     * @param TSCAvailable is the result of TSCTimer::InitTSCTimer()
+     * @param AnySource allows a source, which the automatic choice does not take if the TSC is trusted
+     * @param TSCRejected tells, that the measurement of the stored calibration rejected a TSC, which passed DistrustTSC(),
+     *        e.g. because its reads trap. A stored HPET or OS source is valid then, the measurement would reject it again
+     * @return false if the source is not usable, e.g. a TSC, which the kernel has dropped since, nothing is changed then
+     */
+    static bool RestoreSource ( const int Source, const int FreqOrigin, const bool TSCAvailable, const bool AnySource,
+                                const bool TSCRejected );
+
+    /** take the calibration from the shared page, if it was published on this boot on the same CPU.
+     * NOTE: implemented in CalibrationPage.cpp
+     * @param Initial tells, that the source has to be restored at the initialization, otherwise only a changed
+     *        frequency and shift of the same source are taken
+     * @return true if the calibration was taken
+     */
+    static bool AttachCalibration ( const bool Initial );
+
+    /** measure the TSC offsets between the CPUs, if the TSC is the time source, and correct them or leave the TSC,
+     * if they are above the limit. NOTE: implemented in TSCSkew.cpp. USER SHALL NEVER ISSUE THIS CALL.
+     * @param MaxSkew is the tolerated offset in seconds
+     * @param Correct allows the correction of the offsets instead of leaving the TSC
+     */
+    static void InitTSCSkew ( const double MaxSkew, const bool Correct );
+
+    /** account the overshoot of one OS wait in the counts of the thread, the busy-wait tail is updated
+     * every OvershootUpdate accounted waits of the thread
+     * @param NSeconds is the time in nanoseconds, the wait came back later than requested
+     */
+    static void AddWakeupOvershoot ( const int64_t NSeconds );
+
+    /// resolve the reader of the timer counter from the current time source.
+    /// NOTE: called whenever the time source is set. USER SHALL NEVER ISSUE THIS CALL.
+    static void InitTicsReader();
+
     /// get current tics depends on timer source
-    static int64_t GetTimerTics();
+    inline static int64_t GetTimerTics()
+    {
+        return HighPerTimer::ReadTics();
+    };
+
+    /** write the time given by the sign and the magnitude of seconds and nanoseconds, as FormatTo().
+     * NOTE: implemented in TimeFormat.cpp
+     */
+    static size_t FormatParts ( const bool Negative, const int64_t Seconds, const int64_t NSeconds,
+                                char * Buffer, const size_t Length, const TimeFormat Format );
+
+    /// get current tics with the given reader, without any dispatch
+    template <TicsReader Reader> 
+    inline static int64_t ReaderTics();
 
     /** Normalize the stucture - set members Seconds, NSeconds and Sign from the mHPTics value.
      * This is necessare because almost all functions will be have in default configuration in the lazy behavior
@@ -549,6 +1357,50 @@ private:
     void Normalize() const;      
 };
 
+/// read the TSC Timer with the RDTSC instruction
+template <>
+inline int64_t HighPerTimer::ReaderTics<TicsReader::RDTSC>()
+{
+    return TSCTimer::RDTSC();
+}
+
+/// read the TSC Timer with the RDTSCP instruction
+template <>
+inline int64_t HighPerTimer::ReaderTics<TicsReader::RDTSCP>()
+{
+    return TSCTimer::RDTSCP();
+}
+
+/// read the TSC Timer with the RDTSCP instruction and subtract the offset of the CPU, on which it was read
+template <>
+inline int64_t HighPerTimer::ReaderTics<TicsReader::RDTSCPOffset>()
+{
+    uint32_t Aux;
+    int64_t Tsc ( TSCTimer::RDTSCP ( Aux ) );
+    return Tsc - TSCTimer::CpuOffset[Aux & TSCTimer::TSCAuxCpuMask];
+}
+
+/// read the HPET main counter
+template <>
+inline int64_t HighPerTimer::ReaderTics<TicsReader::HPET>()
+{
+    return HPETTimer::GetHPETTics();
+}
+
+/// read the timer, provided by the OS
+template <>
+inline int64_t HighPerTimer::ReaderTics<TicsReader::OS>()
+{
+    return OSTimer::GetOSTimerTics();
+}
+
+/// read the virtual counter of the ARM generic timer
+template <>
+inline int64_t HighPerTimer::ReaderTics<TicsReader::CNTVCT>()
+{
+    return ARMTimer::CNTVCT();
+}
+
 /** adding operator for HighPerTimer, using offset in seconds
  * @param Timer is a HighPerTimer summand
  * @param SecOffset is an seconds summand
@@ -573,13 +1425,13 @@ HighPerTimer operator- ( const HighPerTimer & HPTimer, const uint64_t SecOffset
  */
 inline HighPerTimer operator+ ( const HighPerTimer & Timer1, const HighPerTimer & Timer2 )
 {
-    if ( ( Timer2.HPTics() > 0 ) && ( ( HighPerTimer::HPTimer_MAX.HPTics() - ( Timer2.HPTics() ) ) <= ( Timer1.HPTics() ) ) ) 
+    if ( ( Timer2.HPTics() > 0 ) && ( ( HighPerTimer::MaxHPTics() - ( Timer2.HPTics() ) ) <= ( Timer1.HPTics() ) ) ) 
     {
-        throw  std::out_of_range ( "HPTimer overflow" );
+        HPTimer::ThrowOverflow();
     }
-    if ( ( Timer2.HPTics() < 0 ) && ( ( HighPerTimer::HPTimer_MIN.HPTics() - ( Timer2.HPTics() ) ) >= ( Timer1.HPTics() ) ) ) 
+    if ( ( Timer2.HPTics() < 0 ) && ( ( HighPerTimer::MinHPTics() - ( Timer2.HPTics() ) ) >= ( Timer1.HPTics() ) ) ) 
     {
-        throw  std::out_of_range ( "HPTimer overflow" );
+        HPTimer::ThrowOverflow();
     } 
     return HighPerTimer { ( Timer1.HPTics() + Timer2.HPTics() ), false };
 }
@@ -592,13 +1444,13 @@ inline HighPerTimer operator+ ( const HighPerTimer & Timer1, const HighPerTimer
  */
 inline HighPerTimer operator- ( const HighPerTimer & Timer1, const HighPerTimer & Timer2 )
 {
-    if ( ( Timer2.HPTics() > 0 ) && ( ( HighPerTimer::HPTimer_MIN.HPTics() + ( Timer2.HPTics() ) ) >= ( Timer1.HPTics() ) ) ) 
+    if ( ( Timer2.HPTics() > 0 ) && ( ( HighPerTimer::MinHPTics() + ( Timer2.HPTics() ) ) >= ( Timer1.HPTics() ) ) ) 
     {
-        throw  std::out_of_range ( "HPTimer overflow" );
+        HPTimer::ThrowOverflow();
     }
-    if ( ( Timer2.HPTics() < 0 ) && ( ( HighPerTimer::HPTimer_MAX.HPTics() + ( Timer2.HPTics() ) ) <= ( Timer1.HPTics() ) ) ) 
+    if ( ( Timer2.HPTics() < 0 ) && ( ( HighPerTimer::MaxHPTics() + ( Timer2.HPTics() ) ) <= ( Timer1.HPTics() ) ) ) 
     {
-        throw  std::out_of_range ( "HPTimer overflow" );
+        HPTimer::ThrowOverflow();
     }
    return HighPerTimer { ( Timer1.HPTics() - Timer2.HPTics() ), false };
 }
@@ -609,7 +1461,15 @@ inline HighPerTimer operator- ( const HighPerTimer & Timer1, const HighPerTimer
 */
 inline std::ostream & operator<< ( std::ostream & OStr, const HighPerTimer & Timer )
 {
-    OStr << Timer.PrintTime();
+    // the same text as by PrintTime(), the seconds are right aligned to ten characters
+    char Buffer[HighPerTimer::FormatLength];
+    size_t Size ( Timer.FormatTo ( Buffer, sizeof ( Buffer ) ) );
+    size_t Point ( static_cast<const char *> ( memchr ( Buffer, '.', Size ) ) - Buffer );
+    for ( ; Point < 10; ++Point )
+    {
+        OStr.put ( ' ' );
+    }
+    OStr.write ( Buffer, Size );
     return OStr;
 }
 
@@ -629,6 +1489,30 @@ public:
         return TSCTimer::HasRDTSCPinst;
     }
 
+    /// return true if CPU_TicsAndCpu takes the CPU from IA32_TSC_AUX by RDTSCP, false if it calls getcpu()
+    inline static bool IsTSCAuxCpu()
+    {
+        return TSCTimer::TSCAuxIsCpu;
+    }
+
+    /// get the measured offset in tics of the TSC of the CPU against the first CPU of the process, 0 if not measured
+    inline static int64_t GetTSCOffset ( const uint32_t Cpu )
+    {
+        return Cpu < TSCTimer::CpuOffset.size() ? TSCTimer::CpuOffset[Cpu] : 0;
+    }
+
+    /// get the largest absolute TSC offset in tics between the CPUs, 0 if not measured
+    inline static int64_t GetTSCSkew()
+    {
+        return TSCTimer::MaxCpuOffset;
+    }
+
+    /// get the uncertainty in tics of the measured TSC offsets
+    inline static int64_t GetTSCSkewError()
+    {
+        return TSCTimer::CpuOffsetError;
+    }
+
     /// return true if Constant TSC is available
     inline static bool IsConstantTSC()
     {
@@ -641,6 +1525,30 @@ public:
         return TSCTimer::HasInvariantTSC;
     }
 
+    /// return true if AVX2 instructions can be used, e.g. by the batch conversions of HighPerTimer
+    inline static bool IsAVX2Supported()
+    {
+        return TSCTimer::HasAVX2;
+    }
+
+    /// return true if AVX-512 foundation instructions can be used, e.g. by the batch conversions of HighPerTimer
+    inline static bool IsAVX512Supported()
+    {
+        return TSCTimer::HasAVX512;
+    }
+
+    /// return true if UMONITOR, UMWAIT and TPAUSE can be used
+    inline static bool IsWaitPkgSupported()
+    {
+        return TSCTimer::HasWaitPkg;
+    }
+
+    /// return true if MONITORX and MWAITX can be used
+    inline static bool IsMonitorXSupported()
+    {
+        return TSCTimer::HasMonitorX;
+    }
+
     /// get CPU Brand string
     inline static std::string GetBrandString()
     {
@@ -652,6 +1560,49 @@ public:
     {
         return HPETTimer::HPETFailReason;
     }       
+
+    /// get the origin of the TSC frequency
+    inline static TSCFreqOrigin GetTSCFreqOrigin()
+    {
+        return TSCTimer::FreqOrigin;
+    }
+
+    /// get the frequency of the ARM generic timer in Hz, 0 if it is not available
+    inline static uint64_t GetARMTimerFrequency()
+    {
+        return ARMTimer::Frequency;
+    }
+
+    /// return true if the OS time source reads clock_gettime() of the vDSO directly
+    inline static bool IsOSClockVDSO()
+    {
+        return OSTimer::ViaVDSO;
+    }
+
+    /// get the median cost of one HPET read in nanoseconds, measured when the time source was chosen without TSC. 0 if it was not measured
+    inline static double GetHPETReadNSec()
+    {
+        return HPETTimer::ReadNSec;
+    }
+
+    /// get the median cost of one read of the OS timer in nanoseconds, measured when the time source was chosen without TSC. 0 if it was not measured
+    inline static double GetOSReadNSec()
+    {
+        return OSTimer::ReadNSec;
+    }
+
+    /// return true if the CPU runs under a hypervisor
+    inline static bool IsHypervisor()
+    {
+        return TSCTimer::HasHypervisor;
+    }
+
+    /// get the candidates, the measurements and the reason of the choice of the time source at initialization.
+    /// A later SetTimerSource() does not change it
+    inline static const SourceSelection & GetSourceSelection()
+    {
+        return HighPerTimer::Selection();
+    }
 };
 
 
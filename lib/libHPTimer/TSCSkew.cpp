@@ -0,0 +1,197 @@
+/*
+ * @file   TSCSkew.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Measurement of the TSC offsets between the CPUs and the correction of the reads by them
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include "HighPerTimer.h"
+
+// number of request and reply round trips to each CPU, the shortest one is taken
+constexpr uint32_t SkewRounds = 2000;
+
+// number of polls of a reply, after which the probe is given up, e.g. if its CPU is not scheduled
+constexpr uint64_t SkewSpinLimit = 1ULL << 28;
+
+// reply of a probe, which could not be pinned to its CPU
+constexpr uint32_t ProbeFailed = UINT32_MAX;
+
+namespace HPTimer
+{
+
+std::vector<int64_t> TSCTimer::CpuOffset;
+int64_t TSCTimer::MaxCpuOffset ( 0 );
+int64_t TSCTimer::CpuOffsetError ( 0 );
+bool HighPerTimer::TSCSkewCorrected ( false );
+
+// the words of the requests and of the replies are kept in different cache lines,
+// so each round trip moves exactly two lines between the CPUs
+struct PingPong
+{
+    alignas ( 64 ) std::atomic<uint32_t> mRequest;
+    alignas ( 64 ) std::atomic<uint32_t> mReply;
+    int64_t mProbeTics;
+    std::atomic<bool> mAbort;
+};
+
+// measure the offset of the TSC of the CPU against the one of the calling thread. The probe is pinned to its CPU
+// and answers each request with a read of its TSC. The probe read lies within the round trip,
+// so the offset to its middle is wrong by half of the round trip at most
+bool TSCTimer::MeasureCpuOffset ( const int Cpu, int64_t & Offset, int64_t & Error )
+{
+    PingPong Line;
+    Line.mRequest.store ( 0, std::memory_order_relaxed );
+    Line.mReply.store ( 0, std::memory_order_relaxed );
+    Line.mProbeTics = 0;
+    Line.mAbort.store ( false, std::memory_order_relaxed );
+    std::thread Probe ( [&Line, Cpu] ()
+    {
+        cpu_set_t Set;
+        CPU_ZERO ( &Set );
+        CPU_SET ( Cpu, &Set );
+        if ( 0 != pthread_setaffinity_np ( pthread_self(), sizeof ( Set ), &Set ) )
+        {
+            Line.mReply.store ( ProbeFailed, std::memory_order_release );
+            return;
+        }
+        for ( uint32_t Round = 1; Round <= SkewRounds; ++Round )
+        {
+            while ( Line.mRequest.load ( std::memory_order_acquire ) != Round )
+            {
+                if ( Line.mAbort.load ( std::memory_order_relaxed ) )
+                {
+                    return;
+                }
+            }
+            Line.mProbeTics = TSCTimer::StartTSC();
+            Line.mReply.store ( Round, std::memory_order_release );
+        }
+    } );
+
+    int64_t Shortest ( INT64_MAX );
+    bool Answered ( true );
+    for ( uint32_t Round = 1; Answered && ( Round <= SkewRounds ); ++Round )
+    {
+        int64_t Before ( TSCTimer::StartTSC() );
+        Line.mRequest.store ( Round, std::memory_order_release );
+        uint64_t Spins ( 0 );
+        uint32_t Reply;
+        while ( ( Reply = Line.mReply.load ( std::memory_order_acquire ) ) != Round )
+        {
+            if ( ( ProbeFailed == Reply ) || ( ++Spins > SkewSpinLimit ) )
+            {
+                Answered = false;
+                break;
+            }
+        }
+        int64_t After ( TSCTimer::StartTSC() );
+        if ( Answered && ( After - Before < Shortest ) )
+        {
+            Shortest = After - Before;
+            Offset = Line.mProbeTics - Before - Shortest / 2;
+        }
+    }
+    Line.mAbort.store ( true, std::memory_order_relaxed );
+    Probe.join();
+    Error = ( Shortest + 1 ) / 2;
+    return Answered;
+}
+
+// the first CPU of the calling thread is the reference, a CPU, which does not answer, keeps the offset 0
+bool TSCTimer::MeasureCpuOffsets()
+{
+    cpu_set_t OldSet;
+    if ( 0 != pthread_getaffinity_np ( pthread_self(), sizeof ( OldSet ), &OldSet ) )
+    {
+        return false;
+    }
+    std::vector<int> Cpus;
+    for ( int Cpu = 0; ( Cpu < CPU_SETSIZE ) && ( Cpu <= static_cast<int> ( TSCAuxCpuMask ) ); ++Cpu )
+    {
+        if ( CPU_ISSET ( Cpu, &OldSet ) )
+        {
+            Cpus.push_back ( Cpu );
+        }
+    }
+    if ( Cpus.size() < 2 )
+    {
+        return false;
+    }
+    cpu_set_t Reference;
+    CPU_ZERO ( &Reference );
+    CPU_SET ( Cpus[0], &Reference );
+    if ( 0 != pthread_setaffinity_np ( pthread_self(), sizeof ( Reference ), &Reference ) )
+    {
+        return false;
+    }
+
+    TSCTimer::CpuOffset.assign ( TSCAuxCpuMask + 1, 0 );
+    TSCTimer::MaxCpuOffset = 0;
+    TSCTimer::CpuOffsetError = 0;
+    uint32_t Measured ( 1 );
+    for ( size_t i = 1; i < Cpus.size(); ++i )
+    {
+        int64_t Offset ( 0 ), Error ( 0 );
+        if ( TSCTimer::MeasureCpuOffset ( Cpus[i], Offset, Error ) )
+        {
+            TSCTimer::CpuOffset[Cpus[i]] = Offset;
+            TSCTimer::MaxCpuOffset = std::max<int64_t> ( TSCTimer::MaxCpuOffset, std::llabs ( Offset ) );
+            TSCTimer::CpuOffsetError = std::max ( TSCTimer::CpuOffsetError, Error );
+            ++Measured;
+        }
+    }
+    pthread_setaffinity_np ( pthread_self(), sizeof ( OldSet ), &OldSet );
+    return Measured >= 2;
+}
+
+// a skew within the limit is left as it is. A larger one is corrected on each read, if RDTSCP tells the CPU
+// and the offsets are known precisely enough, otherwise the TSC is left for the HPET or the OS
+void HighPerTimer::InitTSCSkew ( const double MaxSkew, const bool Correct )
+{
+    if ( ( TimeSource::TSC != HighPerTimer::HPTimerSource ) || !TSCTimer::MeasureCpuOffsets() )
+    {
+        return;
+    }
+    int64_t Limit ( HighPerTimer::NSectoTic ( static_cast<int64_t> ( MaxSkew * 1e9 ) ) );
+    if ( TSCTimer::MaxCpuOffset + TSCTimer::CpuOffsetError <= Limit )
+    {
+        return;
+    }
+    if ( Correct && TSCTimer::TSCAuxIsCpu && ( TSCTimer::CpuOffsetError <= Limit ) )
+    {
+        HighPerTimer::TSCSkewCorrected = true;
+        HighPerTimer::InitTicsReader();
+        HighPerTimer::InitUnixZeroShift();
+        HighPerTimer::InitStampOverhead();
+        return;
+    }
+    if ( TimeSource::HPET != HighPerTimer::SetTimerSource ( TimeSource::HPET ) )
+    {
+        HighPerTimer::SetTimerSource ( TimeSource::OS );
+    }
+    HighPerTimer::Selection().Chosen = HighPerTimer::HPTimerSource;
+    HighPerTimer::Selection().Reason += "; replaced, since the skew of the TSCs between the CPUs is not correctable";
+}
+
+} // namespace HPTimer
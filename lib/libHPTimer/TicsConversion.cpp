@@ -0,0 +1,289 @@
+/*
+ * @file   TicsConversion.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Batch conversion of arrays of tics into nanoseconds, timeval and timespec structs and back
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <sys/time.h>
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+#include <immintrin.h>
+#endif
+#include "HighPerTimer.h"
+
+// C++ macro for one billion ( 10^9 )
+constexpr int64_t ONE_BILLION = 1000000000LL;
+
+// number of values, which are converted at once on the stack for the timeval and timespec conversions
+constexpr size_t ChunkSize = 256;
+
+// environment variable, which limits the vector kernel of the batch conversions
+static const char KernelEnv[] = "HPTIMER_CONVERSION_KERNEL";
+
+namespace HPTimer
+{
+
+// vector kernel of the fixed-point multiplication
+// @return the number of converted values, the rest of the values is left for the scalar loop
+typedef size_t ( *FixedPointKernel ) ( const int64_t * Values, int64_t * Results, const size_t Count, const uint64_t Mult, const uint32_t Shift );
+
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+
+// the AVX-512 intrinsics of some gcc versions start from an undefined register, which is reported falsely
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// AVX2 kernel: four values at once. There is no 64-bit multiplication in AVX2,
+// so the 128-bit product is composed of the 32-bit halves, like in HighPerTimer::MulShift
+__attribute__ ( ( target ( "avx2" ) ) )
+static size_t FixedPointMulAVX2 ( const int64_t * Values, int64_t * Results, const size_t Count, const uint64_t Mult, const uint32_t Shift )
+{
+    const __m256i Zero = _mm256_setzero_si256();
+    const __m256i Low32 = _mm256_set1_epi64x ( 0xFFFFFFFF );
+    const __m256i MultLow = _mm256_set1_epi64x ( Mult & 0xFFFFFFFF );
+    const __m256i MultHigh = _mm256_set1_epi64x ( Mult >> 32 );
+    const __m256i Max = _mm256_set1_epi64x ( INT64_MAX );
+    // shift counts for the shift of the 128-bit product, a count greater than 63 clears the lane
+    const __m128i ShiftLow = _mm_cvtsi32_si128 ( Shift );
+    const __m128i ShiftHighLeft = _mm_cvtsi32_si128 ( Shift < 64 ? 64 - Shift : 64 );
+    const __m128i ShiftHighRight = _mm_cvtsi32_si128 ( Shift < 64 ? 64 : Shift - 64 );
+
+    size_t i ( 0 );
+    for ( ; i + 4 <= Count; i += 4 )
+    {
+        __m256i Value = _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( Values + i ) );
+        // convert the magnitude, the sign is applied to the product
+        __m256i Sign = _mm256_cmpgt_epi64 ( Zero, Value );
+        __m256i Abs = _mm256_sub_epi64 ( _mm256_xor_si256 ( Value, Sign ), Sign );
+        __m256i AbsHigh = _mm256_srli_epi64 ( Abs, 32 );
+
+        __m256i LoLo = _mm256_mul_epu32 ( Abs, MultLow );
+        __m256i HiLo = _mm256_mul_epu32 ( AbsHigh, MultLow );
+        __m256i LoHi = _mm256_mul_epu32 ( Abs, MultHigh );
+        __m256i HiHi = _mm256_mul_epu32 ( AbsHigh, MultHigh );
+        __m256i Cross = _mm256_add_epi64 ( _mm256_srli_epi64 ( LoLo, 32 ), _mm256_add_epi64 ( _mm256_and_si256 ( HiLo, Low32 ), _mm256_and_si256 ( LoHi, Low32 ) ) );
+        __m256i High = _mm256_add_epi64 ( _mm256_add_epi64 ( HiHi, _mm256_srli_epi64 ( Cross, 32 ) ), _mm256_add_epi64 ( _mm256_srli_epi64 ( HiLo, 32 ), _mm256_srli_epi64 ( LoHi, 32 ) ) );
+        __m256i Low = _mm256_or_si256 ( _mm256_slli_epi64 ( Cross, 32 ), _mm256_and_si256 ( LoLo, Low32 ) );
+
+        __m256i Product = _mm256_or_si256 ( _mm256_or_si256 ( _mm256_sll_epi64 ( High, ShiftHighLeft ), _mm256_srl_epi64 ( High, ShiftHighRight ) ), _mm256_srl_epi64 ( Low, ShiftLow ) );
+        // the product does not fit into 64 bit, set all bits for the saturation below
+        __m256i Overflow = _mm256_xor_si256 ( _mm256_cmpeq_epi64 ( _mm256_srl_epi64 ( High, ShiftLow ), Zero ), _mm256_cmpeq_epi64 ( Zero, Zero ) );
+        Product = _mm256_or_si256 ( Product, Overflow );
+
+        // saturate, if the magnitude does not fit into int64
+        __m256i Saturated = _mm256_cmpgt_epi64 ( Zero, Product );
+        __m256i Result = _mm256_sub_epi64 ( _mm256_xor_si256 ( Product, Sign ), Sign );
+        Result = _mm256_blendv_epi8 ( Result, _mm256_xor_si256 ( Max, Sign ), Saturated );
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( Results + i ), Result );
+    }
+    return i;
+}
+
+// AVX-512 kernel: eight values at once, the same steps as the AVX2 kernel with the mask registers
+__attribute__ ( ( target ( "avx512f" ) ) )
+static size_t FixedPointMulAVX512 ( const int64_t * Values, int64_t * Results, const size_t Count, const uint64_t Mult, const uint32_t Shift )
+{
+    const __m512i Zero = _mm512_setzero_si512();
+    const __m512i AllBits = _mm512_set1_epi64 ( -1 );
+    const __m512i Low32 = _mm512_set1_epi64 ( 0xFFFFFFFF );
+    const __m512i MultLow = _mm512_set1_epi64 ( Mult & 0xFFFFFFFF );
+    const __m512i MultHigh = _mm512_set1_epi64 ( Mult >> 32 );
+    const __m512i Max = _mm512_set1_epi64 ( INT64_MAX );
+    const __m512i Min = _mm512_set1_epi64 ( INT64_MIN );
+    const __m128i ShiftLow = _mm_cvtsi32_si128 ( Shift );
+    const __m128i ShiftHighLeft = _mm_cvtsi32_si128 ( Shift < 64 ? 64 - Shift : 64 );
+    const __m128i ShiftHighRight = _mm_cvtsi32_si128 ( Shift < 64 ? 64 : Shift - 64 );
+
+    size_t i ( 0 );
+    for ( ; i + 8 <= Count; i += 8 )
+    {
+        __m512i Value = _mm512_loadu_si512 ( Values + i );
+        __mmask8 Sign = _mm512_cmplt_epi64_mask ( Value, Zero );
+        __m512i Abs = _mm512_abs_epi64 ( Value );
+        __m512i AbsHigh = _mm512_srli_epi64 ( Abs, 32 );
+
+        __m512i LoLo = _mm512_mul_epu32 ( Abs, MultLow );
+        __m512i HiLo = _mm512_mul_epu32 ( AbsHigh, MultLow );
+        __m512i LoHi = _mm512_mul_epu32 ( Abs, MultHigh );
+        __m512i HiHi = _mm512_mul_epu32 ( AbsHigh, MultHigh );
+        __m512i Cross = _mm512_add_epi64 ( _mm512_srli_epi64 ( LoLo, 32 ), _mm512_add_epi64 ( _mm512_and_si512 ( HiLo, Low32 ), _mm512_and_si512 ( LoHi, Low32 ) ) );
+        __m512i High = _mm512_add_epi64 ( _mm512_add_epi64 ( HiHi, _mm512_srli_epi64 ( Cross, 32 ) ), _mm512_add_epi64 ( _mm512_srli_epi64 ( HiLo, 32 ), _mm512_srli_epi64 ( LoHi, 32 ) ) );
+        __m512i Low = _mm512_or_si512 ( _mm512_slli_epi64 ( Cross, 32 ), _mm512_and_si512 ( LoLo, Low32 ) );
+
+        __m512i Product = _mm512_or_si512 ( _mm512_or_si512 ( _mm512_sll_epi64 ( High, ShiftHighLeft ), _mm512_srl_epi64 ( High, ShiftHighRight ) ), _mm512_srl_epi64 ( Low, ShiftLow ) );
+        __m512i OverflowBits = _mm512_srl_epi64 ( High, ShiftLow );
+        Product = _mm512_mask_mov_epi64 ( Product, _mm512_test_epi64_mask ( OverflowBits, OverflowBits ), AllBits );
+
+        __mmask8 Saturated = _mm512_cmplt_epi64_mask ( Product, Zero );
+        __m512i Result = _mm512_mask_sub_epi64 ( Product, Sign, Zero, Product );
+        Result = _mm512_mask_mov_epi64 ( Result, Saturated, _mm512_mask_mov_epi64 ( Max, Sign, Min ) );
+        _mm512_storeu_si512 ( Results + i, Result );
+    }
+    return i;
+}
+
+#endif
+
+// no vector kernel available: everything is left for the scalar loop.
+// on AArch64 the scalar loop is kept, since the MUL / UMULH pair is faster than a composition of the 32-bit halves in NEON
+static size_t FixedPointMulNone ( const int64_t * Values, int64_t * Results, const size_t Count, const uint64_t Mult, const uint32_t Shift )
+{
+    return 0;
+}
+
+// select the kernel for the features of the CPU, which are detected on the HighPerTimer initialization.
+// $HPTIMER_CONVERSION_KERNEL limits the choice to "avx2" or "scalar", e.g. to compare the kernels on one host
+static FixedPointKernel SelectKernel()
+{
+    const char * Env ( getenv ( KernelEnv ) );
+    std::string Limit ( Env ? Env : "" );
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+    if ( ( Limit.empty() || ( "avx512" == Limit ) ) && AccessTimeHardware::IsAVX512Supported() )
+    {
+        return &FixedPointMulAVX512;
+    }
+    if ( ( "scalar" != Limit ) && AccessTimeHardware::IsAVX2Supported() )
+    {
+        return &FixedPointMulAVX2;
+    }
+#endif
+    return &FixedPointMulNone;
+}
+
+// split signed nanoseconds into seconds and a nanoseconds part within [0, 10^9)
+static inline void SplitNSec ( const int64_t NSeconds, int64_t & Seconds, int64_t & Fraction )
+{
+    Seconds = NSeconds / ONE_BILLION;
+    Fraction = NSeconds % ONE_BILLION;
+    if ( Fraction < 0 )
+    {
+        Fraction += ONE_BILLION;
+        Seconds -= 1;
+    }
+}
+
+// fixed-point multiplication of an array, the vector kernel is resolved once at the first call.
+// The features of the CPU are detected by the initialization, so it is done before, e.g. for the pair of a tics log
+void HighPerTimer::FixedPointMul ( const int64_t * Values, int64_t * Results, const size_t Count, const uint64_t Mult, const uint32_t Shift )
+{
+    static const FixedPointKernel Kernel = ( HighPerTimer::InitForConversion(), SelectKernel() );
+    size_t i = Kernel ( Values, Results, Count, Mult, Shift );
+    for ( ; i < Count; i++ )
+    {
+        Results[i] = HighPerTimer::FixedPointMul ( Values[i], Mult, Shift );
+    }
+}
+
+// convert an array of tics into nanoseconds
+void HighPerTimer::TictoNSec ( const int64_t * HPTics, int64_t * NSeconds, const size_t Count )
+{
+    uint64_t Mult;
+    uint32_t Shift;
+    HighPerTimer::LoadPair ( HighPerTimer::NSecMult, HighPerTimer::NSecShift, Mult, Shift );
+    HighPerTimer::FixedPointMul ( HPTics, NSeconds, Count, Mult, Shift );
+}
+
+// convert an array of nanoseconds into tics
+void HighPerTimer::NSectoTic ( const int64_t * NSeconds, int64_t * HPTics, const size_t Count )
+{
+    uint64_t Mult;
+    uint32_t Shift;
+    HighPerTimer::LoadPair ( HighPerTimer::TicsMult, HighPerTimer::TicsShift, Mult, Shift );
+    HighPerTimer::FixedPointMul ( NSeconds, HPTics, Count, Mult, Shift );
+}
+
+// convert an array of tics into timeval structs, chunk by chunk through a buffer on the stack
+void HighPerTimer::TictoTV ( const int64_t * HPTics, timeval * TV, const size_t Count, const bool Shift )
+{
+    int64_t Buffer[ChunkSize];
+    const int64_t Offset ( Shift ? HighPerTimer::GetUnixZeroShift() : 0 );
+    for ( size_t Done ( 0 ); Done < Count; Done += ChunkSize )
+    {
+        const size_t Chunk ( std::min ( ChunkSize, Count - Done ) );
+        for ( size_t i ( 0 ); i < Chunk; i++ )
+        {
+            Buffer[i] = HPTics[Done + i] + Offset;
+        }
+        HighPerTimer::TictoNSec ( Buffer, Buffer, Chunk );
+        for ( size_t i ( 0 ); i < Chunk; i++ )
+        {
+            int64_t Seconds, Fraction;
+            SplitNSec ( Buffer[i], Seconds, Fraction );
+            TV[Done + i].tv_sec = Seconds;
+            TV[Done + i].tv_usec = Fraction / 1000LL;
+        }
+    }
+}
+
+// convert an array of tics into timespec structs, chunk by chunk through a buffer on the stack
+void HighPerTimer::TictoTS ( const int64_t * HPTics, timespec * TS, const size_t Count, const bool Shift )
+{
+    int64_t Buffer[ChunkSize];
+    const int64_t Offset ( Shift ? HighPerTimer::GetUnixZeroShift() : 0 );
+    for ( size_t Done ( 0 ); Done < Count; Done += ChunkSize )
+    {
+        const size_t Chunk ( std::min ( ChunkSize, Count - Done ) );
+        for ( size_t i ( 0 ); i < Chunk; i++ )
+        {
+            Buffer[i] = HPTics[Done + i] + Offset;
+        }
+        HighPerTimer::TictoNSec ( Buffer, Buffer, Chunk );
+        for ( size_t i ( 0 ); i < Chunk; i++ )
+        {
+            int64_t Seconds, Fraction;
+            SplitNSec ( Buffer[i], Seconds, Fraction );
+            TS[Done + i].tv_sec = Seconds;
+            TS[Done + i].tv_nsec = Fraction;
+        }
+    }
+}
+
+// convert an array of timeval structs into tics
+void HighPerTimer::TVtoTic ( const timeval * TV, int64_t * HPTics, const size_t Count, const bool Shift )
+{
+    const int64_t Offset ( Shift ? HighPerTimer::GetUnixZeroShift() : 0 );
+    for ( size_t i ( 0 ); i < Count; i++ )
+    {
+        HPTics[i] = static_cast<int64_t> ( TV[i].tv_sec ) * ONE_BILLION + static_cast<int64_t> ( TV[i].tv_usec ) * 1000LL;
+    }
+    HighPerTimer::NSectoTic ( HPTics, HPTics, Count );
+    for ( size_t i ( 0 ); i < Count; i++ )
+    {
+        HPTics[i] -= Offset;
+    }
+}
+
+// convert an array of timespec structs into tics
+void HighPerTimer::TStoTic ( const timespec * TS, int64_t * HPTics, const size_t Count, const bool Shift )
+{
+    const int64_t Offset ( Shift ? HighPerTimer::GetUnixZeroShift() : 0 );
+    for ( size_t i ( 0 ); i < Count; i++ )
+    {
+        HPTics[i] = static_cast<int64_t> ( TS[i].tv_sec ) * ONE_BILLION + static_cast<int64_t> ( TS[i].tv_nsec );
+    }
+    HighPerTimer::NSectoTic ( HPTics, HPTics, Count );
+    for ( size_t i ( 0 ); i < Count; i++ )
+    {
+        HPTics[i] -= Offset;
+    }
+}
+
+} // end namespace HPTimer
@@ -0,0 +1,215 @@
+/*
+ * @file   TimeFormat.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  Formatting of the time into buffers of the caller without allocation, locale and locks
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+#include <cstring>
+#include <time.h>
+#include "HighPerTimer.h"
+
+// C++ macro for one billion ( 10^9 )
+constexpr int64_t ONE_BILLION = 1000000000LL;
+
+constexpr int64_t SecondsPerDay = 86400;
+
+// the offset of the local time is valid for a quarter of an hour of UTC, all time zones change their offsets at such a boundary
+constexpr int64_t OffsetBlockSeconds = 900;
+
+// the cached offset is packed with its block into one word: block << OffsetBits | offset + OffsetBias
+constexpr uint32_t OffsetBits = 20;
+constexpr int64_t OffsetBias = 1 << ( OffsetBits - 1 );
+
+// pairs of decimal digits, so two digits are written by one copy
+static const char DigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869"
+    "707172737475767778798081828384858687888990919293949596979899";
+
+// offset of the local time, whose block never matches before the first call
+static std::atomic<int64_t> CachedOffset ( INT64_MIN );
+
+namespace HPTimer
+{
+
+// write the value with exactly Width digits, leading zeros included
+static inline char * WriteFixed ( char * Out, uint64_t Value, uint32_t Width )
+{
+    char * End ( Out + Width );
+    char * Digit ( End );
+    for ( ; Width >= 2; Width -= 2 )
+    {
+        Digit -= 2;
+        memcpy ( Digit, &DigitPairs[2 * ( Value % 100 )], 2 );
+        Value /= 100;
+    }
+    if ( Width )
+    {
+        *--Digit = static_cast<char> ( '0' + Value % 10 );
+    }
+    return End;
+}
+
+// write the value with as many digits as needed
+static inline char * WriteUInt ( char * Out, const uint64_t Value )
+{
+    uint32_t Width ( 1 );
+    for ( uint64_t Rest ( Value / 10 ); Rest; Rest /= 10 )
+    {
+        ++Width;
+    }
+    return WriteFixed ( Out, Value, Width );
+}
+
+// division rounding to minus infinity
+static inline int64_t FloorDiv ( const int64_t Value, const int64_t Divisor )
+{
+    int64_t Quotient ( Value / Divisor );
+    return ( ( Value % Divisor ) < 0 ) ? Quotient - 1 : Quotient;
+}
+
+// date of the proleptic Gregorian calendar from the days since 1970-01-01, without any table or lock
+static inline void CivilFromDays ( int64_t Days, int64_t & Year, uint32_t & Month, uint32_t & Day )
+{
+    Days += 719468;
+    int64_t Era ( FloorDiv ( Days, 146097 ) );
+    uint32_t DayOfEra ( static_cast<uint32_t> ( Days - Era * 146097 ) );
+    uint32_t YearOfEra ( ( DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096 ) / 365 );
+    uint32_t DayOfYear ( DayOfEra - ( 365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100 ) );
+    uint32_t MonthPrime ( ( 5 * DayOfYear + 2 ) / 153 );
+    Day = DayOfYear - ( 153 * MonthPrime + 2 ) / 5 + 1;
+    Month = MonthPrime < 10 ? MonthPrime + 3 : MonthPrime - 9;
+    Year = static_cast<int64_t> ( YearOfEra ) + Era * 400 + ( Month <= 2 ? 1 : 0 );
+}
+
+// offset of the local time to UTC in seconds at the given UTC time. localtime_r() is only called, when the time
+// has left the block of the cached offset, so a change of TZ by the application is seen in the next block
+static int64_t LocalOffset ( const int64_t UTCSeconds )
+{
+    int64_t Block ( FloorDiv ( UTCSeconds, OffsetBlockSeconds ) );
+    int64_t Packed ( CachedOffset.load ( std::memory_order_relaxed ) );
+    if ( ( Packed >> OffsetBits ) == Block )
+    {
+        return ( Packed & ( ( 1LL << OffsetBits ) - 1 ) ) - OffsetBias;
+    }
+    time_t Time ( UTCSeconds );
+    struct tm Local;
+    int64_t Offset ( 0 );
+    if ( NULL != localtime_r ( &Time, &Local ) )
+    {
+        Offset = Local.tm_gmtoff;
+    }
+    CachedOffset.store ( static_cast<int64_t> ( static_cast<uint64_t> ( Block ) << OffsetBits ) | ( Offset + OffsetBias ), std::memory_order_relaxed );
+    return Offset;
+}
+
+// write the time into the buffer
+size_t HighPerTimer::FormatTo ( char * Buffer, const size_t Length, const TimeFormat Format ) const
+{
+    this->Normalize();
+    return HighPerTimer::FormatParts ( this->Negative(), mSeconds, mNSeconds, Buffer, Length, Format );
+}
+
+// write the nanoseconds since begin of Unix era into the buffer
+size_t HighPerTimer::FormatNSecTo ( const int64_t NSeconds, char * Buffer, const size_t Length, const TimeFormat Format )
+{
+    // the magnitude is taken unsigned, so the min value of int64 is handled as well
+    uint64_t Abs ( NSeconds < 0 ? 0 - static_cast<uint64_t> ( NSeconds ) : static_cast<uint64_t> ( NSeconds ) );
+    return HighPerTimer::FormatParts ( NSeconds < 0, static_cast<int64_t> ( Abs / ONE_BILLION ), static_cast<int64_t> ( Abs % ONE_BILLION ),
+                                       Buffer, Length, Format );
+}
+
+// the text is composed on the stack, so a too small buffer is never written partially
+size_t HighPerTimer::FormatParts ( const bool Negative, const int64_t Seconds, const int64_t NSeconds,
+                                   char * Buffer, const size_t Length, const TimeFormat Format )
+{
+    char Text[FormatLength];
+    char * Out ( Text );
+    if ( TimeFormat::Unix == Format )
+    {
+        if ( Negative )
+        {
+            *Out++ = '-';
+        }
+        Out = WriteUInt ( Out, Seconds );
+        *Out++ = '.';
+        Out = WriteFixed ( Out, NSeconds, 9 );
+    }
+    else
+    {
+        // the calendar needs the seconds rounded to minus infinity and the positive fraction
+        int64_t Sec ( Negative ? -Seconds : Seconds );
+        int64_t NSec ( NSeconds );
+        if ( Negative && ( NSec > 0 ) )
+        {
+            Sec -= 1;
+            NSec = ONE_BILLION - NSec;
+        }
+        int64_t Offset ( TimeFormat::ISO8601Local == Format ? LocalOffset ( Sec ) : 0 );
+        Sec += Offset;
+        int64_t Days ( FloorDiv ( Sec, SecondsPerDay ) );
+        int64_t SecOfDay ( Sec - Days * SecondsPerDay );
+        int64_t Year;
+        uint32_t Month, Day;
+        CivilFromDays ( Days, Year, Month, Day );
+        if ( Year < 0 )
+        {
+            *Out++ = '-';
+            Year = -Year;
+        }
+        Out = Year > 9999 ? WriteUInt ( Out, Year ) : WriteFixed ( Out, Year, 4 );
+        *Out++ = '-';
+        Out = WriteFixed ( Out, Month, 2 );
+        *Out++ = '-';
+        Out = WriteFixed ( Out, Day, 2 );
+        *Out++ = 'T';
+        Out = WriteFixed ( Out, SecOfDay / 3600, 2 );
+        *Out++ = ':';
+        Out = WriteFixed ( Out, SecOfDay / 60 % 60, 2 );
+        *Out++ = ':';
+        Out = WriteFixed ( Out, SecOfDay % 60, 2 );
+        *Out++ = '.';
+        Out = WriteFixed ( Out, NSec, 9 );
+        if ( TimeFormat::ISO8601UTC == Format )
+        {
+            *Out++ = 'Z';
+        }
+        else
+        {
+            *Out++ = Offset < 0 ? '-' : '+';
+            int64_t AbsOffset ( Offset < 0 ? -Offset : Offset );
+            Out = WriteFixed ( Out, AbsOffset / 3600, 2 );
+            *Out++ = ':';
+            Out = WriteFixed ( Out, AbsOffset / 60 % 60, 2 );
+        }
+    }
+    size_t Size ( Out - Text );
+    if ( Size >= Length )
+    {
+        if ( Length > 0 )
+        {
+            Buffer[0] = 0;
+        }
+        return 0;
+    }
+    memcpy ( Buffer, Text, Size );
+    Buffer[Size] = 0;
+    return Size;
+}
+
+} // namespace HPTimer
@@ -23,11 +23,18 @@
 
 #include <iostream>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sched.h>
+#include <link.h>
+#include <sys/auxv.h>
+#ifdef __aarch64__
+#include <asm/hwcap.h>
+#endif
 #include "TimeHardware.h"
 
 // C++ macro for one billion ( 10^9 )
@@ -39,6 +46,22 @@ constexpr uint64_t EaxForInvarTSC   = 0x80000007;
 constexpr uint64_t EaxForRDTSCP     = 0x80000001;
 constexpr uint64_t EaxForBrand      = 0x80000002;
 constexpr uint64_t EaxForVendor     = 0;
+constexpr uint64_t EaxForFeatures   = 1;
+constexpr uint64_t EaxForExtFeatures = 7;
+constexpr uint64_t EaxForTSCRatio   = 0x15;
+constexpr uint64_t EaxForCPUFreq    = 0x16;
+constexpr uint64_t EaxForHypervisor = 0x40000000;
+constexpr uint64_t EaxForHypervisorTiming = 0x40000010;
+
+// number of comparisons of IA32_TSC_AUX with getcpu(), one match is enough
+constexpr uint32_t TSCAuxChecks = 4;
+
+// TSC frequency in kHz, exported by some kernels
+constexpr char TSCFreqPath[] = "/sys/devices/system/cpu/cpu0/tsc_freq_khz";
+
+// names of clock_gettime() in the vDSO of x86 and of arm64
+constexpr char VDSOClockGettime[] = "__vdso_clock_gettime";
+constexpr char VDSOKernelClockGettime[] = "__kernel_clock_gettime";
 
 // offset value from the first mapped memory address for main counter register
 constexpr uint64_t MainCounterOffset = 0x0f0;
@@ -48,6 +71,8 @@ constexpr uint64_t MainCounterOffsetHigh = 0x0f4;
 constexpr uint64_t PeriodOffset = 0x004;
 // constant string for Cenatur vendor "CentaurHauls"
 constexpr char CentaurVendor[12] = {'C', 'e', 'n', 't','a','u', 'r', 'H', 'a', 'u', 'l', 's'};
+// constant string for AMD vendor "AuthenticAMD"
+constexpr char AMDVendor[12] = {'A', 'u', 't', 'h', 'e', 'n', 't', 'i', 'c', 'A', 'M', 'D'};
 // constant string for Intel vendor "GenuineIntel"
 constexpr char IntelVendor[12] = {'G', 'e', 'n', 'u', 'i', 'n', 'e', 'I', 'n', 't', 'e', 'l'};
 
@@ -60,13 +85,32 @@ char TSCTimer::VendorString[12];
 bool TSCTimer::HasRDTSCPinst;
 bool TSCTimer::HasInvariantTSC;
 bool TSCTimer::HasConstantTSC;
+bool TSCTimer::HasAVX2;
+bool TSCTimer::HasAVX512;
+bool TSCTimer::HasHypervisor ( false );
+char TSCTimer::HypervisorString[13];
+bool TSCTimer::HasWaitPkg ( false );
+bool TSCTimer::HasMonitorX ( false );
+bool TSCTimer::SerializeWithCPUID ( true );
+bool TSCTimer::TSCAuxIsCpu ( false );
+TSCFreqOrigin TSCTimer::FreqOrigin ( TSCFreqOrigin::Unknown );
+
+uint64_t ARMTimer::Frequency ( 0 );
+bool ARMTimer::HasEventStream ( false );
 
 HPETFail HPETTimer::HPETFailReason;
-int HPETTimer::HpetFd;
+int HPETTimer::HpetFd ( -1 );
 unsigned char* HPETTimer::HpetAdd_ptr;
 uint64_t HPETTimer::HpetPeriod;
+double HPETTimer::ReadNSec ( 0 );
 
 uint32_t OSTimer::OSTimerFrequency ( 1000 );
+OSClock OSTimer::Clock ( OSClock::Monotonic );
+clockid_t OSTimer::ClockId ( CLOCK_MONOTONIC );
+// the C library is used until the vDSO is resolved, so the reads during static initialization are valid
+int ( *OSTimer::ClockGettime ) ( clockid_t, timespec * ) ( &clock_gettime );
+bool OSTimer::ViaVDSO ( false );
+double OSTimer::ReadNSec ( 0 );
 
 class HighPerTimer;
 
@@ -74,14 +118,25 @@ class HighPerTimer;
 // TSCTimer
 //////////////////////////////////////////////////////////////////
 
+void TSCTimer::GetCpu ( uint32_t & Cpu, uint32_t & Node )
+{
+    unsigned int CpuId ( 0 ), NodeId ( 0 );
+    if ( 0 != getcpu ( &CpuId, &NodeId ) )
+    {
+        CpuId = 0;
+        NodeId = 0;
+    }
+    Cpu = CpuId;
+    Node = NodeId;
+}
+
 /// initialize the TSC subsystem of our timer
 bool TSCTimer::InitTSCTimer()
 {
-    #ifdef  __arm__
-    // This is ARM assembly code which is preferred architecture
-    // ARM doesn't support neither TSC nor HPET
-        return false;
-    #endif
+#if !defined ( __x86_64__ ) && !defined ( __i386__ )
+    // only x86 has the TSC, the counter of ARM is the ARMTimer
+    return false;
+#endif
     // the format of the 32-bit processor signature output
     struct SignCPUID
     {
@@ -114,6 +169,7 @@ bool TSCTimer::InitTSCTimer()
 
     TSCTimer::GetVendorID();
     TSCTimer::GetCPUBrand();
+    TSCTimer::SerializeWithCPUID = ( 0 != memcmp ( VendorString, IntelVendor, 12 ) ) && ( 0 != memcmp ( VendorString, AMDVendor, 12 ) );
 
     // check the presence of the RDTSCP indicated by CPUID leaf 80000001, EDX bit 27
     RegsCPUIDoutput = TSCTimer::ExecuteCPUID ( EaxForRDTSCP );
@@ -126,6 +182,17 @@ bool TSCTimer::InitTSCTimer()
         TSCTimer::HasRDTSCPinst = false;
     }
 
+    // IA32_TSC_AUX is only meaningful if the kernel loads it with the CPU and the node. A migration between the reads
+    // may spoil one comparison, so the check is repeated
+    TSCTimer::TSCAuxIsCpu = false;
+    for ( uint32_t i = 0; TSCTimer::HasRDTSCPinst && ( i < TSCAuxChecks ) && !TSCTimer::TSCAuxIsCpu; ++i )
+    {
+        uint32_t Aux, Cpu, Node;
+        TSCTimer::RDTSCP ( Aux );
+        TSCTimer::GetCpu ( Cpu, Node );
+        TSCTimer::TSCAuxIsCpu = ( ( Aux & TSCAuxCpuMask ) == Cpu ) && ( ( Aux >> TSCAuxNodeShift ) == Node );
+    }
+
     // get CPUID output with EAX = 1 to fill in CPU signature struct with values of Model, Family, Stepping and Type of processor.
     RegsCPUIDoutput = TSCTimer::ExecuteCPUID ( 1 );
 
@@ -178,18 +245,19 @@ bool TSCTimer::InitTSCTimer()
 
 // perform CPU ID instruction
 // param InputEAX is the input value of EAX register specifying which part of  information to return
-TSCTimer::RegsCPUID TSCTimer::ExecuteCPUID ( uint32_t InputEAX )
+// param InputECX is the input value of ECX register specifying the sub-leaf
+TSCTimer::RegsCPUID TSCTimer::ExecuteCPUID ( uint32_t InputEAX, uint32_t InputECX )
 {
-#ifndef __arm__
-    RegsCPUID RegsCPUIDoutput;
+    RegsCPUID RegsCPUIDoutput = { 0, 0, 0, 0 };
+#if defined ( __x86_64__ ) || defined ( __i386__ )
     asm volatile
     (
         " cpuid;"
     : "=a" ( RegsCPUIDoutput.EAXBuf ), "=b" ( RegsCPUIDoutput.EBXBuf ), "=c" ( RegsCPUIDoutput.ECXBuf ), "=d" ( RegsCPUIDoutput.EDXBuf )
-    : "a" ( InputEAX )
+    : "a" ( InputEAX ), "c" ( InputECX )
     );
-    return RegsCPUIDoutput;
 #endif
+    return RegsCPUIDoutput;
 }
 
 // get processor brand string
@@ -217,6 +285,127 @@ void TSCTimer::GetVendorID()
     memcpy ( TSCTimer::VendorString+8, &RegsCPUIDoutput.ECXBuf,4 );
 }
 
+// get the hypervisor and its vendor signature
+void TSCTimer::GetHypervisor()
+{
+    memset ( TSCTimer::HypervisorString, 0, 13 );
+    TSCTimer::HasHypervisor = ( TSCTimer::ExecuteCPUID ( EaxForFeatures ).ECXBuf >> 31 ) & 1;
+    if ( TSCTimer::HasHypervisor )
+    {
+        // the signature is returned in EBX, ECX and EDX
+        RegsCPUID RegsCPUIDoutput = TSCTimer::ExecuteCPUID ( EaxForHypervisor );
+        memcpy ( TSCTimer::HypervisorString,   &RegsCPUIDoutput.EBXBuf, 4 );
+        memcpy ( TSCTimer::HypervisorString+4, &RegsCPUIDoutput.ECXBuf, 4 );
+        memcpy ( TSCTimer::HypervisorString+8, &RegsCPUIDoutput.EDXBuf, 4 );
+    }
+}
+
+// get the TSC frequency reported by the platform, 0 if it is not reported
+double TSCTimer::GetTSCFrequency()
+{
+    TSCTimer::FreqOrigin = TSCFreqOrigin::Unknown;
+    uint32_t MaxLeaf ( TSCTimer::ExecuteCPUID ( EaxForVendor ).EAXBuf );
+
+    // CPUID leaf 0x15 returns the ratio of the TSC to the core crystal clock in EBX / EAX and the crystal frequency in Hz in ECX.
+    // Some processors do not enumerate the crystal, then it is derived from the base frequency in MHz of leaf 0x16, as Linux does
+    if ( MaxLeaf >= EaxForTSCRatio )
+    {
+        RegsCPUID Ratio ( TSCTimer::ExecuteCPUID ( EaxForTSCRatio ) );
+        if ( ( 0 != Ratio.EAXBuf ) && ( 0 != Ratio.EBXBuf ) )
+        {
+            double CrystalHz ( Ratio.ECXBuf );
+            if ( ( 0 == Ratio.ECXBuf ) && ( MaxLeaf >= EaxForCPUFreq ) )
+            {
+                CrystalHz = TSCTimer::ExecuteCPUID ( EaxForCPUFreq ).EAXBuf * 1e6 * Ratio.EAXBuf / Ratio.EBXBuf;
+            }
+            if ( CrystalHz > 0 )
+            {
+                TSCTimer::FreqOrigin = TSCFreqOrigin::CPUID;
+                return CrystalHz * Ratio.EBXBuf / Ratio.EAXBuf / 1e6;
+            }
+        }
+    }
+
+    // a hypervisor is indicated by CPUID leaf 1, ECX bit 31. Its leaf 0x40000010 returns the TSC frequency in kHz in EAX
+    if ( ( TSCTimer::ExecuteCPUID ( EaxForFeatures ).ECXBuf >> 31 ) & 1 )
+    {
+        if ( TSCTimer::ExecuteCPUID ( EaxForHypervisor ).EAXBuf >= EaxForHypervisorTiming )
+        {
+            uint32_t KHz ( TSCTimer::ExecuteCPUID ( EaxForHypervisorTiming ).EAXBuf );
+            if ( 0 != KHz )
+            {
+                TSCTimer::FreqOrigin = TSCFreqOrigin::Hypervisor;
+                return KHz / 1000.0;
+            }
+        }
+    }
+
+    FILE * KernelFreq ( fopen ( TSCFreqPath, "r" ) );
+    if ( NULL != KernelFreq )
+    {
+        unsigned long KHz ( 0 );
+        bool Valid ( ( 1 == fscanf ( KernelFreq, "%lu", &KHz ) ) && ( 0 != KHz ) );
+        fclose ( KernelFreq );
+        if ( Valid )
+        {
+            TSCTimer::FreqOrigin = TSCFreqOrigin::Kernel;
+            return KHz / 1000.0;
+        }
+    }
+    return 0;
+}
+
+// check the vector extensions of the CPU
+void TSCTimer::GetSIMDFeatures()
+{
+    TSCTimer::HasAVX2 = false;
+    TSCTimer::HasAVX512 = false;
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+    if ( TSCTimer::ExecuteCPUID ( EaxForVendor ).EAXBuf < EaxForExtFeatures )
+    {
+        return;
+    }
+    // the OS has to save the vector registers on the context switch, it is indicated by OSXSAVE, CPUID leaf 1, ECX bit 27
+    RegsCPUID RegsCPUIDoutput = TSCTimer::ExecuteCPUID ( EaxForFeatures );
+    if ( ! ( ( RegsCPUIDoutput.ECXBuf >> 27 ) & 1 ) )
+    {
+        return;
+    }
+    // read the extended control register XCR0 with the enabled state components
+    uint32_t XCR0Low, XCR0High;
+    asm volatile
+    (
+        "xgetbv"
+    : "=a" ( XCR0Low ), "=d" ( XCR0High )
+    : "c" ( 0 )
+    );
+    // AVX2 is indicated by CPUID leaf 7, EBX bit 5. XMM and YMM state (XCR0 bits 1, 2) have to be enabled
+    // AVX-512 foundation is indicated by CPUID leaf 7, EBX bit 16. Opmask and ZMM state (XCR0 bits 5, 6, 7) have to be enabled as well
+    RegsCPUIDoutput = TSCTimer::ExecuteCPUID ( EaxForExtFeatures, 0 );
+    TSCTimer::HasAVX2 = ( ( RegsCPUIDoutput.EBXBuf >> 5 ) & 1 ) && ( 0x06 == ( XCR0Low & 0x06 ) );
+    TSCTimer::HasAVX512 = ( ( RegsCPUIDoutput.EBXBuf >> 16 ) & 1 ) && ( 0xE6 == ( XCR0Low & 0xE6 ) );
+#endif
+}
+
+// check the user-level wait instructions
+void TSCTimer::GetWaitFeatures()
+{
+    TSCTimer::HasWaitPkg = false;
+    TSCTimer::HasMonitorX = false;
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+    // WAITPKG is indicated by CPUID leaf 7, ECX bit 5
+    if ( TSCTimer::ExecuteCPUID ( EaxForVendor ).EAXBuf >= EaxForExtFeatures )
+    {
+        TSCTimer::HasWaitPkg = ( TSCTimer::ExecuteCPUID ( EaxForExtFeatures, 0 ).ECXBuf >> 5 ) & 1;
+    }
+    // MONITORX is indicated by CPUID leaf 80000001, ECX bit 29
+    if ( TSCTimer::ExecuteCPUID ( EaxForCPUIDSign ).EAXBuf >= EaxForRDTSCP )
+    {
+        TSCTimer::HasMonitorX = ( TSCTimer::ExecuteCPUID ( EaxForRDTSCP ).ECXBuf >> 29 ) & 1;
+    }
+#endif
+}
+
 //////////////////////////////////////////////////////////////////
 // HPETTimer
 //////////////////////////////////////////////////////////////////
@@ -277,14 +466,18 @@ bool HPETTimer::InitHPETTimer()
             break;
         }
         int retval = ::close ( HPETTimer::HpetFd );
+        HPETTimer::HpetFd = -1;
         return false;
     }
     // 32-bit HPET main counter overruns every 7,16 minutes. So it is denied using this source.
-    uint64_t HpetMcounterSize =  * ( ( int64_t * ) ( HPETTimer::HpetAdd_ptr ) ) >> 13;
-    // if this bit is a 0, it indicates that the main counter is 32 bits wide
-    if ( ! HpetMcounterSize )
+    // COUNT_SIZE_CAP, bit 13 of the general capabilities register, is 0 if the main counter is 32 bits wide
+    uint32_t Capabilities ( * ( reinterpret_cast<volatile uint32_t*> ( HPETTimer::HpetAdd_ptr ) ) );
+    if ( 0 == ( ( Capabilities >> 13 ) & 1 ) )
     {
         HPETTimer::HPETFailReason = HPETFail::MC32BIT;
+        munmap ( HPETTimer::HpetAdd_ptr, 1024 );
+        ::close ( HPETTimer::HpetFd );
+        HPETTimer::HpetFd = -1;
         return false;
     }
     return true;
@@ -294,18 +487,19 @@ bool HPETTimer::InitHPETTimer()
 int64_t HPETTimer::GetHPETTics()
 {
 #ifdef __x86_64__
-    uint64_t HpetMcounter =  * ( reinterpret_cast<int32_t*> ( HPETTimer::HpetAdd_ptr + MainCounterOffset ) );
-    return HpetMcounter;
+    // the 64-bit main counter is read with a single load. It has to be volatile, so every call accesses the device
+    return * ( reinterpret_cast<volatile uint64_t*> ( HPETTimer::HpetAdd_ptr + MainCounterOffset ) );
 #else
     // the case when we have the 64 bit main counter, but a 32 bit addresses, meaning reading the main counter must be performed within two memory accesses
+    volatile uint32_t * Low ( reinterpret_cast<volatile uint32_t*> ( HPETTimer::HpetAdd_ptr + MainCounterOffset ) );
+    volatile uint32_t * High ( reinterpret_cast<volatile uint32_t*> ( HPETTimer::HpetAdd_ptr + MainCounterOffsetHigh ) );
     while ( 1 )
     {
         // Multiple reading HPET main counter register
         // avoid an accuracy problem which may be arise if just after reading one half, the other half rolls over and changes the first half.
-
-        uint64_t Hpet_High_Order = * ( reinterpret_cast<int32_t*> ( HPETTimer::HpetAdd_ptr + MainCounterOffsetHigh ) );
-        uint64_t Hpet_Low_Order  = * ( reinterpret_cast<int32_t*> ( HPETTimer::HpetAdd_ptr + MainCounterOffset ) );
-        uint64_t _Hpet_High_Order = * ( reinterpret_cast<int32_t*> ( HPETTimer::HpetAdd_ptr + MainCounterOffsetHigh ) );
+        uint64_t Hpet_High_Order = *High;
+        uint64_t Hpet_Low_Order  = *Low;
+        uint64_t _Hpet_High_Order = *High;
         // if both read from the high 32 bits of the main counter register HPET equal, clock cycles are current returned
         if ( Hpet_High_Order == _Hpet_High_Order )
         {
@@ -319,20 +513,131 @@ int64_t HPETTimer::GetHPETTics()
 double HPETTimer::GetHPETFrequency()
 {
     // read the high 32-bit-order of the general capabilities and ID Register, period offset 0x004
-    HPETTimer::HpetPeriod = * ( ( uint32_t * ) ( HPETTimer::HpetAdd_ptr + PeriodOffset ) );
+    HPETTimer::HpetPeriod = * ( reinterpret_cast<volatile uint32_t*> ( HPETTimer::HpetAdd_ptr + PeriodOffset ) );
     // get the HPET frequency in microseconds
     return ( double ) ONE_BILLION / HPETTimer::HpetPeriod;
 }
 
+//////////////////////////////////////////////////////////////////
+// ARM Timer
+//////////////////////////////////////////////////////////////////
+
+// check availability of the generic timer
+bool ARMTimer::InitARMTimer()
+{
+#ifdef __aarch64__
+    uint64_t Hz;
+    asm volatile
+    (
+        "mrs %0, cntfrq_el0"
+    : "=r" ( Hz )
+    );
+    ARMTimer::Frequency = Hz;
+    ARMTimer::HasEventStream = ( 0 != ( getauxval ( AT_HWCAP ) & HWCAP_EVTSTRM ) );
+    return ( 0 != Hz );
+#endif
+    return false;
+}
+
 //////////////////////////////////////////////////////////////////
 // OS Timer
 //////////////////////////////////////////////////////////////////
 
+// find clock_gettime() in the symbol table of the vDSO, which the kernel maps into every process.
+// The data page of the vDSO is no ABI, so its entry is called instead of reading the page
+static int ( *FindVDSOClockGettime() ) ( clockid_t, timespec * )
+{
+    const unsigned char * Base ( reinterpret_cast<const unsigned char *> ( getauxval ( AT_SYSINFO_EHDR ) ) );
+    if ( NULL == Base )
+    {
+        return NULL;
+    }
+    const ElfW ( Ehdr ) * Header ( reinterpret_cast<const ElfW ( Ehdr ) *> ( Base ) );
+    if ( ( 0 != memcmp ( Header->e_ident, ELFMAG, SELFMAG ) ) || ( 0 == Header->e_shoff ) )
+    {
+        return NULL;
+    }
+    // the symbols are relative to the address of the first loaded segment
+    ElfW ( Addr ) Bias ( reinterpret_cast<ElfW ( Addr )> ( Base ) );
+    const ElfW ( Phdr ) * Segments ( reinterpret_cast<const ElfW ( Phdr ) *> ( Base + Header->e_phoff ) );
+    for ( uint32_t i = 0; i < Header->e_phnum; ++i )
+    {
+        if ( PT_LOAD == Segments[i].p_type )
+        {
+            Bias -= Segments[i].p_vaddr;
+            break;
+        }
+    }
+    const ElfW ( Shdr ) * Sections ( reinterpret_cast<const ElfW ( Shdr ) *> ( Base + Header->e_shoff ) );
+    for ( uint32_t i = 0; i < Header->e_shnum; ++i )
+    {
+        if ( ( SHT_DYNSYM != Sections[i].sh_type ) || ( Sections[i].sh_link >= Header->e_shnum ) || ( 0 == Sections[i].sh_entsize ) )
+        {
+            continue;
+        }
+        const ElfW ( Sym ) * Symbols ( reinterpret_cast<const ElfW ( Sym ) *> ( Base + Sections[i].sh_offset ) );
+        const char * Names ( reinterpret_cast<const char *> ( Base + Sections[Sections[i].sh_link].sh_offset ) );
+        for ( size_t j = 0; j < Sections[i].sh_size / Sections[i].sh_entsize; ++j )
+        {
+            const char * Name ( Names + Symbols[j].st_name );
+            if ( ( 0 != Symbols[j].st_value ) && ( ( 0 == strcmp ( Name, VDSOClockGettime ) ) || ( 0 == strcmp ( Name, VDSOKernelClockGettime ) ) ) )
+            {
+                return reinterpret_cast<int ( * ) ( clockid_t, timespec * )> ( Bias + Symbols[j].st_value );
+            }
+        }
+    }
+    return NULL;
+}
+
+// select the clock of the OS timer
+bool OSTimer::InitOSTimer ( const OSClock Clock )
+{
+    clockid_t Id ( CLOCK_MONOTONIC );
+    switch ( Clock )
+    {
+    case OSClock::MonotonicRaw:
+        Id = CLOCK_MONOTONIC_RAW;
+        break;
+    case OSClock::MonotonicCoarse:
+        Id = CLOCK_MONOTONIC_COARSE;
+        break;
+    case OSClock::Boottime:
+        Id = CLOCK_BOOTTIME;
+        break;
+    case OSClock::TAI:
+        Id = CLOCK_TAI;
+        break;
+    default:
+        break;
+    }
+    timespec ts;
+    if ( 0 != clock_getres ( Id, &ts ) )
+    {
+        return false;
+    }
+
+    int ( *VDSO ) ( clockid_t, timespec * ) ( FindVDSOClockGettime() );
+    // the entry of the vDSO has to support the clock, otherwise the C library is used
+    if ( ( NULL != VDSO ) && ( 0 == VDSO ( Id, &ts ) ) )
+    {
+        OSTimer::ClockGettime = VDSO;
+        OSTimer::ViaVDSO = true;
+    }
+    else
+    {
+        OSTimer::ClockGettime = &clock_gettime;
+        OSTimer::ViaVDSO = false;
+    }
+    OSTimer::Clock = Clock;
+    OSTimer::ClockId = Id;
+    return true;
+}
+
 // get OS timer tics
 int64_t OSTimer::GetOSTimerTics()
 {
     timespec ts;
-    clock_gettime ( CLOCK_MONOTONIC, &ts );
+    OSTimer::ClockGettime ( OSTimer::ClockId, &ts );
     return ( static_cast<int64_t> ( ts.tv_sec ) * ONE_BILLION + static_cast<int64_t> ( ts.tv_nsec ) ) * ( OSTimer::OSTimerFrequency / 1000LL );
 }
 
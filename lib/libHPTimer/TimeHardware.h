@@ -24,10 +24,25 @@
 #ifndef _TIMEHARDWARE_H
 #define _TIMEHARDWARE_H
 #include <stdint.h>
+#include <time.h>
+#include <vector>
 
 namespace HPTimer
 {
 
+//! origin of the TSC frequency
+/*!
+ * CPUID        - the nominal frequency of the core crystal clock and the TSC ratio of CPUID leaves 0x15 and 0x16
+ * Hypervisor   - the timing information leaf 0x40000010 of the hypervisor
+ * Kernel       - the tsc_freq_khz attribute of the kernel
+ * Measured     - calibrated against CLOCK_MONOTONIC_RAW
+ * Unknown      - the TSC is not used or the frequency was not measured by this process
+ */
+enum class TSCFreqOrigin
+{
+    Unknown, CPUID, Hypervisor, Kernel, Measured
+};
+
 //! Class for CPU identification and checking features of Time Stamp Counter.
 /*!
  * The Time Stamp Counter is a 64-bit register present on all x86 processors since the Pentium.
@@ -36,6 +51,8 @@ namespace HPTimer
 class TSCTimer
 {
     friend class HighPerTimer;
+    friend class HPTimerInitAndClean;
+    friend class HPSleeper;
     friend class AccessTimeHardware;
 public:
     /// exclude creating any instance of TSCTimer class. Shall be used only via the friend HighPerTimer class
@@ -58,9 +75,10 @@ private:
     };
     /** perform CPUID instruction
      * @param InputEAX [in] ]value of EAX register specifying what information to return
+     * @param InputECX [in] value of ECX register specifying the sub-leaf, if the leaf has some
      * @return filled result, which CPUID instruction has written into its registers
      */
-    static RegsCPUID ExecuteCPUID ( uint32_t InputEAX );
+    static RegsCPUID ExecuteCPUID ( uint32_t InputEAX, uint32_t InputECX = 0 );
     /// vendor information string in the array
     static char VendorString[12];
     /// CPU brand string
@@ -71,6 +89,92 @@ private:
     /// get the CPU's manufacturers ID string. The result is written as a side effect to VendorString
     static void GetVendorID();
 
+    /// check the hypervisor, which is indicated by CPUID leaf 1, ECX bit 31, and get its vendor signature of leaf 0x40000000.
+    /// The result is written as a side effect to HasHypervisor and HypervisorString
+    static void GetHypervisor();
+
+    /// the CPU runs under a hypervisor
+    static bool HasHypervisor;
+
+    /// vendor signature of the hypervisor, e.g. "KVMKVMKVM" or "Microsoft Hv", terminated by zero
+    static char HypervisorString[13];
+
+    /// get the TSC frequency reported by the CPU, the hypervisor or the kernel, in that order.
+    /// return the number of tics within one microsecond, or 0 if nobody reports it.
+    /// The origin is written as a side effect to FreqOrigin
+    static double GetTSCFrequency();
+
+    /// origin of the frequency, which HighPerTimer uses for the TSC
+    static TSCFreqOrigin FreqOrigin;
+
+    /// check the vector extensions of the CPU, which are supported by the processor and enabled by the OS.
+    /// The result is written as a side effect to HasAVX2 and HasAVX512
+    static void GetSIMDFeatures();
+
+    /// presence of AVX2 instructions, with YMM state enabled by the OS
+    static bool HasAVX2;
+
+    /// presence of AVX-512 foundation instructions, with ZMM state enabled by the OS
+    static bool HasAVX512;
+
+    /// check the wait instructions of the CPU, which can be executed in user space.
+    /// The result is written as a side effect to HasWaitPkg and HasMonitorX
+    static void GetWaitFeatures();
+
+    /// presence of UMONITOR, UMWAIT and TPAUSE of Intel: the core waits in C0.1 or C0.2 until a TSC deadline
+    static bool HasWaitPkg;
+
+    /// presence of MONITORX and MWAITX of AMD: the core waits until a timeout in TSC tics
+    static bool HasMonitorX;
+
+    /** arm the monitor of the wait instructions on the cache line of the address, a write to it ends the next WaitMonitor().
+     * The instructions are encoded as bytes, so older assemblers accept them
+     * NOTE: shall only be used when HasWaitPkg or HasMonitorX is set
+     */
+    inline static void MonitorAddress ( const void * Address )
+    {
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+        if ( TSCTimer::HasWaitPkg )
+        {
+            // UMONITOR with the address in RAX
+            asm volatile ( ".byte 0xf3, 0x0f, 0xae, 0xf0" :: "a" ( Address ) : "memory" );
+        }
+        else
+        {
+            // MONITORX with the address in RAX, no extensions and no hints
+            asm volatile ( ".byte 0x0f, 0x01, 0xfa" :: "a" ( Address ), "c" ( 0 ), "d" ( 0 ) : "memory" );
+        }
+#endif
+        ( void ) Address;
+    };
+
+    /** wait until the monitored cache line is written, Tics of the TSC have passed or an interrupt comes.
+     * The OS limits a wait of UMWAIT, so it may end earlier, see /sys/devices/system/cpu/umwait_control
+     * @param Tics is the longest time of the wait in tics of the TSC
+     * @param Deep allows C0.2 of UMWAIT, which saves more power but wakes slower than C0.1. MWAITX has no such choice
+     * NOTE: shall only be used after MonitorAddress()
+     */
+    inline static void WaitMonitor ( const int64_t Tics, const bool Deep )
+    {
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+        if ( TSCTimer::HasWaitPkg )
+        {
+            // UMWAIT with the state in ECX, 0 for C0.2 and 1 for C0.1, and the TSC deadline in EDX:EAX
+            uint64_t Deadline ( static_cast<uint64_t> ( TSCTimer::RDTSC() + Tics ) );
+            asm volatile ( ".byte 0xf2, 0x0f, 0xae, 0xf1" :: "c" ( Deep ? 0 : 1 ), "a" ( static_cast<uint32_t> ( Deadline ) ),
+                           "d" ( static_cast<uint32_t> ( Deadline >> 32 ) ) : "memory", "cc" );
+        }
+        else
+        {
+            // MWAITX with the hint in EAX, 0xF0 keeps the core in C0, the timer enabled by ECX bit 1 and the timeout in EBX
+            uint32_t Timeout ( Tics < static_cast<int64_t> ( UINT32_MAX ) ? static_cast<uint32_t> ( Tics ) : UINT32_MAX );
+            asm volatile ( ".byte 0x0f, 0x01, 0xfb" :: "a" ( 0xF0 ), "c" ( 2 ), "b" ( Timeout ) : "memory" );
+        }
+#endif
+        ( void ) Tics;
+        ( void ) Deep;
+    };
+
     /// presence of RDTSCP assembly instruction:
     /// The RDTSCP instruction waits until all previous instructions have been executed before reading the TSC counter.
     /// However, subsequent instructions may begin execution before the read operation is performed.
@@ -90,29 +194,302 @@ private:
     /// it depends on whether your code is 64bit or 32bit
     inline static int64_t CPU_TSC()
     {
-#ifndef __arm__
-        // The RDTSC(P) instruction loads the high-order 32 bits of the timestamp register into EDX, and the low-order 32 bits into EAX. 
-        register uint32_t low32, high32;
         if ( TSCTimer::HasRDTSCPinst )
+        {
+            return TSCTimer::RDTSCP();
+        }
+        return TSCTimer::RDTSC();
+    };
+
+    /** read the tsc counter together with the CPU and the NUMA node, on which it was read.
+     * With RDTSCP the ids are taken from IA32_TSC_AUX, which Linux loads with node << 12 | cpu,
+     * so the read needs no system call. Otherwise they are read by getcpu() after the counter,
+     * so a migration just between both reads is not detected in that case
+     */
+    inline static int64_t CPU_TSC ( uint32_t & Cpu, uint32_t & Node )
+    {
+        if ( TSCTimer::TSCAuxIsCpu )
+        {
+            uint32_t Aux;
+            int64_t Tsc ( TSCTimer::RDTSCP ( Aux ) );
+            Cpu = Aux & TSCAuxCpuMask;
+            Node = Aux >> TSCAuxNodeShift;
+            return Tsc;
+        }
+        int64_t Tsc ( TSCTimer::CPU_TSC() );
+        TSCTimer::GetCpu ( Cpu, Node );
+        return Tsc;
+    };
+
+    /// read the CPU and the NUMA node of the calling thread by the C library, which uses the vDSO of the kernel if present
+    static void GetCpu ( uint32_t & Cpu, uint32_t & Node );
+
+    /// IA32_TSC_AUX holds the CPU and the node as set by Linux, verified against getcpu() at the initialization
+    static bool TSCAuxIsCpu;
+
+    /// bits of IA32_TSC_AUX, which hold the CPU number
+    static const uint32_t TSCAuxCpuMask = 0xfff;
+
+    /** measure the offset of the TSC of each CPU in the affinity of the process against the first one.
+     * A probe thread pinned to the CPU answers the requests of the calling thread, which is pinned to the first CPU.
+     * The offset is the difference of the probe read to the middle of the shortest round trip
+     * NOTE: implemented in TSCSkew.cpp
+     * @return true if at least two CPUs were measured
+     */
+    static bool MeasureCpuOffsets();
+
+    /** measure the offset of the TSC of one CPU against the CPU of the calling thread by a probe thread
+     * @param Cpu is the CPU of the probe
+     * @param Offset is set to the offset in tics
+     * @param Error is set to the uncertainty of the offset in tics
+     * @return false if the probe could not be pinned or did not answer
+     */
+    static bool MeasureCpuOffset ( const int Cpu, int64_t & Offset, int64_t & Error );
+
+    /// offset in tics of the TSC of each CPU against the reference CPU, indexed by the CPU number of IA32_TSC_AUX.
+    /// Empty until MeasureCpuOffsets() is called
+    static std::vector<int64_t> CpuOffset;
+
+    /// largest absolute offset in tics of all measured CPUs
+    static int64_t MaxCpuOffset;
+
+    /// largest uncertainty in tics of the measured offsets, half of the shortest round trip
+    static int64_t CpuOffsetError;
+
+    /// position of the node number in IA32_TSC_AUX
+    static const uint32_t TSCAuxNodeShift = 12;
+
+    /// LFENCE does not wait for the preceding instructions on this CPU, so the fenced reads are serialized with CPUID.
+    /// LFENCE is dispatch serializing on Intel and, with the setting of the Linux kernel, on AMD
+    static bool SerializeWithCPUID;
+
+    /// read the tsc counter at the begin of a measured section: no preceding instruction is pending
+    /// and no following instruction has started, when the counter is read
+    inline static int64_t StartTSC()
+    {
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+        uint32_t low32 ( 0 ), high32;
+        if ( TSCTimer::SerializeWithCPUID )
+        {
+            asm volatile
+            (
+                "cpuid\n\t"
+                "rdtsc\n\t"
+            : "+a" ( low32 ), "=d" ( high32 )
+            :
+            : "ebx", "ecx", "memory"
+            );
+        }
+        else
         {
             asm volatile
             (
-                "RDTSCP\n\t"       
+                "lfence\n\t"
+                "rdtsc\n\t"
+                "lfence\n\t"
             : "=a" ( low32 ), "=d" ( high32 )
-            );         
+            :
+            : "memory"
+            );
+        }
+        return (uint64_t) high32 << 32  | low32;
+#endif
+        return 0;
+    };
+
+    /// read the tsc counter at the end of a measured section: all preceding instructions are executed
+    /// and no following instruction has started, when the counter is read
+    inline static int64_t StopTSC()
+    {
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+        uint32_t low32, high32;
+        if ( TSCTimer::SerializeWithCPUID )
+        {
+            // RDTSCP waits for the preceding instructions, the CPUID afterwards keeps the following ones back.
+            // Without RDTSCP the read is enclosed by two CPUID
+            if ( TSCTimer::HasRDTSCPinst )
+            {
+                asm volatile
+                (
+                    "rdtscp\n\t"
+                    "mov %%eax, %0\n\t"
+                    "mov %%edx, %1\n\t"
+                    "xor %%eax, %%eax\n\t"
+                    "cpuid\n\t"
+                : "=r" ( low32 ), "=r" ( high32 )
+                :
+                : "eax", "ebx", "ecx", "edx", "memory"
+                );
+            }
+            else
+            {
+                asm volatile
+                (
+                    "xor %%eax, %%eax\n\t"
+                    "cpuid\n\t"
+                    "rdtsc\n\t"
+                    "mov %%eax, %0\n\t"
+                    "mov %%edx, %1\n\t"
+                    "xor %%eax, %%eax\n\t"
+                    "cpuid\n\t"
+                : "=r" ( low32 ), "=r" ( high32 )
+                :
+                : "eax", "ebx", "ecx", "edx", "memory"
+                );
+            }
+        }
+        else if ( TSCTimer::HasRDTSCPinst )
+        {
+            asm volatile
+            (
+                "rdtscp\n\t"
+                "lfence\n\t"
+            : "=a" ( low32 ), "=d" ( high32 )
+            :
+            : "ecx", "memory"
+            );
         }
         else
         {
             asm volatile
             (
-                "RDTSC\n\t"
+                "lfence\n\t"
+                "rdtsc\n\t"
+                "lfence\n\t"
             : "=a" ( low32 ), "=d" ( high32 )
-            );            
+            :
+            : "memory"
+            );
         }
         return (uint64_t) high32 << 32  | low32;
 #endif
         return 0;
     };
+
+    /// read the tsc counter with the RDTSC instruction without checking the presence of RDTSCP
+    inline static int64_t RDTSC()
+    {
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+        // The RDTSC instruction loads the high-order 32 bits of the timestamp register into EDX, and the low-order 32 bits into EAX. 
+        register uint32_t low32, high32;
+        asm volatile
+        (
+            "RDTSC\n\t"
+        : "=a" ( low32 ), "=d" ( high32 )
+        );
+        return (uint64_t) high32 << 32  | low32;
+#endif
+        return 0;
+    };
+
+    /// read the tsc counter with the RDTSCP instruction.
+    /// NOTE: shall only be used when HasRDTSCPinst is set
+    inline static int64_t RDTSCP()
+    {
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+        // The RDTSCP instruction loads the high-order 32 bits of the timestamp register into EDX, and the low-order 32 bits into EAX. 
+        // ECX is loaded with the value of IA32_TSC_AUX, so it has to be declared as clobbered
+        register uint32_t low32, high32;
+        asm volatile
+        (
+            "RDTSCP\n\t"
+        : "=a" ( low32 ), "=d" ( high32 )
+        :
+        : "ecx"
+        );
+        return (uint64_t) high32 << 32  | low32;
+#endif
+        return 0;
+    };
+
+    /// read the tsc counter with the RDTSCP instruction and take IA32_TSC_AUX from ECX.
+    /// NOTE: shall only be used when HasRDTSCPinst is set
+    inline static int64_t RDTSCP ( uint32_t & Aux )
+    {
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+        register uint32_t low32, high32;
+        asm volatile
+        (
+            "RDTSCP\n\t"
+        : "=a" ( low32 ), "=d" ( high32 ), "=c" ( Aux )
+        );
+        return (uint64_t) high32 << 32  | low32;
+#endif
+        Aux = 0;
+        return 0;
+    };
+};
+
+//! Class for the virtual counter of the ARM generic timer
+/*!
+ * The counter CNTVCT_EL0 of AArch64 runs at the constant frequency CNTFRQ_EL0, which is set by the firmware,
+ * and is synchronized between all cores, so no calibration is needed. It is readable from user space on Linux
+ */
+class ARMTimer
+{
+    friend class HighPerTimer;
+    friend class HPTimerInitAndClean;
+    friend class HPSleeper;
+    friend class AccessTimeHardware;
+public:
+    /// exclude creating any instance of ARMTimer class. Shall be used only via the friend HighPerTimer class
+    ARMTimer() = delete;
+
+private:
+    /// read the frequency of the counter and check the event stream of the kernel.
+    /// return true if the generic timer is available, it is only on AArch64
+    static bool InitARMTimer();
+
+    /// frequency of the counter in Hz
+    static uint64_t Frequency;
+
+    /// the kernel generates an event for WFE periodically, so a WFE is woken up after EventStreamNSec at the latest
+    static bool HasEventStream;
+
+    /// read the virtual counter. The ISB keeps the read from being executed before the preceding instructions
+    inline static int64_t CNTVCT()
+    {
+#ifdef __aarch64__
+        uint64_t Tics;
+        asm volatile
+        (
+            "isb\n\t"
+            "mrs %0, cntvct_el0"
+        : "=r" ( Tics )
+        :
+        : "memory"
+        );
+        return static_cast<int64_t> ( Tics );
+#endif
+        return 0;
+    };
+
+    /// read the virtual counter for bracketing a measured section. The second ISB keeps the following instructions back
+    inline static int64_t FencedCNTVCT()
+    {
+#ifdef __aarch64__
+        uint64_t Tics;
+        asm volatile
+        (
+            "isb\n\t"
+            "mrs %0, cntvct_el0\n\t"
+            "isb"
+        : "=r" ( Tics )
+        :
+        : "memory"
+        );
+        return static_cast<int64_t> ( Tics );
+#endif
+        return 0;
+    };
+
+    /// wait for an event, i.e. for the next period of the event stream at the latest
+    inline static void WaitForEvent()
+    {
+#ifdef __aarch64__
+        asm volatile ( "wfe" ::: "memory" );
+#endif
+    };
 };
 
 //! reasons for hpet unavailability: 
@@ -163,24 +540,55 @@ private:
     static uint64_t HpetPeriod;
     /// pointer to the first mapped memory address of the HPET table
     static unsigned char *HpetAdd_ptr;
+    /// mean cost of one read in nanoseconds, measured when the TSC is not available and HPET is compared with the OS timer.
+    /// A read is an uncached MMIO load, typically 0.5 to 1.5 us on bare metal and more, where a hypervisor traps it
+    static double ReadNSec;
 };
 
 
+//! clock of the OS time source, read by clock_gettime()
+/*!
+ * Monotonic       - CLOCK_MONOTONIC, slewed by NTP, but never stepped
+ * MonotonicRaw    - CLOCK_MONOTONIC_RAW, the hardware clock without any NTP adjustment
+ * MonotonicCoarse - CLOCK_MONOTONIC_COARSE, updated only once per jiffy, but the cheapest read
+ * Boottime        - CLOCK_BOOTTIME, like CLOCK_MONOTONIC, but it counts the time of suspend as well
+ * TAI             - CLOCK_TAI, the international atomic time, not stepped by leap seconds
+ */
+enum class OSClock
+{
+    Monotonic, MonotonicRaw, MonotonicCoarse, Boottime, TAI
+};
+
 //! Class for initialization of system call of clock_gettime() to get OS time
- /*! Provide access to a system-wide realtime clock with the resolution of nanoseconds
+ /*! Provide access to a system-wide clock with the resolution of nanoseconds.
+  * The clock is read through the clock_gettime() entry of the vDSO of the kernel, if it can be found, otherwise through the C library
  */
 class OSTimer
 {
     friend class HighPerTimer;
+    friend class HPTimerInitAndClean;
+    friend class AccessTimeHardware;
 public:
     /// exclude creating any instance of OSTimer class
     OSTimer() = delete;
 private:
+    /// select the clock and resolve the entry of the vDSO
+    /// return false if the kernel does not support the clock, then the clock before is kept
+    static bool InitOSTimer ( const OSClock Clock );
     /// the value of OS timer frequency
     static uint32_t OSTimerFrequency;
     /// get OS timer tics
     static int64_t GetOSTimerTics();
-
+    /// the selected clock
+    static OSClock Clock;
+    /// clock id of the selected clock
+    static clockid_t ClockId;
+    /// function reading the clock, clock_gettime() of the vDSO or of the C library
+    static int ( *ClockGettime ) ( clockid_t, timespec * );
+    /// clock_gettime() of the vDSO is used
+    static bool ViaVDSO;
+    /// mean cost of one read in nanoseconds, measured when the TSC is not available and HPET is compared with the OS timer
+    static double ReadNSec;
 };
 
 } // end namespace HPTimer
@@ -0,0 +1,94 @@
+/*
+ * @file   HPBatchConversionTest.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  test of the vector kernels of the batch conversions against the scalar conversions
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "HighPerTimer.h"
+
+using namespace HPTimer;
+
+// number of values of the long batch, the short batches cover each remainder of the kernels
+static const size_t LongBatch = 4096;
+static const size_t ShortBatches = 40;
+
+static uint32_t Failures ( 0 );
+
+// values of all magnitudes, with the limits of int64 and the values around zero in between
+static std::vector<int64_t> TestValues ( const size_t Count, std::mt19937_64 & Random )
+{
+    static const int64_t Special[] = { 0, 1, -1, INT64_MAX, INT64_MIN, INT64_MAX - 1, INT64_MIN + 1, 1LL << 32, -( 1LL << 32 ) };
+    std::vector<int64_t> Values ( Count );
+    for ( size_t i = 0; i < Count; ++i )
+    {
+        if ( 0 == i % 7 )
+        {
+            Values[i] = Special[( i / 7 ) % ( sizeof ( Special ) / sizeof ( Special[0] ) )];
+        }
+        else
+        {
+            Values[i] = static_cast<int64_t> ( Random() ) >> ( Random() % 64 );
+        }
+    }
+    return Values;
+}
+
+// the batch has to give exactly the scalar results, also when converting in place
+static void CheckBatch ( const std::vector<int64_t> & Values )
+{
+    std::vector<int64_t> NSeconds ( Values.size() );
+    std::vector<int64_t> Tics ( Values.size() );
+    std::vector<int64_t> InPlace ( Values );
+    HighPerTimer::TictoNSec ( Values.data(), NSeconds.data(), Values.size() );
+    HighPerTimer::NSectoTic ( Values.data(), Tics.data(), Values.size() );
+    HighPerTimer::TictoNSec ( InPlace.data(), InPlace.data(), InPlace.size() );
+    for ( size_t i = 0; i < Values.size(); ++i )
+    {
+        int64_t ExpectedNSec ( HighPerTimer::TictoNSec ( Values[i] ) );
+        int64_t ExpectedTics ( HighPerTimer::NSectoTic ( Values[i] ) );
+        if ( ( NSeconds[i] != ExpectedNSec ) || ( Tics[i] != ExpectedTics ) || ( InPlace[i] != ExpectedNSec ) )
+        {
+            if ( ++Failures <= 10 )
+            {
+                std::cerr << "value " << Values[i] << " at " << i << " of " << Values.size() << ": " << NSeconds[i] << " ns, "
+                          << Tics[i] << " tics, in place " << InPlace[i] << ", expected " << ExpectedNSec << " ns, "
+                          << ExpectedTics << " tics" << std::endl;
+            }
+        }
+    }
+}
+
+int main()
+{
+    const char * Kernel ( getenv ( "HPTIMER_CONVERSION_KERNEL" ) );
+    std::mt19937_64 Random ( 20261014 );
+    for ( size_t Count = 0; Count <= ShortBatches; ++Count )
+    {
+        CheckBatch ( TestValues ( Count, Random ) );
+    }
+    CheckBatch ( TestValues ( LongBatch, Random ) );
+    std::cout << "kernel " << ( Kernel ? Kernel : "default" ) << ", avx2 " << AccessTimeHardware::IsAVX2Supported()
+              << ", avx512 " << AccessTimeHardware::IsAVX512Supported() << ", failures " << Failures << std::endl;
+    return Failures ? 1 : 0;
+}
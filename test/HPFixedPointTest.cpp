@@ -0,0 +1,163 @@
+/*
+ * @file   HPFixedPointTest.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  test of the fixed-point conversions between tics and nanoseconds and of the saturating tic arithmetic
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include "HighPerTimer.h"
+#include "HPArithmetic.h"
+
+using namespace HPTimer;
+
+// random values of each magnitude from 2^0 to 2^63
+static const uint32_t ValuesPerBit = 64;
+
+static uint32_t Failures ( 0 );
+
+static void Fail ( const char * What, const int64_t Value, const int64_t Result, const long double Expected )
+{
+    if ( ++Failures <= 10 )
+    {
+        std::cerr << What << " of " << Value << ": " << Result << ", expected " << Expected << std::endl;
+    }
+}
+
+// the reference is truncated toward zero and saturated as the conversion. The pair keeps 63 significant bits,
+// so the result may differ by one for the truncation and by the relative error of the pair
+static void Check ( const char * What, const int64_t Value, const int64_t Result, const long double Ratio )
+{
+    long double Expected ( truncl ( static_cast<long double> ( Value ) * Ratio ) );
+    if ( Expected >= 9223372036854775807.0L )
+    {
+        if ( INT64_MAX != Result )
+        {
+            Fail ( What, Value, Result, Expected );
+        }
+        return;
+    }
+    if ( Expected <= -9223372036854775808.0L )
+    {
+        if ( INT64_MIN != Result )
+        {
+            Fail ( What, Value, Result, Expected );
+        }
+        return;
+    }
+    if ( fabsl ( static_cast<long double> ( Result ) - Expected ) > 2.0L + fabsl ( Expected ) * ldexpl ( 1.0L, -60 ) )
+    {
+        Fail ( What, Value, Result, Expected );
+    }
+}
+
+static void CheckConversions()
+{
+    long double NsecPerTic ( HighPerTimer::GetNsecPerTic() );
+    std::mt19937_64 Random ( 20261014 );
+    for ( uint32_t Bit = 0; Bit < 64; ++Bit )
+    {
+        for ( uint32_t i = 0; i < ValuesPerBit; ++i )
+        {
+            // the highest magnitude is taken by the limits of int64
+            int64_t Value ( ( i & 1 ) ? INT64_MIN : INT64_MAX );
+            if ( Bit < 63 )
+            {
+                Value = static_cast<int64_t> ( ( Random() >> ( 63 - Bit ) ) | ( 1ULL << Bit ) );
+                Value = ( i & 1 ) ? -Value : Value;
+            }
+            Check ( "TictoNSec", Value, HighPerTimer::TictoNSec ( Value ), NsecPerTic );
+            Check ( "NSectoTic", Value, HighPerTimer::NSectoTic ( Value ), 1.0L / NsecPerTic );
+
+            // the magnitude is converted, so the conversion is symmetric
+            if ( ( INT64_MIN != Value ) && ( HighPerTimer::TictoNSec ( -Value ) != -HighPerTimer::TictoNSec ( Value ) ) )
+            {
+                Fail ( "TictoNSec of the negated value", Value, HighPerTimer::TictoNSec ( -Value ), -HighPerTimer::TictoNSec ( Value ) );
+            }
+
+            // a value within the range comes back up to the tics of the lost nanosecond
+            if ( ( Value <= HighPerTimer::MaxHPTics() ) && ( Value >= HighPerTimer::MinHPTics() ) )
+            {
+                int64_t Back ( HighPerTimer::NSectoTic ( HighPerTimer::TictoNSec ( Value ) ) );
+                long double Error ( fabsl ( static_cast<long double> ( Back ) - static_cast<long double> ( Value ) ) );
+                if ( Error > 2.0L + 1.0L / NsecPerTic + fabsl ( static_cast<long double> ( Value ) ) * ldexpl ( 1.0L, -59 ) )
+                {
+                    Fail ( "round trip", Value, Back, Value );
+                }
+            }
+        }
+    }
+    if ( ( 0 != HighPerTimer::TictoNSec ( 0 ) ) || ( 0 != HighPerTimer::NSectoTic ( 0 ) ) )
+    {
+        Fail ( "conversion", 0, HighPerTimer::TictoNSec ( 0 ), 0 );
+    }
+}
+
+static void CheckArithmetic()
+{
+    if ( ( INT64_MAX != HPSaturateArith::Add ( INT64_MAX, 1 ) ) || ( INT64_MIN != HPSaturateArith::Add ( INT64_MIN, -1 ) ) ||
+         ( INT64_MIN != HPSaturateArith::Sub ( INT64_MIN, 1 ) ) || ( INT64_MAX != HPSaturateArith::Sub ( INT64_MAX, -1 ) ) ||
+         ( -1 != HPSaturateArith::Add ( INT64_MAX, INT64_MIN ) ) || ( 5 != HPSaturateArith::Sub ( 2, -3 ) ) )
+    {
+        Fail ( "HPSaturateArith", INT64_MAX, 0, INT64_MAX );
+    }
+    if ( ( INT64_MIN != HPWrapArith::Add ( INT64_MAX, 1 ) ) || ( INT64_MAX != HPWrapArith::Sub ( INT64_MIN, 1 ) ) )
+    {
+        Fail ( "HPWrapArith", INT64_MAX, 0, INT64_MIN );
+    }
+
+    int64_t Max ( HighPerTimer::MaxHPTics() );
+    int64_t Min ( HighPerTimer::MinHPTics() );
+    int64_t Result;
+    if ( !HPCheckedArith::Add ( 1, 2, Result ) || ( 3 != Result ) )
+    {
+        Fail ( "HPCheckedArith::Add", 1, Result, 3 );
+    }
+    if ( !HPCheckedArith::Add ( Max, 0, Result ) || ( Max != Result ) )
+    {
+        Fail ( "HPCheckedArith::Add", Max, Result, Max );
+    }
+    if ( HPCheckedArith::Add ( Max, 1, Result ) || ( Max != Result ) )
+    {
+        Fail ( "HPCheckedArith::Add", Max, Result, Max );
+    }
+    if ( HPCheckedArith::Add ( INT64_MAX, INT64_MAX, Result ) || ( Max != Result ) )
+    {
+        Fail ( "HPCheckedArith::Add", INT64_MAX, Result, Max );
+    }
+    if ( HPCheckedArith::Sub ( Min, 1, Result ) || ( Min != Result ) )
+    {
+        Fail ( "HPCheckedArith::Sub", Min, Result, Min );
+    }
+    if ( HPCheckedArith::Sub ( INT64_MIN, INT64_MAX, Result ) || ( Min != Result ) )
+    {
+        Fail ( "HPCheckedArith::Sub", INT64_MIN, Result, Min );
+    }
+}
+
+int main()
+{
+    CheckConversions();
+    CheckArithmetic();
+    std::cout << "nsec per tic " << HighPerTimer::GetNsecPerTic() << ", failures " << Failures << std::endl;
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+/*
+ * @file   HPTicsLogTest.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  test of the tics log: records written over many segments are read back, also as nanoseconds,
+ *         and a log with a broken layout is refused
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "HPTicsLog.h"
+#include "HPTimestamp.h"
+
+using namespace HPTimer;
+
+// records of the log, with small segments many of them are spread over several segments
+static const size_t Records = 20000;
+static const size_t SegmentBytes = 4096;
+// the records are read in chunks, which do not fit the segments
+static const size_t Chunk = 37;
+
+static uint32_t Failures ( 0 );
+
+static void Fail ( const char * What )
+{
+    ++Failures;
+    std::cerr << What << std::endl;
+}
+
+// steps of a clock with jumps of all sizes in both directions and the limits of int64 in between
+static std::vector<int64_t> TestValues ( const int64_t First, std::mt19937_64 & Random, const bool Jumps )
+{
+    std::vector<int64_t> Values ( Records );
+    int64_t Value ( First );
+    for ( size_t i = 0; i < Records; ++i )
+    {
+        if ( Jumps && ( 0 == i % 101 ) )
+        {
+            Value = ( i & 1 ) ? INT64_MIN : INT64_MAX;
+        }
+        else if ( Jumps && ( 0 == i % 13 ) )
+        {
+            Value = static_cast<int64_t> ( Random() );
+        }
+        else
+        {
+            Value = First + static_cast<int64_t> ( i ) * 1000 + static_cast<int64_t> ( Random() % 1000 );
+        }
+        Values[i] = Value;
+    }
+    return Values;
+}
+
+static bool Write ( const std::string & Path, const std::vector<int64_t> & Values, const bool Shifted )
+{
+    HPTicsLogWriter Writer;
+    if ( !Writer.Open ( Path, SegmentBytes, Shifted ) )
+    {
+        Fail ( "the log was not created" );
+        return false;
+    }
+    for ( size_t i = 0; i < Values.size(); ++i )
+    {
+        if ( !Writer.Append ( Values[i] ) )
+        {
+            Fail ( "a record was not appended" );
+            return false;
+        }
+    }
+    if ( Values.size() != Writer.GetCount() )
+    {
+        Fail ( "the writer miscounted the records" );
+    }
+    Writer.Close();
+    return true;
+}
+
+// the records come back unchanged in chunks and again after the rewind
+static void CheckRead ( HPTicsLogReader & Reader, const std::vector<int64_t> & Values )
+{
+    for ( int Pass = 0; Pass < 2; ++Pass )
+    {
+        std::vector<int64_t> Read ( Values.size() + Chunk );
+        size_t Done ( 0 );
+        for ( size_t Size; 0 != ( Size = Reader.Read ( Read.data() + Done, Chunk ) ); Done += Size )
+        {
+        }
+        Read.resize ( Done );
+        if ( Read != Values )
+        {
+            std::cerr << "read " << Done << " of " << Values.size() << " records" << std::endl;
+            Fail ( "the records were not read back" );
+        }
+        Reader.Rewind();
+    }
+}
+
+static void CheckRoundTrip ( const std::string & Path )
+{
+    std::mt19937_64 Random ( 20261014 );
+    std::vector<int64_t> Values ( TestValues ( -123456789, Random, true ) );
+    if ( !Write ( Path, Values, false ) )
+    {
+        return;
+    }
+    HPTicsLogReader Reader;
+    if ( !Reader.Open ( Path ) )
+    {
+        Fail ( "the log was not opened" );
+        return;
+    }
+    const HPTicsLogHeader & Header ( Reader.GetHeader() );
+    if ( ( Values.size() != Reader.GetCount() ) || ( Values.size() != Header.mCount ) || ( Header.mSegments < 2 ) )
+    {
+        std::cerr << "count " << Reader.GetCount() << ", header " << Header.mCount << ", segments " << Header.mSegments << std::endl;
+        Fail ( "the header does not count the records" );
+    }
+    if ( ( 0 != Header.mShifted ) || ( SegmentBytes != Header.mSegmentBytes ) || ( HighPerTimer::GetHPFrequency() != Header.mTicsPerUsec ) ||
+         ( HighPerTimer::GetNsecPerTic() != Header.mNsecPerTic ) || ( HighPerTimer::GetUnixZeroShift() != Header.mUnixZeroShift ) )
+    {
+        Fail ( "the header does not hold the calibration of the writer" );
+    }
+    CheckRead ( Reader, Values );
+}
+
+// raw counter values are shifted to unix zero, shifted values are converted as they are
+static void CheckNSec ( const std::string & Path, const bool Shifted )
+{
+    std::mt19937_64 Random ( 20261014 );
+    int64_t Now ( HPTimestamp::Now().HPTics() );
+    int64_t Shift ( Shifted ? 0 : HighPerTimer::GetUnixZeroShift() );
+    std::vector<int64_t> Values ( TestValues ( Now - Shift, Random, false ) );
+    if ( !Write ( Path, Values, Shifted ) )
+    {
+        return;
+    }
+    HPTicsLogReader Reader;
+    if ( !Reader.Open ( Path ) )
+    {
+        Fail ( "the log was not opened" );
+        return;
+    }
+    std::vector<int64_t> NSeconds ( Values.size() );
+    if ( Values.size() != Reader.ReadNSec ( NSeconds.data(), NSeconds.size() ) )
+    {
+        Fail ( "the nanoseconds were not read" );
+        return;
+    }
+    for ( size_t i = 0; i < Values.size(); ++i )
+    {
+        if ( NSeconds[i] != HighPerTimer::TictoNSec ( Values[i] + Shift ) )
+        {
+            std::cerr << "record " << i << ": " << NSeconds[i] << " ns, expected " << HighPerTimer::TictoNSec ( Values[i] + Shift ) << std::endl;
+            Fail ( Shifted ? "the shifted records were not converted" : "the raw records were not converted" );
+            return;
+        }
+    }
+}
+
+// a field of the header is overwritten, after which the reader has to refuse the log
+template <typename T>
+static void CheckBroken ( const std::string & Path, const size_t Offset, const T Value, const char * What )
+{
+    std::mt19937_64 Random ( 20261014 );
+    if ( !Write ( Path, TestValues ( 0, Random, false ), false ) )
+    {
+        return;
+    }
+    int Fd ( open ( Path.c_str(), O_WRONLY ) );
+    if ( ( Fd < 0 ) || ( static_cast<ssize_t> ( sizeof ( Value ) ) != pwrite ( Fd, &Value, sizeof ( Value ), Offset ) ) )
+    {
+        Fail ( "the header was not overwritten" );
+    }
+    if ( Fd >= 0 )
+    {
+        close ( Fd );
+    }
+    HPTicsLogReader Reader;
+    if ( Reader.Open ( Path ) )
+    {
+        Fail ( What );
+    }
+}
+
+static void CheckLayout ( const std::string & Path )
+{
+    CheckBroken ( Path, offsetof ( HPTicsLogHeader, mMagic ), 'X', "a log without the magic was opened" );
+    CheckBroken ( Path, offsetof ( HPTicsLogHeader, mHeaderBytes ), uint64_t ( 100 ), "a header of a wrong size was opened" );
+    CheckBroken ( Path, offsetof ( HPTicsLogHeader, mSegmentBytes ), uint64_t ( 16 ), "segments smaller than their header were opened" );
+    CheckBroken ( Path, offsetof ( HPTicsLogHeader, mSegmentBytes ), uint64_t ( 1 ) << 40, "segments beyond the file were opened" );
+    CheckBroken ( Path, offsetof ( HPTicsLogHeader, mSegments ), uint64_t ( 1 ) << 50, "more segments than in the file were opened" );
+
+    bool Thrown ( false );
+    try
+    {
+        HPTicsLogWriter Writer;
+        Writer.Open ( Path, 0 );
+    }
+    catch ( const std::out_of_range & )
+    {
+        Thrown = true;
+    }
+    if ( !Thrown )
+    {
+        Fail ( "a log of empty segments was created" );
+    }
+}
+
+int main()
+{
+    const char * Dir ( getenv ( "TMPDIR" ) );
+    std::string Path ( std::string ( Dir ? Dir : "/tmp" ) + "/HPTicsLogTest." + std::to_string ( getpid() ) + ".log" );
+    CheckRoundTrip ( Path );
+    CheckNSec ( Path, false );
+    CheckNSec ( Path, true );
+    CheckLayout ( Path );
+    unlink ( Path.c_str() );
+    std::cout << "failures " << Failures << std::endl;
+    return Failures ? 1 : 0;
+}
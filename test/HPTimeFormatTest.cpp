@@ -0,0 +1,142 @@
+/*
+ * @file   HPTimeFormatTest.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  test of the formatting of timestamps into caller buffers: Unix seconds, ISO 8601 in UTC and in local time
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <string>
+#include "HighPerTimer.h"
+#include "HPTimestamp.h"
+
+using namespace HPTimer;
+
+// random times compared with gmtime_r(), they cover the whole range of int64 nanoseconds from 1677 to 2262
+static const uint32_t RandomTimes = 10000;
+
+static uint32_t Failures ( 0 );
+
+static void Expect ( const int64_t NSeconds, const TimeFormat Format, const std::string & Expected )
+{
+    char Buffer[HighPerTimer::FormatLength];
+    size_t Size ( HighPerTimer::FormatNSecTo ( NSeconds, Buffer, sizeof ( Buffer ), Format ) );
+    if ( ( Expected != Buffer ) || ( Expected.size() != Size ) )
+    {
+        if ( ++Failures <= 10 )
+        {
+            std::cerr << NSeconds << ": " << Buffer << ", expected " << Expected << std::endl;
+        }
+    }
+}
+
+// the reference is composed by gmtime_r() and strftime() of the seconds rounded to minus infinity
+static std::string Reference ( const int64_t NSeconds )
+{
+    int64_t Seconds ( NSeconds / 1000000000LL );
+    int64_t Fraction ( NSeconds % 1000000000LL );
+    if ( Fraction < 0 )
+    {
+        Fraction += 1000000000LL;
+        Seconds -= 1;
+    }
+    time_t Time ( Seconds );
+    struct tm UTC;
+    gmtime_r ( &Time, &UTC );
+    char Text[64];
+    size_t Size ( strftime ( Text, sizeof ( Text ), "%Y-%m-%dT%H:%M:%S", &UTC ) );
+    snprintf ( Text + Size, sizeof ( Text ) - Size, ".%09lldZ", static_cast<long long> ( Fraction ) );
+    return Text;
+}
+
+static void CheckFixed()
+{
+    Expect ( 0, TimeFormat::ISO8601UTC, "1970-01-01T00:00:00.000000000Z" );
+    Expect ( -1, TimeFormat::ISO8601UTC, "1969-12-31T23:59:59.999999999Z" );
+    Expect ( 951782400123456789LL, TimeFormat::ISO8601UTC, "2000-02-29T00:00:00.123456789Z" );
+    Expect ( 1791980096123456789LL, TimeFormat::ISO8601UTC, "2026-10-14T12:14:56.123456789Z" );
+    Expect ( 4107542399999999999LL, TimeFormat::ISO8601UTC, "2100-02-28T23:59:59.999999999Z" );
+    Expect ( -2208988800000000000LL, TimeFormat::ISO8601UTC, "1900-01-01T00:00:00.000000000Z" );
+    Expect ( INT64_MIN, TimeFormat::ISO8601UTC, "1677-09-21T00:12:43.145224192Z" );
+    Expect ( INT64_MAX, TimeFormat::ISO8601UTC, "2262-04-11T23:47:16.854775807Z" );
+
+    Expect ( 1791980096123456789LL, TimeFormat::Unix, "1791980096.123456789" );
+    Expect ( -1, TimeFormat::Unix, "-0.000000001" );
+    Expect ( -1500000000LL, TimeFormat::Unix, "-1.500000000" );
+    Expect ( 0, TimeFormat::Unix, "0.000000000" );
+}
+
+// the offset of the local time is cached for a quarter of an hour, so each time zone is taken in another one
+static void CheckLocal()
+{
+    setenv ( "TZ", "XYZ-05:30", 1 );
+    tzset();
+    Expect ( 1791980096123456789LL, TimeFormat::ISO8601Local, "2026-10-14T17:44:56.123456789+05:30" );
+    setenv ( "TZ", "ABC+03:00", 1 );
+    tzset();
+    Expect ( 1791990000000000000LL, TimeFormat::ISO8601Local, "2026-10-14T12:00:00.000000000-03:00" );
+}
+
+// the text is written whole or not at all
+static void CheckBuffer()
+{
+    char Buffer[31];
+    memset ( Buffer, 'x', sizeof ( Buffer ) );
+    if ( ( 0 != HighPerTimer::FormatNSecTo ( 0, Buffer, 30, TimeFormat::ISO8601UTC ) ) || ( 0 != Buffer[0] ) || ( 'x' != Buffer[1] ) )
+    {
+        ++Failures;
+        std::cerr << "a too small buffer was written" << std::endl;
+    }
+    if ( 30 != HighPerTimer::FormatNSecTo ( 0, Buffer, 31, TimeFormat::ISO8601UTC ) )
+    {
+        ++Failures;
+        std::cerr << "a buffer of the exact size was not written" << std::endl;
+    }
+}
+
+static void CheckRandom()
+{
+    std::mt19937_64 Random ( 20261014 );
+    for ( uint32_t i = 0; i < RandomTimes; ++i )
+    {
+        int64_t NSeconds ( static_cast<int64_t> ( Random() ) );
+        Expect ( NSeconds, TimeFormat::ISO8601UTC, Reference ( NSeconds ) );
+
+        // a timestamp is formatted as its nanoseconds
+        HPTimestamp Stamp ( HPTimestamp::FromTics ( static_cast<int64_t> ( Random() ) >> 2 ) );
+        char Buffer[HighPerTimer::FormatLength];
+        Stamp.FormatTo ( Buffer, sizeof ( Buffer ), TimeFormat::ISO8601UTC );
+        Expect ( Stamp.ToNSec(), TimeFormat::ISO8601UTC, Buffer );
+    }
+}
+
+int main()
+{
+    CheckFixed();
+    CheckLocal();
+    CheckBuffer();
+    CheckRandom();
+    std::cout << "failures " << Failures << std::endl;
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * @file   HPTimerWheelTest.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  test of the timer wheel: deadlines on all levels, which cascade down, and cancels by generations
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "HPTimerWheel.h"
+
+using namespace HPTimer;
+
+// delays in microseconds of a wheel with 1 us resolution: a slot of the level 0 covers 1 us, of the level 1 256 us
+// and of the level 2 65.5 ms, so the later deadlines are cascaded down through two levels before they fire
+static const int64_t DelaysUSec[] = { 100, 2000, 40000, 150000, 400000 };
+static const size_t Timers = sizeof ( DelaysUSec ) / sizeof ( DelaysUSec[0] );
+
+// the timer, which is cancelled after it was cascaded from the level 2: it is due 30 ms after the begin of its slot
+// of the level 2, at which it is moved to the level 1, and cancelled 20 ms after that begin
+static const int64_t CancelledUSec = 30000;
+static const int64_t CancelAtUSec = 20000;
+
+static uint32_t Failures ( 0 );
+
+static void Fail ( const char * What )
+{
+    ++Failures;
+    std::cerr << What << std::endl;
+}
+
+// the identifier of a cancelled timer does not match the next timer in its node
+static void CheckGenerations()
+{
+    HPTimerWheel Wheel;
+    HPTimerWheel::TimerId First ( Wheel.ScheduleAfter ( HPDuration::FromUSec ( 50000 ), [] () {} ) );
+    if ( ( HPTimerWheel::InvalidTimer == First ) || !Wheel.Cancel ( First ) || ( 0 != Wheel.Size() ) )
+    {
+        Fail ( "a pending timer was not cancelled" );
+    }
+    if ( Wheel.Cancel ( First ) )
+    {
+        Fail ( "a timer was cancelled twice" );
+    }
+    HPTimerWheel::TimerId Second ( Wheel.ScheduleAfter ( HPDuration::FromUSec ( 50000 ), [] () {} ) );
+    if ( ( static_cast<uint32_t> ( Second ) != static_cast<uint32_t> ( First ) ) || ( Second == First ) )
+    {
+        Fail ( "the node of the cancelled timer was not reused with a new generation" );
+    }
+    if ( Wheel.Cancel ( First ) || ( 1 != Wheel.Size() ) )
+    {
+        Fail ( "the identifier of a cancelled timer cancelled the next timer in its node" );
+    }
+    if ( Wheel.Cancel ( HPTimerWheel::InvalidTimer ) || !Wheel.Cancel ( Second ) )
+    {
+        Fail ( "the cancel of the identifiers failed" );
+    }
+}
+
+// each timer fires once, not before its deadline and in the order of the deadlines
+static void CheckCascades()
+{
+    HPTimerWheel Wheel ( HPDuration::FromUSec ( 1 ) );
+    std::vector<HPTimestamp> Deadlines ( Timers );
+    std::vector<HPTimestamp> Fired ( Timers );
+    std::vector<size_t> Order;
+    std::atomic<size_t> Count ( 0 );
+    std::atomic<bool> CancelledFired ( false );
+    std::vector<HPTimerWheel::TimerId> Ids ( Timers );
+
+    HPTimestamp Begin ( HPTimestamp::Now() );
+    Wheel.Start();
+    for ( size_t i = 0; i < Timers; ++i )
+    {
+        Deadlines[i] = Begin + HPDuration::FromUSec ( DelaysUSec[i] );
+        Ids[i] = Wheel.Schedule ( Deadlines[i], [&, i] ()
+        {
+            Fired[i] = HPTimestamp::Now();
+            Order.push_back ( i );
+            Count.fetch_add ( 1, std::memory_order_release );
+        } );
+    }
+    // the units of the wheel are counted from unix zero, so the slots of the level 2 begin at multiples of their tics
+    int64_t SlotTics ( HPDuration::FromUSec ( 1 ).HPTics() << ( 2 * 8 ) );
+    HPTimestamp SlotBegin ( HPTimestamp::FromTics ( ( Begin.HPTics() / SlotTics + 3 ) * SlotTics ) );
+    HPTimerWheel::TimerId Cancelled ( Wheel.Schedule ( SlotBegin + HPDuration::FromUSec ( CancelledUSec ), [&] ()
+    {
+        CancelledFired.store ( true );
+    } ) );
+
+    ( SlotBegin + HPDuration::FromUSec ( CancelAtUSec ) ).SleepTo();
+    if ( !Wheel.Cancel ( Cancelled ) )
+    {
+        Fail ( "the cascaded timer was not cancelled" );
+    }
+    for ( int Wait = 0; ( Wait < 200 ) && ( Count.load ( std::memory_order_acquire ) < Timers ); ++Wait )
+    {
+        std::this_thread::sleep_for ( std::chrono::milliseconds ( 10 ) );
+    }
+    Wheel.Stop();
+
+    if ( ( Timers != Order.size() ) || ( 0 != Wheel.Size() ) || CancelledFired.load() )
+    {
+        std::cerr << "fired " << Order.size() << " of " << Timers << ", pending " << Wheel.Size() << ", cancelled fired " << CancelledFired.load() << std::endl;
+        Fail ( "the timers did not fire as scheduled" );
+        return;
+    }
+    for ( size_t i = 0; i < Timers; ++i )
+    {
+        if ( Order[i] != i )
+        {
+            Fail ( "the timers fired out of the order of the deadlines" );
+        }
+        if ( Fired[i] < Deadlines[i] )
+        {
+            Fail ( "a timer fired before its deadline" );
+        }
+        std::cout << "delay " << DelaysUSec[i] << " us, late " << ( Fired[i] - Deadlines[i] ).ToNSec() << " ns" << std::endl;
+        if ( Wheel.Cancel ( Ids[i] ) )
+        {
+            Fail ( "a fired timer was cancelled" );
+        }
+    }
+}
+
+int main()
+{
+    CheckGenerations();
+    CheckCascades();
+    std::cout << "failures " << Failures << std::endl;
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * @file   HPTraceDetachTest.cpp
+ * @author Irina Fedotova <i.fedotova@emw.hs-anhalt.de>
+ * @date   Oct, 2026
+ * @brief  test of the events, which a thread records after its trace ring was released on exit
+ *
+ * Copyright (C) 2012-2016,  Future Internet Lab Anhalt (FILA),
+ * Anhalt University of Applied Sciences, Koethen, Germany. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the Artistic License 2.0 as published by the Free Software
+ * Foundation with classpath exception.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the Artistic License version 2.0 for more
+ * details.
+ *
+ * You should have received a copy of the Artistic License along with this
+ * program (please see the COPYING file);
+ */
+
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "HPTrace.h"
+
+using namespace HPTimer;
+
+// threads of the test, each one records one span in its body and one in its teardown
+static const uint32_t Threads = 8;
+
+static uint32_t Site;
+
+// records a span when the thread exits. It is constructed before the first span of the thread,
+// so it is destroyed after the owner of the ring
+struct LateTracer
+{
+    bool mArmed = false;
+
+    ~LateTracer()
+    {
+        if ( mArmed )
+        {
+            HPTraceScope Scope ( Site );
+        }
+    }
+};
+
+static thread_local LateTracer Late;
+
+static void Body()
+{
+    Late.mArmed = true;
+    HPTraceScope Scope ( Site );
+}
+
+int main()
+{
+    Site = HPTrace::RegisterSite ( "detach" );
+    HPTrace::Start ( HPDuration::FromUSec ( 1000 ), 64 );
+    std::vector<std::thread> Workers;
+    for ( uint32_t i = 0; i < Threads; ++i )
+    {
+        Workers.push_back ( std::thread ( &Body ) );
+    }
+    for ( std::thread & Worker : Workers )
+    {
+        Worker.join();
+    }
+    HPTrace::Stop();
+
+    // the spans of the bodies are collected, the ones of the teardowns are dropped instead of attaching a ring, which is never released
+    size_t Events ( HPTrace::GetEventCount() );
+    uint64_t Dropped ( HPTrace::GetDroppedCount() );
+    std::cout << "events " << Events << ", dropped " << Dropped << std::endl;
+    if ( ( Threads != Events ) || ( Threads != Dropped ) )
+    {
+        std::cerr << "expected " << Threads << " events and " << Threads << " dropped" << std::endl;
+        return 1;
+    }
+    return 0;
+}